@@ -1,3 +1,5 @@
+set(OPENGCC_SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
 function(init_controller CONTROLLER)
     add_executable(${CONTROLLER})
 
@@ -8,6 +10,44 @@ function(init_controller CONTROLLER)
 
     target_link_libraries(${CONTROLLER} OpenGCC)
 
+    # Statistics are printed over USB serial, which is otherwise left off so
+    # it can't delay console communication
+    if (OPENGCC_JOYBUS_STATISTICS AND OPENGCC_JOYBUS_STATISTICS_STDIO)
+        pico_enable_stdio_usb(${CONTROLLER} 1)
+        pico_enable_stdio_uart(${CONTROLLER} 0)
+    endif()
+
     pico_add_extra_outputs(${CONTROLLER})
     pico_set_binary_type(${CONTROLLER} copy_to_ram)
 endfunction()
+
+# Build a benchmark of the analog hot path for a controller, with the same
+# definitions & libraries as its firmware. Must be called after the
+# controller's target is fully configured.
+function(add_controller_benchmark CONTROLLER)
+    if (NOT OPENGCC_BENCHMARKS)
+        return()
+    endif()
+
+    add_executable(${CONTROLLER}_benchmark)
+
+    target_sources(${CONTROLLER}_benchmark PRIVATE
+        controller.hpp
+        controller.cpp
+        ${OPENGCC_SOURCE_DIR}/opengcc/benchmark.cpp
+    )
+
+    target_compile_definitions(${CONTROLLER}_benchmark PRIVATE
+        $<TARGET_PROPERTY:${CONTROLLER},COMPILE_DEFINITIONS>
+        OPENGCC_BENCHMARK
+    )
+
+    target_link_libraries(${CONTROLLER}_benchmark
+        $<TARGET_PROPERTY:${CONTROLLER},LINK_LIBRARIES>
+    )
+
+    pico_enable_stdio_usb(${CONTROLLER}_benchmark 1)
+    pico_enable_stdio_uart(${CONTROLLER}_benchmark 0)
+    pico_add_extra_outputs(${CONTROLLER}_benchmark)
+    pico_set_binary_type(${CONTROLLER}_benchmark copy_to_ram)
+endfunction()
@@ -21,9 +21,12 @@
 #include <array>
 
 #include "analog_controller.hpp"
+#include "button_sampler.hpp"
 #include "hardware/adc.h"
 #include "hardware/dma.h"
 #include "hardware/i2c.h"
+#include "oversampling.hpp"
+#include "trigger_decimation.hpp"
 
 std::array<control_block, 12> l_stick_control_blocks = {};
 std::array<control_block, 12> r_stick_control_blocks = {};
@@ -35,7 +38,19 @@ uint32_t r_stick_raw = 0;
 std::array<uint8_t, 4> r_stick_temporary = {};
 std::array<uint8_t, 4> l_stick_temporary = {};
 
-std::array<uint8_t, 2> triggers_raw = {};
+uint16_t last_buttons = 0;
+
+alignas(TRIGGER_RING_BYTES) trigger_sample_ring triggers_raw = {};
+uint triggers_dma_1 = 0;
+uint triggers_dma_2 = 0;
+
+uint l_stick_transfer_channel = 0;
+uint r_stick_transfer_channel = 0;
+stick_sample_ring l_stick_samples;
+stick_sample_ring r_stick_samples;
+
+stick_oversampler<STICK_OVERSAMPLING> l_stick_window;
+stick_oversampler<STICK_OVERSAMPLING> r_stick_window;
 
 void init_buttons() {
   // Set buttons as pull-up inputs
@@ -52,8 +67,18 @@ void init_buttons() {
   gpio_pull_up(Y_PIN);
   gpio_pull_up(START_PIN);
 
+  // Sampled with the buttons, so it mustn't float. Every change it picked up
+  // would be pushed, filling the sampler's ring & losing button timestamps.
+  gpio_pull_up(UNUSED_BUTTON_BLOCK_PIN);
+
   // Wait for pull-ups to stabilize
   busy_wait_us(100);
+
+#if BUTTON_SAMPLER
+  // Buttons are all on the first pins, in the order they are sent to the
+  // console
+  init_button_sampler(pio1, DPAD_LEFT_PIN, START_PIN + 1);
+#endif
 }
 
 uint16_t get_buttons() {
@@ -62,6 +87,35 @@ uint16_t get_buttons() {
   return ~gpio_get_all() & PHYSICAL_BUTTONS_MASK;
 }
 
+#if BUTTON_SAMPLER
+bool get_button_change(button_change &change) {
+  uint32_t pins = 0;
+  uint32_t timestamp = 0;
+  while (get_sampled_pins(pins, timestamp)) {
+    // Skip changes only on pins which aren't buttons
+    uint16_t buttons = ~pins & PHYSICAL_BUTTONS_MASK;
+    if (buttons != last_buttons) {
+      last_buttons = buttons;
+      change = {buttons, timestamp};
+      return true;
+    }
+  }
+
+  return false;
+}
+#else
+bool get_button_change(button_change &change) {
+  uint16_t buttons = get_buttons();
+  if (buttons == last_buttons) {
+    return false;
+  }
+
+  last_buttons = buttons;
+  change = {buttons, time_us_32()};
+  return true;
+}
+#endif
+
 // Configure an Si7210 sensor to read continuously
 void setup_si7210_sensor(i2c_inst_t *i2c, uint8_t addr) {
   // The proper way to wake the sensor is a 0-byte write, but RP2040's I2C interface does not support 0-byte writes
@@ -157,7 +211,7 @@ void setup_i2c(i2c_inst_t *i2c, uint sda, uint scl) {
   i2c_init(i2c, 400000);
 }
 
-void init_stick(i2c_inst_t *i2c, uint sda, uint scl,
+uint init_stick(i2c_inst_t *i2c, uint sda, uint scl,
                 std::array<control_block, 12> &control_blocks,
                 control_block &reset_block,
                 std::array<uint8_t, 4> &stick_temporary, uint32_t &stick_raw) {
@@ -183,6 +237,7 @@ void init_stick(i2c_inst_t *i2c, uint sda, uint scl,
   dma_channel_config i2c_register_write_config =
       dma_channel_get_default_config(transfer_channel);
   channel_config_set_chain_to(&i2c_register_write_config, control_channel);
+  channel_config_set_irq_quiet(&i2c_register_write_config, true);
   uint32_t i2c_register_write_config_control_value =
       channel_config_get_ctrl_value(&i2c_register_write_config);
 
@@ -191,6 +246,7 @@ void init_stick(i2c_inst_t *i2c, uint sda, uint scl,
   channel_config_set_dreq(&i2c_write_config, i2c_get_dreq(i2c, true));
   channel_config_set_chain_to(&i2c_write_config, control_channel);
   channel_config_set_transfer_data_size(&i2c_write_config, DMA_SIZE_16);
+  channel_config_set_irq_quiet(&i2c_write_config, true);
   uint32_t i2c_write_config_control_value =
       channel_config_get_ctrl_value(&i2c_write_config);
 
@@ -201,6 +257,7 @@ void init_stick(i2c_inst_t *i2c, uint sda, uint scl,
   channel_config_set_dreq(&i2c_read_config, i2c_get_dreq(i2c, false));
   channel_config_set_chain_to(&i2c_read_config, control_channel);
   channel_config_set_transfer_data_size(&i2c_read_config, DMA_SIZE_8);
+  channel_config_set_irq_quiet(&i2c_read_config, true);
   uint32_t i2c_read_config_control_value =
       channel_config_get_ctrl_value(&i2c_read_config);
 
@@ -208,12 +265,14 @@ void init_stick(i2c_inst_t *i2c, uint sda, uint scl,
       dma_channel_get_default_config(transfer_channel);
   channel_config_set_chain_to(&buffer_to_buffer_config, control_channel);
   channel_config_set_bswap(&buffer_to_buffer_config, true);
+  // Only the copy of a completed sample raises an IRQ
   uint32_t buffer_to_buffer_config_control_value =
       channel_config_get_ctrl_value(&buffer_to_buffer_config);
 
   dma_channel_config reset_control_config =
       dma_channel_get_default_config(transfer_channel);
   channel_config_set_write_increment(&reset_control_config, true);
+  channel_config_set_irq_quiet(&reset_control_config, true);
   uint32_t reset_control_config_control_value =
       channel_config_get_ctrl_value(&reset_control_config);
 
@@ -247,13 +306,65 @@ void init_stick(i2c_inst_t *i2c, uint sda, uint scl,
   dma_channel_configure(control_channel, &control_config,
                         &dma_hw->ch[transfer_channel].read_addr,
                         control_blocks.data(), 4, true);
+
+  return transfer_channel;
+}
+
+raw_stick get_stick(uint32_t stick_raw, uint32_t timestamp) {
+  return {static_cast<uint16_t>((stick_raw >> 16) & 0x7FFF),
+          static_cast<uint16_t>(stick_raw & 0x00007FFF),
+          (stick_raw & 0x80008000) > 0, timestamp};
+}
+
+void queue_stick_sample(uint32_t stick_raw, uint32_t timestamp,
+                        stick_sample_ring &samples,
+                        stick_oversampler<STICK_OVERSAMPLING> &window) {
+  raw_stick sample = get_stick(stick_raw, timestamp);
+  if (!sample.fresh) {
+    return;
+  }
+
+#if STICK_OVERSAMPLING > 1
+  // Reduce a sliding window of the most recent samples whenever a new one
+  // arrives
+  window.record(sample);
+  sample = window.reduce();
+#endif
+  samples.push(sample);
+}
+
+void handle_stick_sample() {
+  // The copy of a sample has just completed, so the time it's picked up is the
+  // best available estimate of when it was sampled
+  uint32_t timestamp = time_us_32();
+
+  if (dma_channel_get_irq1_status(l_stick_transfer_channel)) {
+    dma_channel_acknowledge_irq1(l_stick_transfer_channel);
+    queue_stick_sample(l_stick_raw, timestamp, l_stick_samples,
+                       l_stick_window);
+  }
+  if (dma_channel_get_irq1_status(r_stick_transfer_channel)) {
+    dma_channel_acknowledge_irq1(r_stick_transfer_channel);
+    queue_stick_sample(r_stick_raw, timestamp, r_stick_samples,
+                       r_stick_window);
+  }
 }
 
 void init_sticks() {
-  init_stick(i2c0, L_SDA_PIN, L_SCL_PIN, l_stick_control_blocks,
-             l_stick_reset_block, l_stick_temporary, l_stick_raw);
-  init_stick(i2c1, R_SDA_PIN, R_SCL_PIN, r_stick_control_blocks,
-             r_stick_reset_block, r_stick_temporary, r_stick_raw);
+  l_stick_transfer_channel =
+      init_stick(i2c0, L_SDA_PIN, L_SCL_PIN, l_stick_control_blocks,
+                 l_stick_reset_block, l_stick_temporary, l_stick_raw);
+  r_stick_transfer_channel =
+      init_stick(i2c1, R_SDA_PIN, R_SCL_PIN, r_stick_control_blocks,
+                 r_stick_reset_block, r_stick_temporary, r_stick_raw);
+
+  // Queue samples as they arrive, at a lower priority than Joybus so console
+  // requests are never delayed
+  irq_set_exclusive_handler(DMA_IRQ_1, handle_stick_sample);
+  irq_set_priority(DMA_IRQ_1, PICO_LOWEST_IRQ_PRIORITY);
+  irq_set_enabled(DMA_IRQ_1, true);
+  dma_channel_set_irq1_enabled(l_stick_transfer_channel, true);
+  dma_channel_set_irq1_enabled(r_stick_transfer_channel, true);
 }
 
 void init_triggers() {
@@ -263,11 +374,11 @@ void init_triggers() {
   adc_gpio_init(RT_ANALOG_PIN);
   adc_select_input(LT_ANALOG_ADC_INPUT);
   adc_set_round_robin(TRIGGER_ADC_MASK);
-  adc_fifo_setup(true, true, 1, false, true);
+  adc_fifo_setup(true, true, 1, false, false);
 
   // Claim ADC DMA channels
-  uint triggers_dma_1 = dma_claim_unused_channel(true);
-  uint triggers_dma_2 = dma_claim_unused_channel(true);
+  triggers_dma_1 = dma_claim_unused_channel(true);
+  triggers_dma_2 = dma_claim_unused_channel(true);
 
   // Setup base configuration
   dma_channel_config triggers_base_config =
@@ -276,9 +387,9 @@ void init_triggers() {
                                     false);  // Always read from same address
   channel_config_set_write_increment(&triggers_base_config,
                                      true);  // Increment write address
-  channel_config_set_transfer_data_size(&triggers_base_config, DMA_SIZE_8);
+  channel_config_set_transfer_data_size(&triggers_base_config, DMA_SIZE_16);
   channel_config_set_ring(&triggers_base_config, true,
-                          1);  // Wrap after 2 bytes
+                          TRIGGER_RING_SIZE_BITS);  // Wrap around the ring
   channel_config_set_dreq(&triggers_base_config, DREQ_ADC);
 
   // Setup channel specific configurations
@@ -289,32 +400,33 @@ void init_triggers() {
 
   // Apply configurations
   dma_channel_configure(triggers_dma_1, &triggers_config_1, triggers_raw.data(),
-                        &adc_hw->fifo, 0xFFFFFFFE, true);
+                        &adc_hw->fifo, TRIGGER_RING_TRANSFER_COUNT, true);
   dma_channel_configure(triggers_dma_2, &triggers_config_2, triggers_raw.data(),
-                        &adc_hw->fifo, 0xFFFFFFFE, false);
+                        &adc_hw->fifo, TRIGGER_RING_TRANSFER_COUNT, false);
 
   // Start ADC
   adc_run(true);
 }
 
-raw_stick get_stick(uint32_t stick_raw) {
-  return {static_cast<uint16_t>((stick_raw >> 16) & 0x7FFF),
-          static_cast<uint16_t>(stick_raw & 0x00007FFF),
-          (stick_raw & 0x80008000) > 0};
-}
-
-raw_stick get_left_stick() {
-  raw_stick ret_value = get_stick(l_stick_raw);
-  l_stick_raw &= 0x7FFF7FFF;
-  return ret_value;
-}
+raw_stick get_left_stick() { return get_stick(l_stick_raw, time_us_32()); }
 
 raw_stick get_right_stick() {
-  raw_stick ret_value = get_stick(r_stick_raw);
-  r_stick_raw &= 0x7FFF7FFF;
-  return ret_value;
+  return get_stick(r_stick_raw, time_us_32());
 }
 
-raw_sticks get_sticks() { return {get_left_stick(), get_right_stick()}; }
+void sample_sticks() {}
+
+stick_sample_ring &left_stick_samples() { return l_stick_samples; }
 
-raw_triggers get_triggers() { return {triggers_raw[0], triggers_raw[1]}; }
+stick_sample_ring &right_stick_samples() { return r_stick_samples; }
+
+raw_triggers get_triggers() {
+  // Find where the running channel writes next, the oldest sample in the ring
+  uint channel =
+      dma_channel_is_busy(triggers_dma_1) ? triggers_dma_1 : triggers_dma_2;
+  uint next = (dma_hw->ch[channel].write_addr -
+               reinterpret_cast<uintptr_t>(triggers_raw.data())) /
+              sizeof(uint16_t);
+
+  return decimate_triggers(triggers_raw, next);
+}
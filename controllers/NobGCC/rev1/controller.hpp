@@ -49,6 +49,11 @@ constexpr uint RT_DIGITAL_PIN = 5;
 /// \brief Left trigger button pin
 constexpr uint LT_DIGITAL_PIN = 6;
 
+/** \brief Unconnected pin among the button pins, sampled along with them by
+ * the button sampler
+ */
+constexpr uint UNUSED_BUTTON_BLOCK_PIN = 7;
+
 /// \brief A button pin
 constexpr uint A_PIN = 8;
 
@@ -99,6 +104,12 @@ constexpr uint16_t PHYSICAL_BUTTONS_MASK =
     (1 << LT_DIGITAL_PIN) | (1 << A_PIN) | (1 << B_PIN) | (1 << X_PIN) |
     (1 << Y_PIN) | (1 << START_PIN);
 
+static_assert(DPAD_LEFT_PIN == 0 &&
+                  PHYSICAL_BUTTONS_MASK < (1 << (START_PIN + 1)),
+              "Button sampler expects buttons on the first pins");
+static_assert((PHYSICAL_BUTTONS_MASK & (1 << UNUSED_BUTTON_BLOCK_PIN)) == 0,
+              "Unused pin among the buttons must not be a button");
+
 // I2C addresses of sensors for x & y addresses
 constexpr uint32_t X_I2C_ADDR = 0x32;
 constexpr uint32_t Y_I2C_ADDR = 0x33;
@@ -24,11 +24,20 @@
 #include "hardware/adc.h"
 #include "hardware/dma.h"
 #include "hardware/spi.h"
+#include "oversampling.hpp"
 #include "state.hpp"
+#include "trigger_decimation.hpp"
 
 std::array<uint8_t, 3> stick_raw;
 
-alignas(16) std::array<uint8_t, 2> triggers_raw;
+alignas(TRIGGER_RING_BYTES) trigger_sample_ring triggers_raw = {};
+uint triggers_dma_1 = 0;
+uint triggers_dma_2 = 0;
+
+uint16_t last_buttons = 0;
+
+stick_sample_ring l_stick_samples;
+stick_sample_ring r_stick_samples;
 
 void init_buttons() {
   // Set buttons as pull-up inputs
@@ -62,6 +71,17 @@ uint16_t get_buttons() {
          (gpio_get(Y_PIN) << Y) | (gpio_get(START_PIN) << START);
 }
 
+bool get_button_change(button_change &change) {
+  uint16_t buttons = get_buttons();
+  if (buttons == last_buttons) {
+    return false;
+  }
+
+  last_buttons = buttons;
+  change = {buttons, time_us_32()};
+  return true;
+}
+
 // Setup an i2c block
 void setup_spi(spi_inst_t *spi, uint clk, uint tx, uint rx) {
   gpio_set_function(clk, GPIO_FUNC_SPI);
@@ -91,11 +111,11 @@ void init_triggers() {
   adc_gpio_init(RT_ANALOG_PIN);
   adc_select_input(LT_ANALOG_ADC_INPUT);
   adc_set_round_robin(TRIGGER_ADC_MASK);
-  adc_fifo_setup(true, true, 1, false, true);
+  adc_fifo_setup(true, true, 1, false, false);
 
   // Claim ADC DMA channels
-  uint triggers_dma_1 = dma_claim_unused_channel(true);
-  uint triggers_dma_2 = dma_claim_unused_channel(true);
+  triggers_dma_1 = dma_claim_unused_channel(true);
+  triggers_dma_2 = dma_claim_unused_channel(true);
 
   // Setup base configuration
   dma_channel_config triggers_base_config =
@@ -104,9 +124,9 @@ void init_triggers() {
                                     false);  // Always read from same address
   channel_config_set_write_increment(&triggers_base_config,
                                      true);  // Increment write address
-  channel_config_set_transfer_data_size(&triggers_base_config, DMA_SIZE_8);
+  channel_config_set_transfer_data_size(&triggers_base_config, DMA_SIZE_16);
   channel_config_set_ring(&triggers_base_config, true,
-                          1);  // Wrap after 2 bytes
+                          TRIGGER_RING_SIZE_BITS);  // Wrap around the ring
   channel_config_set_dreq(&triggers_base_config, DREQ_ADC);
 
   // Setup channel specific configurations
@@ -117,9 +137,9 @@ void init_triggers() {
 
   // Apply configurations
   dma_channel_configure(triggers_dma_1, &triggers_config_1, triggers_raw.data(),
-                        &adc_hw->fifo, 0xFFFFFFFF, true);
+                        &adc_hw->fifo, TRIGGER_RING_TRANSFER_COUNT, true);
   dma_channel_configure(triggers_dma_2, &triggers_config_2, triggers_raw.data(),
-                        &adc_hw->fifo, 0xFFFFFFFF, false);
+                        &adc_hw->fifo, TRIGGER_RING_TRANSFER_COUNT, false);
 
   // Start ADC
   adc_run(true);
@@ -145,14 +165,42 @@ uint16_t read_mcp3202_data(uint cs_pin, bool read_y_axis) {
 
 // Read x- & y-axis from a stick
 raw_stick get_stick(uint cs_pin) {
+#if STICK_OVERSAMPLING > 1
+  // Take a burst of samples back to back, and reduce them into one
+  stick_oversampler<STICK_OVERSAMPLING> samples;
+  for (uint i = 0; i < STICK_OVERSAMPLING; ++i) {
+    uint32_t timestamp = time_us_32();
+    samples.record({read_mcp3202_data(cs_pin, false),
+                    read_mcp3202_data(cs_pin, true), true, timestamp});
+  }
+  return samples.reduce();
+#else
+  uint32_t timestamp = time_us_32();
   return {read_mcp3202_data(cs_pin, false), read_mcp3202_data(cs_pin, true),
-          true};
+          true, timestamp};
+#endif
 }
 
-raw_sticks get_sticks() { return {get_stick(L_CS_PIN), get_stick(R_CS_PIN)}; }
+void sample_sticks() {
+  l_stick_samples.push(get_stick(L_CS_PIN));
+  r_stick_samples.push(get_stick(R_CS_PIN));
+}
+
+stick_sample_ring &left_stick_samples() { return l_stick_samples; }
+
+stick_sample_ring &right_stick_samples() { return r_stick_samples; }
 
 raw_stick get_left_stick() { return get_stick(L_CS_PIN); }
 
 raw_stick get_right_stick() { return get_stick(R_CS_PIN); }
 
-raw_triggers get_triggers() { return {triggers_raw[0], triggers_raw[1]}; }
+raw_triggers get_triggers() {
+  // Find where the running channel writes next, the oldest sample in the ring
+  uint channel =
+      dma_channel_is_busy(triggers_dma_1) ? triggers_dma_1 : triggers_dma_2;
+  uint next = (dma_hw->ch[channel].write_addr -
+               reinterpret_cast<uintptr_t>(triggers_raw.data())) /
+              sizeof(uint16_t);
+
+  return decimate_triggers(triggers_raw, next);
+}
@@ -21,6 +21,8 @@
 
 #include <pico/types.h>
 
+#include "spsc_ring.hpp"
+
 /** \file controller.hpp
  * \brief Functionality that is varies in implementation between controllers
  */
@@ -34,6 +36,22 @@ void init_buttons();
  */
 uint16_t get_buttons();
 
+/// \brief Change in physical button states
+struct button_change {
+  /// \brief Physical button states after the change, as from `get_buttons()`
+  uint16_t buttons;
+  /// \brief Time of the change, in microseconds since boot
+  uint32_t timestamp;
+};
+
+/** \brief Get the oldest change in physical button states not yet returned
+ *
+ * \param change Output for the change
+ *
+ * \return `true` if there was a change, `false` otherwise
+ */
+bool get_button_change(button_change &change);
+
 /// \brief Grouping of axes for a single analog stick's raw values
 struct raw_stick {
   /// \brief X-axis
@@ -42,43 +60,66 @@ struct raw_stick {
   uint16_t y;
   /// \brief `true` if this data hasn't been read yet, `false` otherwise
   bool fresh;
+  /// \brief Time the data was sampled, in microseconds since boot
+  uint32_t timestamp;
 };
 
-/// \brief Grouping of analog sticks raw values
-struct raw_sticks {
-  /// \brief Left stick
-  raw_stick l_stick;
-  /// \brief Right stick
-  raw_stick r_stick;
-};
+/// \brief Number of raw samples queued per stick, a power of two
+constexpr uint STICK_SAMPLE_RING_SIZE = 64;
+
+/// \brief Queue of raw samples of a stick, in the order they were taken
+using stick_sample_ring = spsc_ring<raw_stick, STICK_SAMPLE_RING_SIZE>;
 
 /// \brief Initialize stick reading functionality
 void init_sticks();
 
-/** \brief Get the value of both sticks
+/** \brief Sample sticks which are read on demand
  *
- * \return Stick values
+ * Queues a new sample of each stick, for backends which only read sticks when
+ * asked to. Backends which sample continuously queue samples as they arrive,
+ * and do nothing here.
  */
-raw_sticks get_sticks();
+void sample_sticks();
 
-/** \brief Get the value of the left stick
+/** \brief Get the queue of left stick samples
+ *
+ * \note The stick processing loop is the only consumer.
+ *
+ * \return Left stick sample queue
+ */
+stick_sample_ring &left_stick_samples();
+
+/** \brief Get the queue of right stick samples
+ *
+ * \note The stick processing loop is the only consumer.
+ *
+ * \return Right stick sample queue
+ */
+stick_sample_ring &right_stick_samples();
+
+/** \brief Get the latest value of the left stick, without consuming queued
+ * samples
  *
  * \return Left stick axis values
  */
 raw_stick get_left_stick();
 
-/** \brief Get the value of the right stick
+/** \brief Get the latest value of the right stick, without consuming queued
+ * samples
  *
  * \return Right stick axis values
  */
 raw_stick get_right_stick();
 
-/// \brief Grouping of trigger values
+/** \brief Grouping of trigger values
+ *
+ * \note Values have `TRIGGER_BITS` bits.
+ */
 struct raw_triggers {
   /// \brief Left trigger
-  uint8_t l;
+  uint16_t l;
   /// \brief Right trigger
-  uint8_t r;
+  uint16_t r;
 };
 
 /// \brief Initialize trigger reading functionality
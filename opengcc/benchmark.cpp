@@ -0,0 +1,489 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file benchmark.cpp
+ * \brief Benchmark of the functions on the analog hot path
+ *
+ * Built as `<controller>_benchmark` when `OPENGCC_BENCHMARKS` is enabled, in
+ * place of the firmware's `main()`. Each function runs on fixed input traces,
+ * so results are comparable across commits. On device, calls are timed in
+ * processor cycles with SysTick, & results are reported over USB stdio as well
+ * as kept in `benchmark_results` for inspection with a debugger. Elsewhere,
+ * calls are timed in nanoseconds, which are only meaningful relative to each
+ * other.
+ *
+ * \note The device build, & so its SysTick timing, hasn't been run on
+ * hardware yet. Only the host build has produced results.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+#include "analog_controller.hpp"
+#include "calibration.hpp"
+#include "configuration.hpp"
+#include "curve_fitting.hpp"
+#include "joybus.hpp"
+#include "main.hpp"
+#include "pico/stdlib.h"
+#include "state.hpp"
+#include "stick_filter.hpp"
+#include "stick_pipeline.hpp"
+
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#else
+#include <chrono>
+#endif
+
+/// \brief Number of entries in each input trace
+constexpr uint TRACE_LENGTH = 256;
+
+/// \brief Number of passes over each trace per benchmark run
+constexpr uint TRACE_PASSES = 16;
+
+/// \brief Time between raw stick samples in the stick trace, in microseconds
+constexpr uint32_t STICK_TRACE_PERIOD_US = 1000;
+
+/// \brief Stick trace samples aggregated for each simulated 60 Hz poll
+constexpr uint STICK_TRACE_SAMPLES_PER_POLL = 16;
+
+/// \brief Timing statistics for calls to one function
+struct call_statistics {
+  /// \brief Name of the function
+  const char *name;
+  /// \brief Fastest call
+  uint32_t min;
+  /// \brief Slowest call
+  uint32_t max;
+  /// \brief Total time of all calls
+  uint64_t total;
+  /// \brief Number of calls
+  uint32_t count;
+};
+
+/// \brief Functions benchmarked
+enum benchmarked_function {
+  benchmark_read_digital,
+  benchmark_read_triggers,
+  benchmark_normalize_axis,
+  benchmark_normalize_axis_double,
+  benchmark_blend_interpolated,
+  benchmark_blend_calculated,
+  benchmark_round_and_clamp_interpolated,
+  benchmark_round_and_clamp_calculated,
+  benchmark_filter_stick,
+  benchmark_pipeline_normalize,
+  benchmark_pipeline_notches,
+  benchmark_pipeline_snapback,
+  benchmark_pipeline_smoothing,
+  benchmark_process_stick_samples,
+  benchmark_encode_mode,
+  NUM_BENCHMARKED_FUNCTIONS
+};
+
+/// \brief Results of the latest benchmark run
+std::array<call_statistics, NUM_BENCHMARKED_FUNCTIONS> benchmark_results;
+
+/// \brief Physical button trace
+std::array<uint16_t, TRACE_LENGTH> button_trace;
+
+/// \brief Raw left stick trace
+std::array<raw_stick, TRACE_LENGTH> stick_trace;
+
+/// \brief Left stick x-axis trace, normalized
+std::array<int32_t, TRACE_LENGTH> normalized_trace;
+
+/// \brief Processed controller state trace, for encoding
+std::array<sticks, TRACE_LENGTH> sticks_trace;
+
+/// \brief Analog trigger trace, for encoding
+std::array<triggers, TRACE_LENGTH> triggers_trace;
+
+/// \brief Left stick x-axis coefficients in floating point, for comparison
+std::array<double, NUM_COEFFICIENTS> double_coefficients;
+
+/// \brief Destination for results that nothing else reads
+volatile int32_t benchmark_sink;
+
+/** \brief Normalize an axis in floating point, as was done before
+ * normalization moved to fixed point
+ *
+ * Only kept as a baseline for the cost of `normalize_axis`.
+ *
+ * \param raw_axis Raw axis value to normalize
+ * \param axis_coefficients Coefficients to use for axis normalization
+ *
+ * \return Normalized axis value
+ */
+double normalize_axis_double(
+    uint16_t raw_axis,
+    const std::array<double, NUM_COEFFICIENTS> &axis_coefficients) {
+  double normalized_axis = 0;
+  for (int i = 0; i < NUM_COEFFICIENTS; ++i) {
+    double raised_raw = 1;
+    for (int j = 0; j < i; ++j) {
+      raised_raw *= raw_axis;
+    }
+    normalized_axis += axis_coefficients[i] * raised_raw;
+  }
+
+  return normalized_axis;
+}
+
+/** \brief Read the timer used to time calls
+ *
+ * \return Current count, in cycles on device and nanoseconds elsewhere
+ */
+inline uint32_t read_benchmark_timer() {
+#if PICO_ON_DEVICE
+  // SysTick counts down, so negate it to count up
+  return -systick_hw->cvr;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+/** \brief Time between two reads of the benchmark timer
+ *
+ * \param start Count before the call
+ * \param end Count after the call
+ *
+ * \return Elapsed time
+ */
+inline uint32_t benchmark_elapsed(uint32_t start, uint32_t end) {
+#if PICO_ON_DEVICE
+  // SysTick is a 24-bit counter
+  return (end - start) & 0x00FFFFFF;
+#else
+  return end - start;
+#endif
+}
+
+/** \brief Generate a triangle wave, deterministically on every platform
+ *
+ * \param phase Position in the wave, one period every 512
+ * \param amplitude Peak value
+ *
+ * \return Value from 0 to `amplitude`
+ */
+uint32_t triangle_wave(uint32_t phase, uint32_t amplitude) {
+  uint32_t position = phase % 512;
+  if (position >= 256) {
+    position = 511 - position;
+  }
+  return (position * amplitude) / 255;
+}
+
+/// \brief Fill the input traces
+void generate_traces() {
+  // Linear congruential generator with a fixed seed for button presses
+  uint32_t seed = 0x4F70656E;
+
+  constexpr uint32_t raw_max = (1 << STICK_RAW_BITS) - 1;
+  for (uint i = 0; i < TRACE_LENGTH; ++i) {
+    seed = (seed * 1664525) + 1013904223;
+    button_trace[i] = (seed >> 16) & ((1 << (START + 1)) - 1);
+
+    // Sweep around the stick at differing rates on each axis, so every
+    // octant & snapback case is visited
+    stick_trace[i] = {static_cast<uint16_t>(triangle_wave(i * 7, raw_max)),
+                      static_cast<uint16_t>(triangle_wave(i * 11 + 128,
+                                                          raw_max)),
+                      true, i * STICK_TRACE_PERIOD_US};
+    normalized_trace[i] = normalize_axis(
+        stick_trace[i].x, state.l_stick_coefficients.x_coefficients);
+
+    uint8_t axis = triangle_wave(i * 5, 255);
+    sticks_trace[i] = {{axis, static_cast<uint8_t>(255 - axis)},
+                       {static_cast<uint8_t>(axis / 2), axis}};
+    triggers_trace[i] = {
+        static_cast<uint16_t>(triangle_wave(i * 3, TRIGGER_MAX)),
+        static_cast<uint16_t>(triangle_wave(i * 13, TRIGGER_MAX))};
+  }
+}
+
+/** \brief Time a function over every entry of a trace
+ *
+ * \param result Output for the timing statistics
+ * \param name Name of the function
+ * \param call Function to call with each trace index
+ */
+template <typename F>
+void run_benchmark(call_statistics &result, const char *name, F call) {
+  // Time an empty measurement, to subtract the cost of reading the timer
+  uint32_t overhead = UINT32_MAX;
+  for (uint i = 0; i < 16; ++i) {
+    uint32_t start = read_benchmark_timer();
+    uint32_t end = read_benchmark_timer();
+    overhead = std::min(overhead, benchmark_elapsed(start, end));
+  }
+
+  result = {name, UINT32_MAX, 0, 0, 0};
+  for (uint pass = 0; pass < TRACE_PASSES; ++pass) {
+    for (uint i = 0; i < TRACE_LENGTH; ++i) {
+      uint32_t start = read_benchmark_timer();
+      call(i);
+      uint32_t end = read_benchmark_timer();
+
+      uint32_t elapsed = benchmark_elapsed(start, end);
+      elapsed -= std::min(elapsed, overhead);
+      result.min = std::min(result.min, elapsed);
+      result.max = std::max(result.max, elapsed);
+      result.total += elapsed;
+      ++result.count;
+    }
+  }
+}
+
+/** \brief Time a stick pipeline composition over every sample of the stick
+ * trace
+ *
+ * Every stage is enabled, whatever the configuration, so compositions are
+ * compared doing their full work.
+ *
+ * \tparam pipeline Stick pipeline to time
+ *
+ * \param result Output for the timing statistics
+ * \param name Name of the composition
+ */
+template <typename pipeline>
+void run_pipeline_benchmark(call_statistics &result, const char *name) {
+  static stick_snapback_state snapback_state;
+  static stick_filter_state filter_state;
+  static uint32_t pass_offset = 0;
+  static stick_filter_parameters filter = DEFAULT_STICK_FILTER_PARAMETERS;
+  filter.enabled = true;
+  controller_configuration &config = controller_configuration::get_instance();
+
+  stick_context context = {state.l_stick_coefficients,
+                           DEFAULT_SNAPBACK_PARAMETERS,
+                           snapback_state,
+                           filter,
+                           filter_state,
+                           config.l_stick_range};
+  run_benchmark(result, name, [&](uint i) {
+    if (i == 0) {
+      pass_offset += TRACE_LENGTH * STICK_TRACE_PERIOD_US;
+    }
+    raw_stick sample = stick_trace[i];
+    sample.timestamp += pass_offset;
+    benchmark_sink = pipeline::process(sample, context).x;
+  });
+}
+
+/// \brief Run every benchmark, updating `benchmark_results`
+void run_benchmarks() {
+  controller_configuration &config = controller_configuration::get_instance();
+
+  run_benchmark(benchmark_results[benchmark_read_digital], "read_digital",
+                [](uint i) { read_digital(button_trace[i]); });
+
+  run_benchmark(benchmark_results[benchmark_read_triggers], "read_triggers",
+                [](uint i) { read_triggers(); });
+
+  run_benchmark(benchmark_results[benchmark_normalize_axis], "normalize_axis",
+                [](uint i) {
+                  benchmark_sink = normalize_axis(
+                      stick_trace[i].x,
+                      state.l_stick_coefficients.x_coefficients);
+                });
+
+  run_benchmark(benchmark_results[benchmark_normalize_axis_double],
+                "normalize_axis (double)", [](uint i) {
+                  benchmark_sink = std::lround(
+                      normalize_axis_double(stick_trace[i].x,
+                                            double_coefficients) *
+                      (1 << NORMALIZED_FRACTIONAL_BITS));
+                });
+
+  // Blend between neighbouring normalized samples as if they were table
+  // entries, & quantize the normalized samples, both with the interpolators
+  // & with the calculations they replace. On the host, the interpolators are
+  // a model, so only the device results compare the two.
+  run_benchmark(benchmark_results[benchmark_blend_interpolated],
+                "blend_axis (interp)", [](uint i) {
+                  benchmark_sink = interpolated_blend_axis(
+                      normalized_trace[i],
+                      normalized_trace[(i + 1) % TRACE_LENGTH], i * 37);
+                });
+
+  run_benchmark(benchmark_results[benchmark_blend_calculated],
+                "blend_axis (calculated)", [](uint i) {
+                  benchmark_sink = calculated_blend_axis(
+                      normalized_trace[i],
+                      normalized_trace[(i + 1) % TRACE_LENGTH], i * 37);
+                });
+
+  run_benchmark(benchmark_results[benchmark_round_and_clamp_interpolated],
+                "round_and_clamp (interp)", [&config](uint i) {
+                  benchmark_sink = interpolated_round_and_clamp_axis(
+                      normalized_trace[i], CENTER - config.l_stick_range,
+                      CENTER + config.l_stick_range);
+                });
+
+  run_benchmark(benchmark_results[benchmark_round_and_clamp_calculated],
+                "round_and_clamp (calc)", [&config](uint i) {
+                  benchmark_sink = calculated_round_and_clamp_axis(
+                      normalized_trace[i], CENTER - config.l_stick_range,
+                      CENTER + config.l_stick_range);
+                });
+
+  // Smooth the trace scaled to output units, with smoothing enabled whatever
+  // the configuration
+  static stick_filter_state benchmark_filter_state;
+  run_benchmark(benchmark_results[benchmark_filter_stick], "filter_stick",
+                [](uint i) {
+                  constexpr uint shift =
+                      NORMALIZED_FRACTIONAL_BITS + 8 - STICK_RAW_BITS;
+                  stick_filter_parameters parameters =
+                      DEFAULT_STICK_FILTER_PARAMETERS;
+                  parameters.enabled = true;
+                  precise_stick filtered = filter_stick(
+                      {stick_trace[i].x << shift, stick_trace[i].y << shift},
+                      stick_trace[i].timestamp, parameters,
+                      benchmark_filter_state);
+                  benchmark_sink = filtered.x;
+                });
+
+  // Compositions from normalization & quantization alone up to every stage
+  run_pipeline_benchmark<
+      stick_pipeline<polynomial_normalization, round_and_clamp_quantization>>(
+      benchmark_results[benchmark_pipeline_normalize], "pipeline (normalize)");
+  run_pipeline_benchmark<
+      stick_pipeline<polynomial_normalization, round_and_clamp_quantization,
+                     notch_remapping>>(
+      benchmark_results[benchmark_pipeline_notches], "pipeline (+notches)");
+  run_pipeline_benchmark<
+      stick_pipeline<polynomial_normalization, round_and_clamp_quantization,
+                     notch_remapping, snapback_filtering>>(
+      benchmark_results[benchmark_pipeline_snapback], "pipeline (+snapback)");
+  run_pipeline_benchmark<
+      stick_pipeline<polynomial_normalization, hysteresis_quantization,
+                     notch_remapping, snapback_filtering, adaptive_filtering>>(
+      benchmark_results[benchmark_pipeline_smoothing],
+      "pipeline (+smoothing)");
+
+  // Feed the stick trace through a queue of its own, with state of its own,
+  // so the sensors don't affect the result. Timestamps advance with each pass
+  // so filters see continuous motion.
+  static stick_sample_ring samples;
+  static stick_snapback_state snapback_state;
+  static stick_filter_state filter_state;
+  static stick_aggregation_state aggregation_state;
+  static uint32_t pass_offset = 0;
+  stick processed_stick = {CENTER, CENTER};
+  run_benchmark(
+      benchmark_results[benchmark_process_stick_samples],
+      "process_stick_samples", [&](uint i) {
+        if (i == 0) {
+          pass_offset += TRACE_LENGTH * STICK_TRACE_PERIOD_US;
+        }
+        raw_stick sample = stick_trace[i];
+        sample.timestamp += pass_offset;
+        samples.push(sample);
+        processed_stick = process_stick_samples(
+            samples, processed_stick, state.l_stick_coefficients,
+            config.l_stick_snapback_parameters(), snapback_state,
+            config.l_stick_filter_parameters(), filter_state,
+            config.l_stick_range, config.stick_aggregation(),
+            aggregation_state, i / STICK_TRACE_SAMPLES_PER_POLL);
+      });
+
+  static joybus_response response;
+  run_benchmark(benchmark_results[benchmark_encode_mode], "encode_mode",
+                [](uint i) {
+                  encode_mode(i % NUM_POLL_MODES, button_trace[i],
+                              sticks_trace[i], triggers_trace[i], response);
+                });
+}
+
+/// \brief Report `benchmark_results` over stdio
+void report_benchmarks() {
+#if PICO_ON_DEVICE
+  const char *unit = "cycles";
+#else
+  const char *unit = "ns";
+#endif
+
+  // Costs relative to the cheapest function make host results comparable
+  // between machines
+  uint64_t cheapest_mean = UINT64_MAX;
+  for (const call_statistics &result : benchmark_results) {
+    cheapest_mean = std::min(cheapest_mean, result.total / result.count);
+  }
+  cheapest_mean = std::max<uint64_t>(cheapest_mean, 1);
+
+  printf("%-24s %10s %10s %10s %9s (%s)\n", "function", "min", "mean", "max",
+         "relative", unit);
+  for (const call_statistics &result : benchmark_results) {
+    uint64_t mean = result.total / result.count;
+    printf("%-24s %10lu %10lu %10lu %8lu%%\n", result.name,
+           static_cast<unsigned long>(result.min),
+           static_cast<unsigned long>(mean),
+           static_cast<unsigned long>(result.max),
+           static_cast<unsigned long>((mean * 100) / cheapest_mean));
+  }
+  printf("\n");
+}
+
+int main() {
+#if PICO_ON_DEVICE
+  // Run at the same clock as the firmware
+  set_sys_clock_pll(1536 * MHZ, 6, 2);
+
+  // Count processor cycles with SysTick
+  systick_hw->rvr = 0x00FFFFFF;
+  systick_hw->cvr = 0;
+  systick_hw->csr = 0b101;
+#endif
+
+  stdio_init_all();
+  init_triggers();
+  init_stick_interpolators();
+
+  controller_configuration &config = controller_configuration::get_instance();
+  stick_calibration(config.l_stick_range,
+                    config.l_stick_calibration_measurement)
+      .generate_coefficients(state.l_stick_coefficients);
+  for (int i = 0; i < NUM_COEFFICIENTS; ++i) {
+    double_coefficients[i] =
+        ldexp(state.l_stick_coefficients.x_coefficients[i], -16 * (i + 1));
+  }
+
+  generate_traces();
+
+#if PICO_ON_DEVICE
+  while (true) {
+    run_benchmarks();
+    report_benchmarks();
+    sleep_ms(5000);
+  }
+#else
+  // On the host, run once & report to the terminal
+  run_benchmarks();
+  report_benchmarks();
+#endif
+
+  return 0;
+}
@@ -0,0 +1,61 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "button_remap.hpp"
+
+#include "main.hpp"
+
+button_remap compiled_button_remap = {};
+
+// Remap physical button states with the current profile's mappings, marking
+// whether either trigger's digital output is pressed before masking it
+uint32_t compile_remap_entry(controller_configuration &config,
+                             uint16_t physical_buttons, uint16_t digital_mask) {
+  uint16_t remapped_buttons = remap_buttons(config, physical_buttons, 0);
+
+  bool lt_pressed = (remapped_buttons & (1 << LT_DIGITAL)) != 0;
+  bool rt_pressed = (remapped_buttons & (1 << RT_DIGITAL)) != 0;
+
+  return (remapped_buttons & digital_mask) | (lt_pressed << REMAP_LT_PRESSED) |
+         (rt_pressed << REMAP_RT_PRESSED);
+}
+
+void compile_button_remap(controller_configuration &config) {
+  uint16_t digital_mask = 0xFFFF;
+  apply_trigger_mode_digital(digital_mask, LT_DIGITAL,
+                             config.l_trigger_mode());
+  apply_trigger_mode_digital(digital_mask, RT_DIGITAL,
+                             config.r_trigger_mode());
+
+  // Buttons are remapped from highest to lowest bit, with later buttons
+  // overriding earlier ones mapped to the same output. So a low byte entry,
+  // with the high byte released, sets exactly the outputs its buttons win,
+  // and a high byte entry, with the low byte released, leaves outputs the low
+  // byte wins cleared. This makes the two entries safe to OR together.
+  for (uint byte = 0; byte < 256; ++byte) {
+    compiled_button_remap.low[byte] =
+        compile_remap_entry(config, byte, digital_mask);
+    compiled_button_remap.high[byte] =
+        compile_remap_entry(config, byte << 8, digital_mask);
+  }
+
+  // Outputs no button is mapped to are never cleared
+  compiled_button_remap.unmapped = remap_buttons(config, 0, 0xFFFF);
+}
+
+const button_remap &current_button_remap() { return compiled_button_remap; }
@@ -0,0 +1,97 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef BUTTON_REMAP_H_
+#define BUTTON_REMAP_H_
+
+#include <pico/types.h>
+
+#include <array>
+
+#include "configuration.hpp"
+#include "state.hpp"
+
+/** \file button_remap.hpp
+ * \brief Button mappings compiled into lookup tables
+ *
+ * Whenever the profile changes or a configuration is saved, the button
+ * mappings & digital trigger modes of the current profile are compiled into
+ * two tables, each mapping a byte of the physical button states to its
+ * contribution to the output. Remapping is then two lookups ORed together,
+ * rather than moving each button in turn.
+ *
+ * The tables are generated from `remap_buttons()` &
+ * `apply_trigger_mode_digital()`, so they match them for any mappings,
+ * including ones which map several buttons to the same output.
+ */
+
+/** \brief Bit of a remap table entry set when the left trigger's digital
+ * output is pressed, before its trigger mode is applied
+ */
+constexpr uint REMAP_LT_PRESSED = 16;
+
+/** \brief Bit of a remap table entry set when the right trigger's digital
+ * output is pressed, before its trigger mode is applied
+ */
+constexpr uint REMAP_RT_PRESSED = 17;
+
+/// \brief Button mappings & digital trigger modes of a profile, compiled
+struct button_remap {
+  /// \brief Contribution of the low byte of the physical button states
+  std::array<uint32_t, 256> low;
+
+  /// \brief Contribution of the high byte of the physical button states
+  std::array<uint32_t, 256> high;
+
+  /// \brief Output bits no button is mapped to, which keep their own value
+  uint16_t unmapped;
+};
+
+/** \brief Compile the button mappings & digital trigger modes of the current
+ * profile
+ *
+ * \note Only used from core 0, which also reads the digital inputs, so the
+ * tables are never read while being built.
+ *
+ * \param config Configuration to compile from
+ */
+void compile_button_remap(controller_configuration &config);
+
+/** \brief Get the compiled button mappings
+ *
+ * \return Compiled button mappings & digital trigger modes
+ */
+const button_remap &current_button_remap();
+
+/** \brief Remap physical button states with compiled mappings
+ *
+ * \param remap Compiled button mappings
+ * \param physical_buttons Physical button states
+ * \param fixed_buttons Output button states not driven by physical buttons
+ *
+ * \return Output button states in the low 16 bits, along with
+ * `REMAP_LT_PRESSED` & `REMAP_RT_PRESSED`
+ */
+inline uint32_t apply_button_remap(const button_remap &remap,
+                                   uint16_t physical_buttons,
+                                   uint16_t fixed_buttons) {
+  return remap.low[physical_buttons & 0xFF] |
+         remap.high[physical_buttons >> 8] | (fixed_buttons & remap.unmapped);
+}
+
+#endif  // BUTTON_REMAP_H_
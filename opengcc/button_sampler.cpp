@@ -0,0 +1,121 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "button_sampler.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "button_sampler.pio.h"
+#include "hardware/dma.h"
+#include "hardware/timer.h"
+
+alignas(BUTTON_SAMPLER_RING_BYTES)
+    std::array<uint32_t, BUTTON_SAMPLER_RING_SIZE> sampled_pins = {};
+alignas(BUTTON_SAMPLER_RING_BYTES)
+    std::array<uint32_t, BUTTON_SAMPLER_RING_SIZE> sampled_timestamps = {};
+
+uint button_timestamp_dma = 0;
+uint next_sampled_change = 0;
+uint32_t last_sampled_timestamp = 0;
+
+void init_button_sampler(PIO pio, uint first_pin, uint num_pins) {
+  // Make the sample instruction read exactly the given pins, so changes on
+  // other pins aren't pushed
+  std::array<uint16_t, PIO_INSTRUCTION_COUNT> instructions = {};
+  std::copy_n(button_sampler_program.instructions,
+              button_sampler_program.length, instructions.begin());
+  instructions[button_sampler_offset_sample] =
+      pio_encode_in(pio_pins, num_pins);
+
+  pio_program program = button_sampler_program;
+  program.instructions = instructions.data();
+  uint offset = pio_add_program(pio, &program);
+  uint sm = pio_claim_unused_sm(pio, true);
+
+  // Claim sampler DMA channels
+  uint pins_dma = dma_claim_unused_channel(true);
+  button_timestamp_dma = dma_claim_unused_channel(true);
+
+  // Move each change into the pin ring, then timestamp it
+  dma_channel_config pins_config = dma_channel_get_default_config(pins_dma);
+  channel_config_set_read_increment(&pins_config, false);
+  channel_config_set_write_increment(&pins_config, true);
+  channel_config_set_ring(&pins_config, true,
+                          __builtin_ctz(BUTTON_SAMPLER_RING_BYTES));
+  channel_config_set_dreq(&pins_config, pio_get_dreq(pio, sm, false));
+  channel_config_set_chain_to(&pins_config, button_timestamp_dma);
+
+  // Copy the timer into the timestamp ring, then wait for the next change
+  dma_channel_config timestamp_config =
+      dma_channel_get_default_config(button_timestamp_dma);
+  channel_config_set_read_increment(&timestamp_config, false);
+  channel_config_set_write_increment(&timestamp_config, true);
+  channel_config_set_ring(&timestamp_config, true,
+                          __builtin_ctz(BUTTON_SAMPLER_RING_BYTES));
+  channel_config_set_chain_to(&timestamp_config, pins_dma);
+
+  // Each channel moves a single word every time it's triggered, so the two
+  // rings stay in step
+  dma_channel_configure(button_timestamp_dma, &timestamp_config,
+                        sampled_timestamps.data(), &timer_hw->timerawl, 1,
+                        false);
+  dma_channel_configure(pins_dma, &pins_config, sampled_pins.data(),
+                        &pio->rxf[sm], 1, true);
+
+  button_sampler_program_init(pio, sm, offset, first_pin, num_pins,
+                              BUTTON_SAMPLE_RATE_HZ);
+}
+
+uint ring_position(uint channel,
+                  const std::array<uint32_t, BUTTON_SAMPLER_RING_SIZE> &ring) {
+  return (dma_channel_hw_addr(channel)->write_addr -
+          reinterpret_cast<uintptr_t>(ring.data())) /
+         sizeof(uint32_t);
+}
+
+bool get_sampled_pins(uint32_t &pins, uint32_t &timestamp) {
+  const volatile uint32_t *pin_ring = sampled_pins.data();
+  const volatile uint32_t *timestamp_ring = sampled_timestamps.data();
+
+  // A change is complete once its timestamp is written
+  uint written = ring_position(button_timestamp_dma, sampled_timestamps);
+
+  // Read the next change, then check the ring hasn't been lapped. Lapping
+  // overwrites the timestamp of the last change returned before any change
+  // not yet returned, so if it's intact, so is the change read.
+  uint last_returned = (next_sampled_change - 1) % BUTTON_SAMPLER_RING_SIZE;
+  pins = pin_ring[next_sampled_change];
+  timestamp = timestamp_ring[next_sampled_change];
+  if (timestamp_ring[last_returned] == last_sampled_timestamp) {
+    if (written == next_sampled_change) {
+      return false;
+    }
+    next_sampled_change = (next_sampled_change + 1) % BUTTON_SAMPLER_RING_SIZE;
+  } else {
+    // The ring was lapped, so skip to the newest change, which is the
+    // furthest from being overwritten
+    uint newest = (written - 1) % BUTTON_SAMPLER_RING_SIZE;
+    pins = pin_ring[newest];
+    timestamp = timestamp_ring[newest];
+    next_sampled_change = written;
+  }
+
+  last_sampled_timestamp = timestamp;
+  return true;
+}
@@ -0,0 +1,67 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef BUTTON_SAMPLER_H_
+#define BUTTON_SAMPLER_H_
+
+#include <pico/types.h>
+
+#include "hardware/pio.h"
+
+/** \file button_sampler.hpp
+ * \brief Timestamped button sampling with PIO & DMA
+ *
+ * A PIO state machine samples a block of consecutive pins at
+ * `BUTTON_SAMPLE_RATE_HZ`, and pushes their states only when they change. One
+ * DMA channel moves each change into a ring, then chains to another which
+ * copies the timer into a parallel ring, so each change is timestamped to
+ * within a sample without any CPU involvement.
+ */
+
+/// \brief Rate pins are sampled at
+constexpr uint32_t BUTTON_SAMPLE_RATE_HZ = 200000;
+
+/// \brief Number of changes kept, a power of two
+constexpr uint BUTTON_SAMPLER_RING_SIZE = 128;
+
+/// \brief Size of each ring in bytes, which it must also be aligned to
+constexpr uint BUTTON_SAMPLER_RING_BYTES =
+    BUTTON_SAMPLER_RING_SIZE * sizeof(uint32_t);
+
+/** \brief Start sampling pins
+ *
+ * \param pio PIO block to sample with
+ * \param first_pin First pin to sample
+ * \param num_pins Number of consecutive pins to sample
+ */
+void init_button_sampler(PIO pio, uint first_pin, uint num_pins);
+
+/** \brief Get the oldest change in sampled pin states not yet returned
+ *
+ * \note If `BUTTON_SAMPLER_RING_SIZE` or more changes arrive between calls,
+ * the ring has been lapped, and only the latest is returned.
+ *
+ * \param pins Output for pin states after the change, with the first pin in
+ * bit 0
+ * \param timestamp Output for time of the change, in microseconds since boot
+ *
+ * \return `true` if there was a change, `false` otherwise
+ */
+bool get_sampled_pins(uint32_t &pins, uint32_t &timestamp);
+
+#endif  // BUTTON_SAMPLER_H_
@@ -18,6 +18,9 @@
 
 #include "calibration.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 #include "curve_fitting.hpp"
 
 stick_calibration::stick_calibration(uint8_t range)
@@ -51,8 +54,23 @@ stick_calibration::stick_calibration(
 
 void stick_calibration::display_step(stick &display_stick) {
   // Set display stick to expected x & y for current calibration step
-  display_stick.x = expected_measurement.x_coordinates[current_step];
-  display_stick.y = expected_measurement.y_coordinates[current_step];
+  if (current_step < NUM_CALIBRATION_STEPS) {
+    display_stick.x = expected_measurement.x_coordinates[current_step];
+    display_stick.y = expected_measurement.y_coordinates[current_step];
+  } else {
+    size_t notch = current_step - NUM_CALIBRATION_STEPS;
+    display_stick.x = notch_target_x(notch);
+    display_stick.y = notch_target_y(notch);
+  }
+}
+
+uint16_t stick_calibration::notch_target_x(size_t notch) {
+  // Every other main calibration step is a notch, starting from +x
+  return expected_measurement.x_coordinates[(2 * notch) + 1];
+}
+
+uint16_t stick_calibration::notch_target_y(size_t notch) {
+  return expected_measurement.y_coordinates[(2 * notch) + 1];
 }
 
 void stick_calibration::undo_measurement() {
@@ -67,6 +85,12 @@ void stick_calibration::record_measurement(uint16_t x, uint16_t y) {
     actual_measurement.y_coordinates[current_step] = y;
     actual_measurement.skipped_measurements[current_step] = false;
     ++current_step;
+  } else if (current_step < NUM_TOTAL_CALIBRATION_STEPS) {
+    size_t notch = current_step - NUM_CALIBRATION_STEPS;
+    actual_measurement.notch_x_coordinates[notch] = x;
+    actual_measurement.notch_y_coordinates[notch] = y;
+    actual_measurement.skipped_notches[notch] = false;
+    ++current_step;
   }
 }
 
@@ -74,6 +98,10 @@ void stick_calibration::skip_measurement() {
   if (current_step < NUM_CALIBRATION_STEPS) {
     actual_measurement.skipped_measurements[current_step] = true;
     ++current_step;
+  } else if (current_step < NUM_TOTAL_CALIBRATION_STEPS) {
+    actual_measurement.skipped_notches[current_step - NUM_CALIBRATION_STEPS] =
+        true;
+    ++current_step;
   }
 }
 
@@ -81,22 +109,126 @@ stick_calibration_measurement stick_calibration::get_measurement() {
   return actual_measurement;
 }
 
-stick_coefficients stick_calibration::generate_coefficients() {
-  stick_coefficients ret;
-
+void stick_calibration::generate_coefficients(
+    stick_coefficients &coefficients_out) {
 #if NORMALIZATION_ALGORITHM == NONE
-  ret.x_coefficients = std::array<double, NUM_COEFFICIENTS>{0.0, 1.0};
-  ret.y_coefficients = std::array<double, NUM_COEFFICIENTS>{0.0, 1.0};
+  std::array<double, NUM_COEFFICIENTS> x_coefficients = {0.0, 1.0};
+  std::array<double, NUM_COEFFICIENTS> y_coefficients = {0.0, 1.0};
 #else
-  ret.x_coefficients = fit_curve<NUM_COEFFICIENTS, NUM_CALIBRATION_STEPS>(
-      expected_measurement.x_coordinates, actual_measurement.x_coordinates,
-      actual_measurement.skipped_measurements);
-  ret.y_coefficients = fit_curve<NUM_COEFFICIENTS, NUM_CALIBRATION_STEPS>(
-      expected_measurement.y_coordinates, actual_measurement.y_coordinates,
-      actual_measurement.skipped_measurements);
+  std::array<double, NUM_COEFFICIENTS> x_coefficients =
+      fit_curve<NUM_COEFFICIENTS, NUM_CALIBRATION_STEPS>(
+          expected_measurement.x_coordinates, actual_measurement.x_coordinates,
+          actual_measurement.skipped_measurements);
+  std::array<double, NUM_COEFFICIENTS> y_coefficients =
+      fit_curve<NUM_COEFFICIENTS, NUM_CALIBRATION_STEPS>(
+          expected_measurement.y_coordinates, actual_measurement.y_coordinates,
+          actual_measurement.skipped_measurements);
 #endif
 
-  return ret;
+  // Convert once here so normalization doesn't need floating point
+  coefficients_out.x_coefficients =
+      convert_to_fixed_point<NUM_COEFFICIENTS>(x_coefficients);
+  coefficients_out.y_coefficients =
+      convert_to_fixed_point<NUM_COEFFICIENTS>(y_coefficients);
+
+#if NORMALIZATION_TABLE_BUDGET > 0
+  // Sample the polynomial at the start of each table segment
+  for (size_t i = 0; i < NUM_NORMALIZATION_TABLE_ENTRIES; ++i) {
+    uint32_t raw = i << NORMALIZATION_TABLE_SHIFT;
+    coefficients_out.x_table[i] = std::clamp<int64_t>(
+        evaluate_fixed_point<NUM_COEFFICIENTS>(coefficients_out.x_coefficients,
+                                               raw),
+        INT32_MIN, INT32_MAX);
+    coefficients_out.y_table[i] = std::clamp<int64_t>(
+        evaluate_fixed_point<NUM_COEFFICIENTS>(coefficients_out.y_coefficients,
+                                               raw),
+        INT32_MIN, INT32_MAX);
+  }
+#endif
+
+  generate_octants(coefficients_out);
 }
 
-bool stick_calibration::done() { return current_step == NUM_CALIBRATION_STEPS; }
+void stick_calibration::generate_octants(stick_coefficients &coefficients_out) {
+  // Find where each notch is after normalization, and where it should be,
+  // as displacements from center
+  std::array<double, NUM_NOTCHES> measured_x;
+  std::array<double, NUM_NOTCHES> measured_y;
+  std::array<double, NUM_NOTCHES> target_x;
+  std::array<double, NUM_NOTCHES> target_y;
+  for (size_t i = 0; i < NUM_NOTCHES; ++i) {
+    target_x[i] = notch_target_x(i) - CENTER;
+    target_y[i] = notch_target_y(i) - CENTER;
+
+    if (actual_measurement.skipped_notches[i]) {
+      // Skipped notches keep the curve fit's output
+      measured_x[i] = target_x[i];
+      measured_y[i] = target_y[i];
+    } else {
+      measured_x[i] = ldexp(evaluate_fixed_point<NUM_COEFFICIENTS>(
+                                coefficients_out.x_coefficients,
+                                actual_measurement.notch_x_coordinates[i]),
+                            -NORMALIZED_FRACTIONAL_BITS) -
+                      CENTER;
+      measured_y[i] = ldexp(evaluate_fixed_point<NUM_COEFFICIENTS>(
+                                coefficients_out.y_coefficients,
+                                actual_measurement.notch_y_coordinates[i]),
+                            -NORMALIZED_FRACTIONAL_BITS) -
+                      CENTER;
+    }
+  }
+
+  constexpr double matrix_scale = 1 << OCTANT_MATRIX_FRACTIONAL_BITS;
+  constexpr double displacement_scale =
+      1 << (NORMALIZED_FRACTIONAL_BITS - OCTANT_DISPLACEMENT_SHIFT);
+
+  for (size_t i = 0; i < NUM_NOTCHES; ++i) {
+    size_t next = (i + 1) % NUM_NOTCHES;
+    octant_transform &octant = coefficients_out.octants[i];
+    octant.start_x =
+        std::clamp<int32_t>(lround(measured_x[i] * displacement_scale),
+                            -OCTANT_DISPLACEMENT_MAX, OCTANT_DISPLACEMENT_MAX);
+    octant.start_y =
+        std::clamp<int32_t>(lround(measured_y[i] * displacement_scale),
+                            -OCTANT_DISPLACEMENT_MAX, OCTANT_DISPLACEMENT_MAX);
+
+    // Solve for the matrix taking both measured notches to their targets,
+    // target = matrix * measured
+    double determinant =
+        (measured_x[i] * measured_y[next]) - (measured_x[next] * measured_y[i]);
+
+    std::array<double, 4> matrix = {1, 0, 0, 1};
+    if (determinant > 0) {
+      matrix = {((target_x[i] * measured_y[next]) -
+                 (target_x[next] * measured_y[i])) /
+                    determinant,
+                ((target_x[next] * measured_x[i]) -
+                 (target_x[i] * measured_x[next])) /
+                    determinant,
+                ((target_y[i] * measured_y[next]) -
+                 (target_y[next] * measured_y[i])) /
+                    determinant,
+                ((target_y[next] * measured_x[i]) -
+                 (target_y[i] * measured_x[next])) /
+                    determinant};
+    }
+
+    // Leave the octant unchanged if the notches are out of order, or the
+    // transform is implausibly large
+    bool plausible = determinant > 0;
+    for (double element : matrix) {
+      plausible &= fabs(element * matrix_scale) <= OCTANT_MATRIX_ELEMENT_MAX;
+    }
+    if (!plausible) {
+      matrix = {1, 0, 0, 1};
+    }
+
+    for (size_t j = 0; j < matrix.size(); ++j) {
+      octant.matrix[j] = lround(matrix[j] * matrix_scale);
+    }
+  }
+}
+
+bool stick_calibration::done() {
+  return current_step == NUM_TOTAL_CALIBRATION_STEPS;
+}
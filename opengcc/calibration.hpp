@@ -32,7 +32,11 @@
 constexpr size_t NUM_CALIBRATION_STEPS = 16;
 
 /// \brief Number of steps in the notch calibration process
-constexpr size_t NUM_NOTCH_CALIBRATION_STEPS = 8;
+constexpr size_t NUM_NOTCH_CALIBRATION_STEPS = NUM_NOTCHES;
+
+/// \brief Number of steps in the combined calibration process
+constexpr size_t NUM_TOTAL_CALIBRATION_STEPS =
+    NUM_CALIBRATION_STEPS + NUM_NOTCH_CALIBRATION_STEPS;
 
 constexpr uint8_t MIN_RANGE = 80;
 constexpr uint8_t MAX_RANGE = 127;
@@ -42,6 +46,12 @@ struct stick_calibration_measurement {
   std::array<uint16_t, NUM_CALIBRATION_STEPS> x_coordinates;
   std::array<uint16_t, NUM_CALIBRATION_STEPS> y_coordinates;
   std::array<bool, NUM_CALIBRATION_STEPS> skipped_measurements;
+  /// \brief Raw notch x-coordinates, counterclockwise from +x
+  std::array<uint16_t, NUM_NOTCH_CALIBRATION_STEPS> notch_x_coordinates;
+  /// \brief Raw notch y-coordinates, counterclockwise from +x
+  std::array<uint16_t, NUM_NOTCH_CALIBRATION_STEPS> notch_y_coordinates;
+  /// \brief Notches which were skipped, and so map to themselves
+  std::array<bool, NUM_NOTCH_CALIBRATION_STEPS> skipped_notches;
 };
 
 /// \brief Stick calibration implementation
@@ -51,6 +61,29 @@ class stick_calibration {
   stick_calibration_measurement expected_measurement;
   stick_calibration_measurement actual_measurement;
 
+  /** \brief Get the target x-coordinate of a notch
+     *
+     * \param notch Index of notch, counterclockwise from +x
+     *
+     * \return Target x-coordinate
+     */
+  uint16_t notch_target_x(size_t notch);
+
+  /** \brief Get the target y-coordinate of a notch
+     *
+     * \param notch Index of notch, counterclockwise from +x
+     *
+     * \return Target y-coordinate
+     */
+  uint16_t notch_target_y(size_t notch);
+
+  /** \brief Generate the notch remapping for each octant
+     *
+     * \param coefficients_out Coefficients to add octant transforms to, with
+     * normalization coefficients already generated
+     */
+  void generate_octants(stick_coefficients &coefficients_out);
+
  public:
   /** \brief Construct the stick calibration object
      *
@@ -67,6 +100,10 @@ class stick_calibration {
                     stick_calibration_measurement actual_measurement);
 
   /** \brief Display the target location for the current calibration step
+     *
+     * The first `NUM_CALIBRATION_STEPS` steps are the main calibration, the
+     * rest are notch calibration, which display the target of each notch in
+     * turn.
      *
      * \param display_stick The stick to display calibration steps on
      */
@@ -99,9 +136,13 @@ class stick_calibration {
      *
      * \note See src/curve_fitting.hpp for details on coefficient output
      *
-     * \return Coefficients to normalize stick
+     * Also builds the normalization tables when they are enabled, and the
+     * notch remapping. Output is written in place, as the tables are too large
+     * to return on the stack.
+     *
+     * \param coefficients_out Output for coefficients to normalize stick
      */
-  stick_coefficients generate_coefficients();
+  void generate_coefficients(stick_coefficients &coefficients_out);
 };
 
 #endif  // CALIBRATION_H_
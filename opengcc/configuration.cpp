@@ -18,16 +18,36 @@
 
 #include "configuration.hpp"
 
+#include <algorithm>
+#include <new>
+
 #include "analog_controller.hpp"
+#include "button_remap.hpp"
 #include "calibration.hpp"
+#include "debounce.hpp"
 #include "hardware/gpio.h"
+#include "joybus.hpp"
 #include "pico/multicore.h"
 #include "state.hpp"
+#include "trigger_transfer.hpp"
+
+controller_configuration::controller_configuration() { load(); }
+
+void controller_configuration::load() {
+  int read_slot = controller_configuration::read_slot();
 
-controller_configuration::controller_configuration() {
-  int read_page = controller_configuration::read_page();
-  if (read_page == -1) {
+  // Discard configurations stored with a different layout
+  if (read_slot != -1 &&
+      *reinterpret_cast<uint32_t *>(config_slot_address(read_slot)) !=
+          CONFIG_VERSION) {
+    flash_range_erase(CONFIG_FLASH_BASE, FLASH_SECTOR_SIZE);
+    read_slot = -1;
+  }
+
+  if (read_slot == -1) {
     // If there's no stored configuration, load defaults & persist
+    version = CONFIG_VERSION;
+
     // Set up default profile
     configuration_profile default_profile;
     default_profile.mappings[0] = 0b0000;
@@ -47,6 +67,13 @@ controller_configuration::controller_configuration() {
     default_profile.l_trigger_configured_value = TRIGGER_CONFIGURED_VALUE_MIN;
     default_profile.r_trigger_mode = both;
     default_profile.r_trigger_configured_value = TRIGGER_CONFIGURED_VALUE_MIN;
+    default_profile.l_stick_snapback = DEFAULT_SNAPBACK_PARAMETERS;
+    default_profile.r_stick_snapback = DEFAULT_SNAPBACK_PARAMETERS;
+    default_profile.l_stick_filter = DEFAULT_STICK_FILTER_PARAMETERS;
+    default_profile.r_stick_filter = DEFAULT_STICK_FILTER_PARAMETERS;
+    default_profile.button_debounce = DEFAULT_BUTTON_DEBOUNCE_PARAMETERS;
+    default_profile.latch_presses = false;
+    default_profile.stick_aggregation = latest_aggregation;
 
     // Set all profiles to default
     for (int i = 0; i < profiles.size(); ++i) {
@@ -58,21 +85,33 @@ controller_configuration::controller_configuration() {
     l_stick_calibration_measurement.x_coordinates = {};
     l_stick_calibration_measurement.y_coordinates = {};
     l_stick_calibration_measurement.skipped_measurements = {};
+    l_stick_calibration_measurement.notch_x_coordinates = {};
+    l_stick_calibration_measurement.notch_y_coordinates = {};
+    l_stick_calibration_measurement.skipped_notches.fill(true);
     l_stick_range = 106;
 
     r_stick_calibration_measurement.x_coordinates = {};
     r_stick_calibration_measurement.y_coordinates = {};
     r_stick_calibration_measurement.skipped_measurements = {};
+    r_stick_calibration_measurement.notch_x_coordinates = {};
+    r_stick_calibration_measurement.notch_y_coordinates = {};
+    r_stick_calibration_measurement.skipped_notches.fill(true);
     r_stick_range = 106;
 
+    // Set trigger calibration to default
+    l_trigger_calibration = DEFAULT_TRIGGER_CALIBRATION;
+    r_trigger_calibration = DEFAULT_TRIGGER_CALIBRATION;
+
     // Persist
     persist();
+    read_slot = 0;
   }
 
   // Load stored configuration
   controller_configuration *config_in_flash =
       reinterpret_cast<controller_configuration *>(
-          CONFIG_SRAM_BASE + (read_page * FLASH_PAGE_SIZE));
+          config_slot_address(read_slot));
+  version = config_in_flash->version;
   for (int i = 0; i < profiles.size(); ++i) {
     profiles[i] = config_in_flash->profiles[i];
   }
@@ -83,6 +122,10 @@ controller_configuration::controller_configuration() {
   r_stick_calibration_measurement =
       config_in_flash->r_stick_calibration_measurement;
   r_stick_range = config_in_flash->r_stick_range;
+  l_trigger_calibration = config_in_flash->l_trigger_calibration;
+  r_trigger_calibration = config_in_flash->r_trigger_calibration;
+
+  compile_profile();
 }
 
 controller_configuration &controller_configuration::get_instance() {
@@ -90,49 +133,53 @@ controller_configuration &controller_configuration::get_instance() {
   return instance;
 }
 
-void controller_configuration::reload_instance() {
-  get_instance() = controller_configuration();
-}
+void controller_configuration::reload_instance() { get_instance().load(); }
 
-int controller_configuration::read_page() {
-  for (int page = 0; page < PAGES_PER_SECTOR; ++page) {
-    uint32_t read_address = CONFIG_SRAM_BASE + (page * FLASH_PAGE_SIZE);
+int controller_configuration::read_slot() {
+  for (int slot = 0; slot < SLOTS_PER_SECTOR; ++slot) {
+    uintptr_t read_address = config_slot_address(slot);
     if (*reinterpret_cast<uint8_t *>(read_address) == 0xFF) {
       // Return last initialized flash (-1 if no flash is initialized)
-      --page;
-      return page;
+      --slot;
+      return slot;
     }
   }
 
-  // If we never find uninitialized flash, return the last page
-  return LAST_PAGE;
+  // If we never find uninitialized flash, return the last slot
+  return LAST_SLOT;
 }
 
-int controller_configuration::write_page() {
-  return (controller_configuration::read_page() + 1) % PAGES_PER_SECTOR;
+int controller_configuration::write_slot() {
+  return (controller_configuration::read_slot() + 1) % SLOTS_PER_SECTOR;
 }
 
 void controller_configuration::persist() {
-  int to_write = write_page();
-  if (to_write == 0 && read_page() != -1) {
+  int to_write = write_slot();
+  if (to_write == 0 && read_slot() != -1) {
     flash_range_erase(CONFIG_FLASH_BASE, FLASH_SECTOR_SIZE);
   }
 
   // Get current configuration as bytes
   uint8_t *config_bytes = reinterpret_cast<uint8_t *>(this);
-  std::array<uint8_t, FLASH_PAGE_SIZE> buf = {0};
-  // Fill buffer with the configuration bytes and pad with 0xFF
-  for (int i = 0; i < FLASH_PAGE_SIZE; ++i) {
-    if (i < CONFIG_SIZE) {
-      buf[i] = config_bytes[i];
-    } else {
-      buf[i] = 0xFF;
+
+  // Write a page at a time, to keep the buffer small
+  for (int page = 0; page < PAGES_PER_CONFIG; ++page) {
+    std::array<uint8_t, FLASH_PAGE_SIZE> buf = {0};
+    // Fill buffer with the configuration bytes and pad with 0xFF
+    for (int i = 0; i < FLASH_PAGE_SIZE; ++i) {
+      size_t config_index = (page * FLASH_PAGE_SIZE) + i;
+      if (config_index < CONFIG_SIZE) {
+        buf[i] = config_bytes[config_index];
+      } else {
+        buf[i] = 0xFF;
+      }
     }
-  }
 
-  // Write to flash
-  flash_range_program(CONFIG_FLASH_BASE + (to_write * FLASH_PAGE_SIZE),
-                      buf.data(), FLASH_PAGE_SIZE);
+    // Write to flash
+    flash_range_program(CONFIG_FLASH_BASE + (to_write * CONFIG_SLOT_SIZE) +
+                            (page * FLASH_PAGE_SIZE),
+                        buf.data(), FLASH_PAGE_SIZE);
+  }
 }
 
 uint8_t controller_configuration::mapping(size_t index) {
@@ -155,11 +202,52 @@ uint8_t controller_configuration::r_trigger_configured_value() {
   return profiles[current_profile].r_trigger_configured_value;
 }
 
+const snapback_parameters &
+controller_configuration::l_stick_snapback_parameters() {
+  return profiles[current_profile].l_stick_snapback;
+}
+
+const snapback_parameters &
+controller_configuration::r_stick_snapback_parameters() {
+  return profiles[current_profile].r_stick_snapback;
+}
+
+const stick_filter_parameters &
+controller_configuration::l_stick_filter_parameters() {
+  return profiles[current_profile].l_stick_filter;
+}
+
+const stick_filter_parameters &
+controller_configuration::r_stick_filter_parameters() {
+  return profiles[current_profile].r_stick_filter;
+}
+
+const button_debounce_parameters &
+controller_configuration::debounce_parameters() {
+  return profiles[current_profile].button_debounce;
+}
+
+bool controller_configuration::latch_presses() {
+  return profiles[current_profile].latch_presses;
+}
+
+stick_aggregation_mode controller_configuration::stick_aggregation() {
+  return profiles[current_profile].stick_aggregation;
+}
+
 void controller_configuration::select_profile(size_t profile) {
   current_profile = profile;
+  compile_profile();
   persist();
 }
 
+void controller_configuration::compile_profile() {
+  compile_trigger_transfers(*this);
+  compile_button_remap(*this);
+  compile_button_debounce(*this);
+  set_press_latching(latch_presses());
+}
+
 void wait_until_buttons_released(uint16_t buttons_mask = 0xFFFF) {
   absolute_time_t debounce_timeout_time = nil_time;
 
@@ -168,6 +256,7 @@ void wait_until_buttons_released(uint16_t buttons_mask = 0xFFFF) {
     uint16_t physical_buttons = get_buttons() & buttons_mask;
     state.buttons =
         (physical_buttons | (1 << ALWAYS_HIGH) | (state.origin << ORIGIN));
+    update_responses();
 
     // If no buttons are pressed, start the debounce timer
     if (physical_buttons == 0 && is_nil_time(debounce_timeout_time)) {
@@ -184,6 +273,7 @@ void wait_until_buttons_released(uint16_t buttons_mask = 0xFFFF) {
 bool controller_configuration::check_persist_and_quit(
     uint16_t physical_buttons) {
   if (physical_buttons == (1 << START)) {
+    compile_profile();
     persist();
     return true;
   }
@@ -207,6 +297,7 @@ void controller_configuration::swap_mappings() {
     uint16_t physical_buttons = get_buttons();
     state.buttons =
         physical_buttons | (1 << ALWAYS_HIGH) | (state.origin << ORIGIN);
+    update_responses();
 
     // If one button is pressed, set as first button
     if ((physical_buttons & (physical_buttons - 1)) == 0) {
@@ -221,6 +312,7 @@ void controller_configuration::swap_mappings() {
     uint16_t physical_buttons = get_buttons();
     state.buttons =
         physical_buttons | (1 << ALWAYS_HIGH) | (state.origin << ORIGIN);
+    update_responses();
 
     // If one button is pressed, set as second button
     if ((physical_buttons & (physical_buttons - 1)) == 0) {
@@ -248,18 +340,78 @@ void controller_configuration::swap_mappings() {
   profiles[current_profile].mappings[first_mapping_index] = second_mapping;
   profiles[current_profile].mappings[second_mapping_index] = first_mapping;
 
+  compile_profile();
   persist();
   state.display_alert();
 }
 
+void controller_configuration::toggle_press_latching() {
+  profiles[current_profile].latch_presses =
+      !profiles[current_profile].latch_presses;
+
+  compile_profile();
+  persist();
+}
+
+void controller_configuration::cycle_stick_aggregation() {
+  stick_aggregation_mode &mode = profiles[current_profile].stick_aggregation;
+  switch (mode) {
+    case latest_aggregation:
+      mode = mean_aggregation;
+      break;
+    case mean_aggregation:
+      mode = extreme_aggregation;
+      break;
+    case extreme_aggregation:
+    default:
+      mode = latest_aggregation;
+      break;
+  }
+
+  persist();
+}
+
+void toggle_snapback_mode(snapback_parameters &parameters) {
+  // Core 1 switches the axis state over on its next sample
+  parameters.mode =
+      parameters.mode == wave_snapback ? velocity_snapback : wave_snapback;
+}
+
+void controller_configuration::toggle_l_stick_snapback_mode() {
+  toggle_snapback_mode(profiles[current_profile].l_stick_snapback);
+  persist();
+}
+
+void controller_configuration::toggle_r_stick_snapback_mode() {
+  toggle_snapback_mode(profiles[current_profile].r_stick_snapback);
+  persist();
+}
+
+void controller_configuration::toggle_l_stick_filter() {
+  // Once enabled, core 1 restarts the filter from the next sample, as it was
+  // last updated before the combo was held
+  profiles[current_profile].l_stick_filter.enabled =
+      !profiles[current_profile].l_stick_filter.enabled;
+  persist();
+}
+
+void controller_configuration::toggle_r_stick_filter() {
+  profiles[current_profile].r_stick_filter.enabled =
+      !profiles[current_profile].r_stick_filter.enabled;
+  persist();
+}
+
 void controller_configuration::configure_triggers() {
   // Lock core 1 to prevent analog trigger output from being displayed
   multicore_lockout_start_blocking();
 
   wait_until_buttons_released();
 
-  state.analog_triggers.l_trigger = 0;
-  state.analog_triggers.r_trigger = 0;
+  state.analog_triggers.store({0, 0});
+
+  bool calibrating = false;
+  raw_triggers calibration_min = {};
+  raw_triggers calibration_max = {};
 
   while (true) {
     uint16_t physical_buttons = get_buttons();
@@ -275,6 +427,41 @@ void controller_configuration::configure_triggers() {
       return;
     }
 
+    // Track the range of both triggers while Y is held, displaying their raw
+    // values
+    if ((physical_buttons & ~((1 << LT_DIGITAL) | (1 << RT_DIGITAL))) ==
+        (1 << Y)) {
+      raw_triggers trigger_data = get_triggers();
+      if (!calibrating) {
+        calibrating = true;
+        calibration_min = trigger_data;
+        calibration_max = trigger_data;
+      }
+      calibration_min = {std::min(calibration_min.l, trigger_data.l),
+                         std::min(calibration_min.r, trigger_data.r)};
+      calibration_max = {std::max(calibration_max.l, trigger_data.l),
+                         std::max(calibration_max.r, trigger_data.r)};
+
+      state.analog_triggers.store({trigger_data.l, trigger_data.r});
+      update_responses();
+      continue;
+    } else if (calibrating) {
+      // Keep the range of each trigger which moved far enough to be
+      // calibrated
+      calibrating = false;
+      if (calibration_max.l - calibration_min.l >=
+          TRIGGER_CALIBRATION_MIN_SPAN) {
+        l_trigger_calibration.min = calibration_min.l;
+        l_trigger_calibration.max = calibration_max.l;
+      }
+      if (calibration_max.r - calibration_min.r >=
+          TRIGGER_CALIBRATION_MIN_SPAN) {
+        r_trigger_calibration.min = calibration_min.r;
+        r_trigger_calibration.max = calibration_max.r;
+      }
+      state.analog_triggers.store({0, 0});
+    }
+
     // Mask out non-trigger buttons
     uint32_t trigger_pressed =
         physical_buttons & ((1 << LT_DIGITAL) | (1 << RT_DIGITAL));
@@ -346,8 +533,8 @@ void controller_configuration::configure_triggers() {
       }
 
       // Display mode on left trigger & offset on right trigger
-      state.analog_triggers.l_trigger = *mode;
-      state.analog_triggers.r_trigger = *configured_value;
+      state.analog_triggers.store(
+          {precise_trigger(*mode), precise_trigger(*configured_value)});
 
       // Wait for buttons to be released when a combo is pressed
       if ((physical_buttons &
@@ -357,15 +544,17 @@ void controller_configuration::configure_triggers() {
       }
     } else {
       // Otherwise display nothing
-      state.analog_triggers.l_trigger = 0;
-      state.analog_triggers.r_trigger = 0;
+      state.analog_triggers.store({0, 0});
     }
+
+    update_responses();
   }
 }
 
 void controller_configuration::configure_stick(
     uint8_t &range_out, stick_coefficients &coefficients_out,
-    stick_calibration_measurement &measurement_out, stick &display_stick,
+    stick_calibration_measurement &measurement_out,
+    std::function<void(stick)> display_stick,
     std::function<raw_stick()> get_stick) {
   // Lock core 1 to prevent stick output from being displayed
   multicore_lockout_start_blocking();
@@ -387,7 +576,7 @@ void controller_configuration::configure_stick(
 
     // Move onto calibration when Z is pressed
     if (physical_buttons == (1 << Z)) {
-      state.analog_triggers.l_trigger = 0;
+      state.analog_triggers.store({0, 0});
       break;
     }
 
@@ -419,7 +608,8 @@ void controller_configuration::configure_stick(
     }
 
     // Display range on left trigger
-    state.analog_triggers.l_trigger = range_out;
+    state.analog_triggers.store({precise_trigger(range_out), 0});
+    update_responses();
 
     // Wait for buttons to be released when a combo is pressed
     if ((physical_buttons & ((1 << DPAD_UP) | (1 << DPAD_RIGHT) |
@@ -432,11 +622,14 @@ void controller_configuration::configure_stick(
 
   while (!calibration.done()) {
     // Show current step on display stick
-    calibration.display_step(display_stick);
+    stick step_stick;
+    calibration.display_step(step_stick);
+    display_stick(step_stick);
 
     uint16_t physical_buttons = get_buttons();
     state.buttons =
         physical_buttons | (1 << ALWAYS_HIGH) | (state.origin << ORIGIN);
+    update_responses();
 
     // Quit if needed
     bool quit = check_persist_and_quit(physical_buttons);
@@ -467,7 +660,7 @@ void controller_configuration::configure_stick(
     }
   }
 
-  coefficients_out = calibration.generate_coefficients();
+  calibration.generate_coefficients(coefficients_out);
   measurement_out = calibration.get_measurement();
 
   persist();
@@ -478,5 +671,7 @@ void controller_configuration::configure_stick(
 void controller_configuration::factory_reset() {
   flash_range_erase(CONFIG_FLASH_BASE, FLASH_SECTOR_SIZE);
   reload_instance();
-  state = controller_state();
+
+  // Reset in place, as the state may be too large to construct on the stack
+  new (&state) controller_state();
 }
@@ -57,11 +57,50 @@ constexpr uint8_t TRIGGER_CONFIGURED_VALUE_MIN = 49;
 /// \brief Maximum for trigger configured value
 constexpr uint8_t TRIGGER_CONFIGURED_VALUE_MAX = 209;
 
-/// \brief Multiplied by configured value for analog multiplication trigger mode
-constexpr float TRIGGER_MULTIPLIER_M = .0125f;
+/** \brief Added to configured value for analog multiplication trigger mode,
+ * before dividing by `TRIGGER_MULTIPLIER_DIVISOR`
+ *
+ * Together, the multiplier is `configured value * .0125 + .3875`.
+ */
+constexpr uint TRIGGER_MULTIPLIER_OFFSET = 31;
+
+/// \brief Divisor of the analog multiplication trigger mode multiplier
+constexpr uint TRIGGER_MULTIPLIER_DIVISOR = 80;
+
+/// \brief Number of points on a trigger linearization curve
+constexpr size_t NUM_TRIGGER_CURVE_POINTS = 9;
+
+/** \brief Calibration of a single analog trigger
+ *
+ * \note Values have `TRIGGER_BITS` bits.
+ */
+struct trigger_calibration {
+  /// \brief Raw value with the trigger released
+  uint16_t min;
+
+  /// \brief Raw value with the trigger fully pressed
+  uint16_t max;
+
+  /** \brief Linearized value at evenly spaced points across the calibrated
+   * range, from released to fully pressed
+   *
+   * Corrects a sensor whose output isn't proportional to trigger travel.
+   * Values between points are interpolated.
+   */
+  std::array<uint16_t, NUM_TRIGGER_CURVE_POINTS> curve;
+};
 
-/// \brief Added to configured value for analog multiplication trigger mode
-constexpr float TRIGGER_MULTIPLIER_B = 0.3875f;
+/** \brief Smallest range a trigger must move through for it to be
+ * calibrated
+ */
+constexpr uint16_t TRIGGER_CALIBRATION_MIN_SPAN = TRIGGER_MAX / 8;
+
+/// \brief Default trigger calibration, using the full ADC range linearly
+constexpr trigger_calibration DEFAULT_TRIGGER_CALIBRATION = {
+    0,
+    TRIGGER_MAX,
+    {0, 512, 1024, 1536, 2048, 2560, 3072, 3584, TRIGGER_MAX},
+};
 
 /** \brief Settings which a player might change when playing different games
  *
@@ -83,6 +122,27 @@ struct configuration_profile {
 
   /// \brief Right trigger configured value
   uint8_t r_trigger_configured_value;
+
+  /// \brief Left stick snapback filter parameters
+  snapback_parameters l_stick_snapback;
+
+  /// \brief Right stick snapback filter parameters
+  snapback_parameters r_stick_snapback;
+
+  /// \brief Left stick adaptive filter parameters
+  stick_filter_parameters l_stick_filter;
+
+  /// \brief Right stick adaptive filter parameters
+  stick_filter_parameters r_stick_filter;
+
+  /// \brief Button debounce parameters
+  button_debounce_parameters button_debounce;
+
+  /// \brief Whether presses are latched until reported to the console
+  bool latch_presses;
+
+  /// \brief How stick samples are aggregated between polls
+  stick_aggregation_mode stick_aggregation;
 };
 
 /** \brief Current controller configuration
@@ -92,12 +152,25 @@ struct configuration_profile {
 class controller_configuration {
  private:
   controller_configuration();
-  controller_configuration &operator=(controller_configuration &&) = default;
 
-  static int read_page();
-  static int write_page();
+  /** \brief Load the stored configuration, or defaults if there isn't one
+     *
+     * Loads in place, as the configuration is too large for a temporary copy
+     * on the stack.
+     */
+  void load();
+
+  static int read_slot();
+  static int write_slot();
 
  public:
+  /** \brief Layout version of the configuration
+     *
+     * \note Must stay the first member, so it can be checked before anything
+     * else in flash is trusted.
+     */
+  uint32_t version;
+
   /// \brief Profiles
   std::array<configuration_profile, 2> profiles;
 
@@ -116,6 +189,12 @@ class controller_configuration {
   /// \brief Right stick output range
   uint8_t r_stick_range;
 
+  /// \brief Left trigger calibration
+  trigger_calibration l_trigger_calibration;
+
+  /// \brief Right trigger calibration
+  trigger_calibration r_trigger_calibration;
+
   /** \brief Get the configuration instance
      *
      * \return The controller's configuration
@@ -178,50 +257,159 @@ class controller_configuration {
      */
   uint8_t r_trigger_configured_value();
 
+  /** \brief Left stick snapback filter parameters for current profile
+     *
+     * \return The left stick snapback filter parameters
+     */
+  const snapback_parameters &l_stick_snapback_parameters();
+
+  /** \brief Right stick snapback filter parameters for current profile
+     *
+     * \return The right stick snapback filter parameters
+     */
+  const snapback_parameters &r_stick_snapback_parameters();
+
+  /** \brief Left stick adaptive filter parameters for current profile
+     *
+     * \return The left stick adaptive filter parameters
+     */
+  const stick_filter_parameters &l_stick_filter_parameters();
+
+  /** \brief Right stick adaptive filter parameters for current profile
+     *
+     * \return The right stick adaptive filter parameters
+     */
+  const stick_filter_parameters &r_stick_filter_parameters();
+
+  /** \brief Button debounce parameters for current profile
+     *
+     * \return The button debounce parameters
+     */
+  const button_debounce_parameters &debounce_parameters();
+
+  /** \brief Whether the current profile latches presses until reported
+     *
+     * \return Whether presses are latched
+     */
+  bool latch_presses();
+
+  /** \brief Stick aggregation mode for current profile
+     *
+     * \return How stick samples are aggregated between polls
+     */
+  stick_aggregation_mode stick_aggregation();
+
+  /** \brief Compile the current profile's trigger modes, button mappings,
+     * button debounce & press latching into the state used while running
+     */
+  void compile_profile();
+
   /// \brief Set the current profile to the given one
   void select_profile(size_t profile);
 
   /// \brief Enter remap mode
   void swap_mappings();
 
-  /// \brief Enter trigger configuration mode
+  /// \brief Toggle press latching for the current profile
+  void toggle_press_latching();
+
+  /** \brief Cycle the current profile's stick aggregation mode, from latest to
+     * mean to extreme
+     */
+  void cycle_stick_aggregation();
+
+  /// \brief Switch the left stick's snapback mode for the current profile
+  void toggle_l_stick_snapback_mode();
+
+  /// \brief Switch the right stick's snapback mode for the current profile
+  void toggle_r_stick_snapback_mode();
+
+  /// \brief Toggle smoothing of the left stick for the current profile
+  void toggle_l_stick_filter();
+
+  /// \brief Toggle smoothing of the right stick for the current profile
+  void toggle_r_stick_filter();
+
+  /** \brief Enter trigger configuration mode
+     *
+     * Holding a trigger selects it, then A & B cycle its mode while the D-pad
+     * changes its configured value. Holding Y calibrates both triggers: the
+     * lowest & highest readings while Y is held become their calibrated
+     * range, so both should be fully pressed & released before letting go.
+     */
   void configure_triggers();
 
   /** \brief Enter stick configuration mode
+     *
+     * Selects the range, then steps through the main calibration followed by
+     * notch calibration. For each notch, the stick is held in the physical
+     * notch nearest the displayed target and recorded with Z, or skipped with
+     * A to leave that notch as calibrated.
      *
      * \param range_out Output for range
      * \param coefficients_out Output for coefficients
      * \param measurement_out Output for measurement
-     * \param display_stick Stick to display calibration (stick not being
-     * calibrated)
+     * \param display_stick Function to display calibration steps (on stick
+     * not being calibrated)
      * \param get_stick Function to get stick
      */
   void configure_stick(uint8_t &range_out, stick_coefficients &coefficients_out,
                        stick_calibration_measurement &measurement_out,
-                       stick &display_stick,
+                       std::function<void(stick)> display_stick,
                        std::function<raw_stick()> get_stick);
 
   /// \brief Erase all stored configurations
   static void factory_reset();
 };
 
+/** \brief Current configuration layout version
+ *
+ * Must be incremented whenever the layout of `controller_configuration`
+ * changes, so configurations stored by older firmware are replaced with
+ * defaults rather than misread. Must not have 0xFF as its low byte, as that
+ * marks unused flash.
+ */
+constexpr uint32_t CONFIG_VERSION = 9;
+
 /// \brief Flash address of first possible configuration
 constexpr uint32_t CONFIG_FLASH_BASE =
     PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE;
 
-/// \brief Memory-mapped address of first possible configuration
-constexpr uint32_t CONFIG_SRAM_BASE =
-    XIP_NOCACHE_NOALLOC_BASE + CONFIG_FLASH_BASE;
-
 /// \brief Number of flash pages per flash sector
 constexpr uint32_t PAGES_PER_SECTOR = FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE;
 
-/// \brief Index of last page in a sector
-constexpr uint32_t LAST_PAGE = PAGES_PER_SECTOR - 1;
-
 /// \brief The number of bytes the controller configuration occupies
 constexpr size_t CONFIG_SIZE = sizeof(controller_configuration);
 
+/// \brief Number of flash pages each stored configuration occupies
+constexpr uint32_t PAGES_PER_CONFIG =
+    (CONFIG_SIZE + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+
+/// \brief Size of the flash slot each stored configuration occupies
+constexpr uint32_t CONFIG_SLOT_SIZE = PAGES_PER_CONFIG * FLASH_PAGE_SIZE;
+
+/// \brief Number of configuration slots per flash sector
+constexpr uint32_t SLOTS_PER_SECTOR = PAGES_PER_SECTOR / PAGES_PER_CONFIG;
+
+static_assert(CONFIG_SIZE <= FLASH_SECTOR_SIZE,
+              "Controller configuration must fit in one flash sector");
+static_assert(SLOTS_PER_SECTOR > 0,
+              "Flash sector must hold at least one configuration slot");
+
+/// \brief Index of last configuration slot in a sector
+constexpr uint32_t LAST_SLOT = SLOTS_PER_SECTOR - 1;
+
+/** \brief Get the memory-mapped address of a configuration slot
+ *
+ * \param slot Index of the slot
+ *
+ * \return Address the slot is read from
+ */
+inline uintptr_t config_slot_address(int slot) {
+  return XIP_NOCACHE_NOALLOC_BASE + CONFIG_FLASH_BASE +
+         (slot * CONFIG_SLOT_SIZE);
+}
+
 /** \brief How many milliseconds to debounce on button releases to prevent
  * double presses when configuring
  */
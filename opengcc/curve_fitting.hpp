@@ -64,6 +64,37 @@ std::array<double, num_coefficients> fit_curve(
     const std::array<uint16_t, num_calibration_steps>& actual_coordinates,
     const std::array<bool, num_calibration_steps>& skipped_coordinates);
 
+/** \brief Converts polynomial coefficients to fixed point for evaluation with
+ * integer arithmetic
+ *
+ * The returned coefficients describe the same polynomial in terms of
+ * `x / 2^16` rather than `x`, with every coefficient scaled by `2^16`, i.e.
+ * `ret[i] = coefficients[i] * 2^(16 * (i + 1))`. This keeps the input within
+ * [0, 1) for any 16-bit sensor value, so evaluating with Horner's method in
+ * 64-bit integers can't overflow for any reasonable calibration, and leaves the
+ * result with 16 fractional bits.
+ *
+ * \tparam num_coefficients Number of coefficients
+ * \param coefficients Coefficients generated by `fit_curve`
+ *
+ * \return Fixed-point coefficients
+ */
+template <uint num_coefficients>
+std::array<int64_t, num_coefficients> convert_to_fixed_point(
+    const std::array<double, num_coefficients>& coefficients);
+
+/** \brief Evaluates a polynomial with fixed-point coefficients
+ *
+ * \tparam num_coefficients Number of coefficients
+ * \param coefficients Coefficients generated by `convert_to_fixed_point`
+ * \param x Value to evaluate the polynomial at
+ *
+ * \return Value of the polynomial with 16 fractional bits
+ */
+template <uint num_coefficients>
+int64_t evaluate_fixed_point(
+    const std::array<int64_t, num_coefficients>& coefficients, uint32_t x);
+
 #include "curve_fitting.tpp"
 
 #endif  // CURVE_FITTING_H_
@@ -19,6 +19,7 @@
 #include <pico/types.h>
 
 #include <array>
+#include <cmath>
 #include <vector>
 
 template <uint dimension>
@@ -147,3 +148,27 @@ std::array<double, num_coefficients> fit_curve(
 
   return ret;
 }
+
+template <uint num_coefficients>
+std::array<int64_t, num_coefficients> convert_to_fixed_point(
+    const std::array<double, num_coefficients>& coefficients) {
+  std::array<int64_t, num_coefficients> ret = {};
+
+  for (int i = 0; i < num_coefficients; ++i) {
+    ret[i] = llround(ldexp(coefficients[i], 16 * (i + 1)));
+  }
+
+  return ret;
+}
+
+template <uint num_coefficients>
+int64_t evaluate_fixed_point(
+    const std::array<int64_t, num_coefficients>& coefficients, uint32_t x) {
+  // Horner's method, treating x as a fraction of 2^16
+  int64_t ret = coefficients[num_coefficients - 1];
+  for (int i = num_coefficients - 2; i >= 0; --i) {
+    ret = ((ret * x) >> 16) + coefficients[i];
+  }
+
+  return ret;
+}
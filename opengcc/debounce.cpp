@@ -0,0 +1,115 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "debounce.hpp"
+
+#include <algorithm>
+
+compiled_button_debounce compiled_debounce = {
+    0xFFFF,
+    0x0000,
+    {},
+    {},
+};
+
+// Ticks a change must be counted for to have lasted at least `time_us`. The
+// tick a change is first seen in is partial, lasting as little as 1us, so the
+// remaining `time_us - 1` must be covered by whole ticks.
+uint32_t debounce_ticks(uint32_t time_us) {
+  time_us = std::min(time_us, DEBOUNCE_MAX_US);
+  if (time_us == 0) {
+    return 0;
+  }
+  return ((time_us - 1 + DEBOUNCE_TICK_US - 1) / DEBOUNCE_TICK_US) + 1;
+}
+
+void compile_button_debounce(controller_configuration &config) {
+  const button_debounce_parameters &parameters = config.debounce_parameters();
+
+  compiled_debounce.eager_press = parameters.eager_press;
+  compiled_debounce.defer_release = parameters.defer_release;
+
+  uint32_t press_ticks = debounce_ticks(parameters.press_us);
+  uint32_t release_ticks = debounce_ticks(parameters.release_us);
+  for (uint bit = 0; bit < DEBOUNCE_COUNTER_BITS; ++bit) {
+    compiled_debounce.press_ticks[bit] = ((press_ticks >> bit) & 1) * 0xFFFF;
+    compiled_debounce.release_ticks[bit] =
+        ((release_ticks >> bit) & 1) * 0xFFFF;
+  }
+}
+
+uint16_t debounce_buttons(uint16_t physical_buttons, uint32_t timestamp,
+                          button_debounce_state &debounce_state) {
+  const compiled_button_debounce &debounce = compiled_debounce;
+  std::array<uint16_t, DEBOUNCE_COUNTER_BITS> &counter = debounce_state.counter;
+
+  uint16_t changed = physical_buttons ^ debounce_state.output;
+  uint16_t pressed = changed & physical_buttons;
+  uint16_t released = changed & ~physical_buttons;
+
+  // Changes passed on without confirmation
+  uint16_t accepted = (pressed & debounce.eager_press) |
+                      (released & ~debounce.defer_release);
+
+  // Each button's target count depends on which way it changed, so build its
+  // bit planes, and restart the count of buttons back at their output
+  std::array<uint16_t, DEBOUNCE_COUNTER_BITS> target;
+  for (uint bit = 0; bit < DEBOUNCE_COUNTER_BITS; ++bit) {
+    target[bit] = (physical_buttons & debounce.press_ticks[bit]) |
+                  (~physical_buttons & debounce.release_ticks[bit]);
+    counter[bit] &= changed;
+  }
+
+  // Advance counters once per elapsed tick, noting those reaching their target.
+  // A change can be taken after a later update, so its timestamp can be older
+  // than the last tick, in which case no time has passed.
+  int32_t elapsed = timestamp - debounce_state.last_tick;
+  uint32_t ticks = std::max<int32_t>(elapsed, 0) / DEBOUNCE_TICK_US;
+  debounce_state.last_tick += ticks * DEBOUNCE_TICK_US;
+  ticks = std::min<uint32_t>(ticks, (1 << DEBOUNCE_COUNTER_BITS) - 1);
+
+  uint16_t confirmed = 0;
+  for (uint tick = 0; tick <= ticks; ++tick) {
+    if (tick != 0) {
+      // Ripple carry increment of every changed button's counter, except
+      // those only now seen to change, as these ticks passed before they did
+      uint16_t carry = changed & debounce_state.pending & ~confirmed;
+      for (uint bit = 0; bit < DEBOUNCE_COUNTER_BITS; ++bit) {
+        uint16_t next_carry = counter[bit] & carry;
+        counter[bit] ^= carry;
+        carry = next_carry;
+      }
+    }
+
+    uint16_t equal = 0xFFFF;
+    for (uint bit = 0; bit < DEBOUNCE_COUNTER_BITS; ++bit) {
+      equal &= ~(counter[bit] ^ target[bit]);
+    }
+    confirmed |= equal & changed;
+  }
+
+  // Pass on accepted changes, and restart their counts
+  accepted |= confirmed;
+  debounce_state.output ^= accepted;
+  for (uint bit = 0; bit < DEBOUNCE_COUNTER_BITS; ++bit) {
+    counter[bit] &= ~accepted;
+  }
+  debounce_state.pending = changed & ~accepted;
+
+  return debounce_state.output;
+}
@@ -0,0 +1,85 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include <pico/types.h>
+
+#include <array>
+
+#include "configuration.hpp"
+#include "state.hpp"
+
+/** \file debounce.hpp
+ * \brief Per-button debouncing of physical button states
+ *
+ * Every button is filtered at once, with bitwise operations on the button
+ * word. Each button's counter is kept as a vertical counter, where bit plane
+ * `i` holds bit `i` of every button's count. A counter advances once per
+ * `DEBOUNCE_TICK_US` while its button's input differs from its output, and
+ * restarts whenever they match again, so a bounce back to the previous state
+ * restarts the wait.
+ */
+
+/// \brief Longest time a press or release can be deferred, in microseconds
+constexpr uint32_t DEBOUNCE_MAX_US =
+    ((1 << DEBOUNCE_COUNTER_BITS) - 2) * DEBOUNCE_TICK_US;
+
+/// \brief Button debounce parameters, compiled
+struct compiled_button_debounce {
+  /// \brief Buttons whose presses are passed on immediately
+  uint16_t eager_press;
+  /// \brief Buttons whose releases are passed on once confirmed
+  uint16_t defer_release;
+  /** \brief Bit planes of the number of ticks a deferred press must last,
+   * each all ones or all zeros
+   */
+  std::array<uint16_t, DEBOUNCE_COUNTER_BITS> press_ticks;
+  /** \brief Bit planes of the number of ticks a deferred release must last,
+   * each all ones or all zeros
+   */
+  std::array<uint16_t, DEBOUNCE_COUNTER_BITS> release_ticks;
+};
+
+/** \brief Compile the button debounce parameters of the current profile
+ *
+ * \note Only used from core 0, which also debounces the buttons.
+ *
+ * \param config Configuration to compile from
+ */
+void compile_button_debounce(controller_configuration &config);
+
+/** \brief Debounce physical button states
+ *
+ * Deferred changes are passed on once they have lasted at least the
+ * configured time, and at most one `DEBOUNCE_TICK_US` longer than it rounded
+ * up to whole ticks. Must be called often for this to hold, as changes are
+ * only seen, and counters only advance, when called.
+ *
+ * \param physical_buttons Physical button states
+ * \param timestamp Time the physical button states were read, in microseconds
+ * since boot. Times before the last call's are taken as no time passing.
+ * \param debounce_state Debounce state for the buttons
+ *
+ * \return Debounced button states
+ */
+uint16_t debounce_buttons(uint16_t physical_buttons, uint32_t timestamp,
+                          button_debounce_state &debounce_state);
+
+#endif  // DEBOUNCE_H_
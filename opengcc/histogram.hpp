@@ -0,0 +1,106 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include <pico/types.h>
+
+#include <algorithm>
+#include <array>
+
+/** \file histogram.hpp
+ * \brief Fixed-size histograms for instrumentation
+ */
+
+/** \brief Histogram of values split into equal width buckets
+ *
+ * Values past the last bucket are counted in the last bucket. Recording a
+ * value is a handful of cycles, so it is cheap enough for interrupt handlers.
+ *
+ * \tparam num_buckets Number of buckets
+ * \tparam bucket_width Range of values counted by each bucket, a power of two
+ * keeps recording free of division
+ */
+template <uint num_buckets, uint bucket_width>
+class histogram {
+ private:
+  std::array<uint32_t, num_buckets> buckets = {};
+  uint32_t count = 0;
+  uint32_t max = 0;
+  uint64_t sum = 0;
+
+ public:
+  /** \brief Record a value
+   *
+   * \param value Value to record
+   */
+  void record(uint32_t value);
+
+  /// \brief Clear all recorded values
+  void reset();
+
+  /** \brief Get the number of values recorded in a bucket
+   *
+   * \param bucket Index of bucket
+   *
+   * \return Number of values in the bucket
+   */
+  uint32_t bucket_count(uint bucket) const;
+
+  /** \brief Get the lowest value counted by a bucket
+   *
+   * \param bucket Index of bucket
+   *
+   * \return Lower bound of the bucket
+   */
+  uint32_t bucket_start(uint bucket) const;
+
+  /** \brief Get the number of values recorded
+   *
+   * \return Number of values
+   */
+  uint32_t total_count() const;
+
+  /** \brief Get the largest value recorded
+   *
+   * \return Largest value, 0 if none have been recorded
+   */
+  uint32_t max_value() const;
+
+  /** \brief Get the mean of the values recorded
+   *
+   * \return Mean value, 0 if none have been recorded
+   */
+  uint32_t mean_value() const;
+
+  /** \brief Get the smallest value at or below which a fraction of values fall
+   *
+   * \note Resolution is limited to the bucket width.
+   *
+   * \param percent Percentage of values, 0-100
+   *
+   * \return Upper bound of the bucket containing the percentile, or the
+   * largest value recorded if lower or in the last bucket
+   */
+  uint32_t percentile(uint percent) const;
+};
+
+#include "histogram.tpp"
+
+#endif  // HISTOGRAM_H_
@@ -0,0 +1,90 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+template <uint num_buckets, uint bucket_width>
+void histogram<num_buckets, bucket_width>::record(uint32_t value) {
+  uint32_t bucket = value / bucket_width;
+  if (bucket >= num_buckets) {
+    bucket = num_buckets - 1;
+  }
+  ++buckets[bucket];
+
+  ++count;
+  sum += value;
+  if (value > max) {
+    max = value;
+  }
+}
+
+template <uint num_buckets, uint bucket_width>
+void histogram<num_buckets, bucket_width>::reset() {
+  buckets = {};
+  count = 0;
+  max = 0;
+  sum = 0;
+}
+
+template <uint num_buckets, uint bucket_width>
+uint32_t histogram<num_buckets, bucket_width>::bucket_count(
+    uint bucket) const {
+  return buckets[bucket];
+}
+
+template <uint num_buckets, uint bucket_width>
+uint32_t histogram<num_buckets, bucket_width>::bucket_start(
+    uint bucket) const {
+  return bucket * bucket_width;
+}
+
+template <uint num_buckets, uint bucket_width>
+uint32_t histogram<num_buckets, bucket_width>::total_count() const {
+  return count;
+}
+
+template <uint num_buckets, uint bucket_width>
+uint32_t histogram<num_buckets, bucket_width>::max_value() const {
+  return max;
+}
+
+template <uint num_buckets, uint bucket_width>
+uint32_t histogram<num_buckets, bucket_width>::mean_value() const {
+  if (count == 0) {
+    return 0;
+  }
+
+  return sum / count;
+}
+
+template <uint num_buckets, uint bucket_width>
+uint32_t histogram<num_buckets, bucket_width>::percentile(
+    uint percent) const {
+  // Number of values that must be at or below the percentile
+  uint64_t target = (static_cast<uint64_t>(count) * percent + 99) / 100;
+
+  // The last bucket also counts every value past it, so only the largest
+  // value bounds it. No bucket's bound is above the largest value either.
+  uint64_t seen = 0;
+  for (uint bucket = 0; bucket < num_buckets - 1; ++bucket) {
+    seen += buckets[bucket];
+    if (seen >= target) {
+      return std::min(bucket_start(bucket) + bucket_width - 1, max);
+    }
+  }
+
+  return max;
+}
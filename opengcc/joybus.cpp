@@ -27,17 +27,82 @@ const uint stop_bit_offset = single_pin_joybus_offset_read_stop_bit;
 const pio_program program = joybus_program;
 const uint stop_bit_offset = joybus_offset_read_stop_bit;
 #endif
+#include <cinttypes>
+#include <cstdio>
+
 #include "hardware/dma.h"
 #include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
 #include "state.hpp"
 
 PIO joybus_pio;
 uint joybus_sm;
 uint joybus_offset;
 uint joybus_dma;
+uint joybus_rx_dma;
+uint joybus_alarm;
+
+joybus_response tx_buf = {};
+// Command byte followed by request bytes
+std::array<uint8_t, 3> request = {};
+volatile bool collecting_request = false;
+uint32_t command_received_at = 0;
+
+#if JOYBUS_STATISTICS
+joybus_statistics joybus_stats = {};
+#endif
 
-std::array<uint8_t, 10> tx_buf = {};
-std::array<uint8_t, 2> request = {};
+constexpr std::array<uint8_t, 3> IDENTIFY_RESPONSE = {0x09, 0x00, 0x03};
+
+constexpr std::array<uint8_t, NUM_POLL_MODES> RESPONSE_LENGTHS = {
+    8, 8, 8, 8, 8, 10, 10};
+
+// Published, transmitting, and free response buffers. Only the main loop
+// writes responses & publishes them, and only the interrupt handler on the
+// same core marks them as being transmitted.
+std::array<std::array<joybus_response, NUM_POLL_MODES>, 3> response_buffers =
+    {};
+volatile uint published_responses = 0;
+volatile uint sending_responses = 0;
+std::array<volatile uint32_t, 3> published_at = {};
+#if JOYBUS_STATISTICS
+std::array<uint32_t, 3> published_buttons_changed_at = {};
+uint32_t reported_buttons_changed_at = 0;
+#endif
+
+// Controller state the published responses were encoded from
+struct response_inputs {
+  uint16_t buttons;
+  sticks analog_sticks;
+  triggers analog_triggers;
+};
+response_inputs published_inputs = {};
+bool responses_published = false;
+
+// Number of responses sent from published state, so core 1 can tell when its
+// aggregated stick samples have been reported, and the main loop when latched
+// presses have been
+volatile uint32_t poll_epoch = 0;
+
+// Press latching, so presses released before a poll are still reported. Only
+// the buttons in the mask are latched, and presses stay latched until a
+// response reporting them is sent. Only the main loop latches & releases
+// presses, so they're never shared with the interrupt handler.
+volatile uint16_t press_latch_mask = 0;
+uint16_t latch_previous_buttons = 0;
+uint16_t latched_presses = 0;
+uint32_t latch_released_epoch = 0;
+std::array<uint16_t, 3> published_latched_presses = {};
+
+// Poll tracking, with period and jitter in 1/16ths of a microsecond
+seqlock<poll_timing> timing;
+uint32_t last_poll = 0;
+uint32_t poll_phase = 0;
+uint32_t period_sixteenths = 0;
+uint32_t jitter_sixteenths = 0;
+uint32_t data_age_sixteenths = 0;
+uint polls_in_lock = 0;
 
 uint jump_instruction;
 
@@ -59,199 +124,461 @@ void joybus_init(PIO pio, uint in_pin, uint out_pin) {
   dma_channel_set_config(joybus_dma, &tx_config, false);
   dma_channel_set_write_addr(joybus_dma, &joybus_pio->txf[joybus_sm], false);
 
-  // Joybus RX IRQ
-  irq_set_exclusive_handler(PIO0_IRQ_0, handle_console_request);
-  irq_set_enabled(PIO0_IRQ_0, true);
-  pio_set_irq0_source_enabled(
-      joybus_pio,
-      static_cast<pio_interrupt_source>(pis_sm0_rx_fifo_not_empty + joybus_sm),
-      true);
+  // Joybus RX DMA
+  joybus_rx_dma = dma_claim_unused_channel(true);
+  dma_channel_config rx_config = dma_channel_get_default_config(joybus_rx_dma);
+  channel_config_set_dreq(&rx_config,
+                          pio_get_dreq(joybus_pio, joybus_sm, false));
+  channel_config_set_read_increment(&rx_config, false);
+  channel_config_set_write_increment(&rx_config, true);
+  channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+  dma_channel_set_config(joybus_rx_dma, &rx_config, false);
+  dma_channel_set_read_addr(joybus_rx_dma, &joybus_pio->rxf[joybus_sm], false);
 
-  joybus_program_init(joybus_pio, joybus_sm, joybus_offset, in_pin, out_pin);
-}
+  // Joybus RX IRQ, raised when the DMA has collected a command or request
+  irq_set_exclusive_handler(DMA_IRQ_0, handle_console_request);
+  irq_set_enabled(DMA_IRQ_0, true);
+  dma_channel_set_irq0_enabled(joybus_rx_dma, true);
 
-void handle_console_request() {
-  // Disable IRQ to avoid interrupt reentrancy
-  irq_set_enabled(PIO0_IRQ_0, false);
+  // Joybus request timeout
+  joybus_alarm = hardware_alarm_claim_unused(true);
+  hardware_alarm_set_callback(joybus_alarm, handle_request_timeout);
+
+  // Encode responses before the console can poll
+  update_responses();
+
+  // Wait for first command
+  receive_data(request.data(), 1);
 
-  uint32_t cmd = pio_sm_get(joybus_pio, joybus_sm);
+  joybus_program_init(joybus_pio, joybus_sm, joybus_offset, in_pin, out_pin);
+}
 
-  // Determine request length based on command
-  uint request_len;
+uint request_length(uint8_t cmd) {
   switch (cmd) {
     case 0x40:
     case 0x42:
     case 0x43:
-      request_len = 2;
-      break;
+      return 2;
     default:
-      request_len = 0;
-      break;
+      return 0;
   }
+}
+
+void handle_console_request() {
+  dma_channel_acknowledge_irq0(joybus_rx_dma);
+
+  uint8_t cmd = request[0];
+
+  if (collecting_request) {
+    // Request bytes have arrived
+    hardware_alarm_cancel(joybus_alarm);
+    collecting_request = false;
+  } else {
+    command_received_at = time_us_32();
 
-  // Collect the rest of the console request
-  for (int i = 0; i < request_len; ++i) {
-    // Wait a max of 48us for a new item to be pushed into the RX FIFO,
-    // otherwise assume we caught the middle of a command & return
-    absolute_time_t timeout_at = make_timeout_time_us(48);
-    while (pio_sm_is_rx_fifo_empty(joybus_pio, joybus_sm)) {
-      if (absolute_time_diff_us(timeout_at, get_absolute_time()) > 0) {
-        // Clear ISR (mov isr, null)
-        pio_sm_exec(joybus_pio, joybus_sm, pio_encode_mov(pio_isr, pio_null));
-        // Re-enable IRQ now that FIFO is emptied
-        irq_set_enabled(PIO0_IRQ_0, true);
-        return;
+    uint request_len = request_length(cmd);
+    if (request_len > 0) {
+      // Have the DMA collect the rest of the console request, and only
+      // return here once it's all present. Allow a max of 48us per request
+      // byte, otherwise assume we caught the middle of a command.
+      collecting_request = true;
+      receive_data(request.data() + 1, request_len);
+      bool missed = hardware_alarm_set_target(
+          joybus_alarm, make_timeout_time_us(48 * request_len));
+
+      // If the timeout had already passed, time out now, unless the bytes
+      // arrived meanwhile & their interrupt is pending
+      if (missed && dma_channel_is_busy(joybus_rx_dma)) {
+        handle_request_timeout(joybus_alarm);
       }
+      return;
     }
-    request[i] = pio_sm_get(joybus_pio, joybus_sm);
   }
 
   // Make state machine process stop bit
   pio_sm_exec(joybus_pio, joybus_sm, jump_instruction);
 
-  // Re-enable IRQ now that FIFO is emptied
-  irq_set_enabled(PIO0_IRQ_0, true);
+  // Wait for next command
+  receive_data(request.data(), 1);
 
   // Set & send response
+  joybus_transmission response =
+      respond_to_command(cmd, request[1], time_us_32());
+  if (response.data != nullptr) {
+    send_data(response.data, response.length);
+  }
+}
+
+joybus_transmission respond_to_command(uint8_t cmd, uint8_t mode,
+                                       uint32_t timestamp) {
   switch (cmd) {
     case 0xFF:
     case 0x00:
       // Device identifier
-      tx_buf[0] = 0x09;
-      tx_buf[1] = 0x00;
-      tx_buf[2] = 0x03;
-      send_data(3);
-      return;
+      return {IDENTIFY_RESPONSE.data(), IDENTIFY_RESPONSE.size()};
     case 0x40:
-      if (request[0] > 0x04) {
-        request[0] = 0x00;
+      track_poll(timestamp);
+      if (mode > 0x04) {
+        mode = 0x00;
       }
       break;
     case 0x41:
       state.origin = false;
-      request[0] = 0x06;
+      mode = 0x06;
       break;
     case 0x42:
+      mode = 0x05;
+      break;
     case 0x43:
-      request[0] = 0x05;
+      track_poll(timestamp);
+      mode = 0x05;
       break;
     default:
       // Continue reading if command was unknown
-      return;
+#if JOYBUS_STATISTICS
+      ++joybus_stats.unknown_commands;
+#endif
+      return {nullptr, 0};
+  }
+
+  return mode_response(mode);
+}
+
+void handle_request_timeout(uint alarm_num) {
+  if (!collecting_request) {
+    // Request was collected before the timeout was cancelled
+    return;
+  }
+  collecting_request = false;
+
+#if JOYBUS_STATISTICS
+  ++joybus_stats.request_timeouts;
+#endif
+
+  // Stop collecting, without the abort raising a spurious IRQ
+  dma_channel_set_irq0_enabled(joybus_rx_dma, false);
+  dma_channel_abort(joybus_rx_dma);
+  dma_channel_acknowledge_irq0(joybus_rx_dma);
+  dma_channel_set_irq0_enabled(joybus_rx_dma, true);
+
+  // Clear ISR (mov isr, null) and any partial request
+  pio_sm_exec(joybus_pio, joybus_sm, pio_encode_mov(pio_isr, pio_null));
+  while (!pio_sm_is_rx_fifo_empty(joybus_pio, joybus_sm)) {
+    pio_sm_get(joybus_pio, joybus_sm);
   }
 
-  send_mode(request[0]);
+  // Wait for next command
+  receive_data(request.data(), 1);
+}
+
+void receive_data(uint8_t *data, uint32_t length) {
+  dma_channel_transfer_to_buffer_now(joybus_rx_dma, data, length);
+}
+
+void send_data(const uint8_t *data, uint32_t length) {
+  dma_channel_transfer_from_buffer_now(joybus_dma, data, length);
+
+#if JOYBUS_STATISTICS
+  joybus_stats.response_latency.record(time_us_32() - command_received_at);
+#endif
 }
 
-void send_data(uint32_t length) {
-  dma_channel_transfer_from_buffer_now(joybus_dma, tx_buf.data(), length);
+void clear_read_origin(joybus_response &response) {
+  // Responses encoded before the console read the origin still have the
+  // origin bit set. Neither the main loop's next encode nor state.buttons may
+  // have caught up yet, so the bit is cleared as the response is sent.
+  if (!state.origin) {
+    response[0] &= ~(1 << (ORIGIN - 8));
+  }
 }
 
-void send_mode(uint8_t mode) {
-  // Copy state that could be updated from other core
-  sticks sticks_copy = state.analog_sticks;
-  triggers triggers_copy = state.analog_triggers;
+joybus_transmission mode_response(uint8_t mode) {
+#if JOYBUS_STATISTICS
+  ++joybus_stats.polls_per_mode[mode];
+#endif
 
   if (mode != 0x06 && !state.center_set) {
+    // Copy state that could be updated from other core
+    triggers triggers_copy = state.analog_triggers.load();
+
     // Set centers
     state.l_trigger_center = triggers_copy.l_trigger;
     state.r_trigger_center = triggers_copy.r_trigger;
     state.center_set = true;
 
     // Ensure this poll is responded to with origin values
-    sticks_copy.l_stick.x = 0x7F;
-    sticks_copy.l_stick.y = 0x7F;
-    sticks_copy.r_stick.x = 0x7F;
-    sticks_copy.r_stick.y = 0x7F;
-    triggers_copy.l_trigger = 0x00;
-    triggers_copy.r_trigger = 0x00;
+    sticks origin_sticks = {{0x7F, 0x7F}, {0x7F, 0x7F}};
+    triggers origin_triggers = {0x00, 0x00};
+    uint8_t length =
+        encode_mode(mode, state.buttons, origin_sticks, origin_triggers, tx_buf);
+    clear_read_origin(tx_buf);
+    return {tx_buf.data(), length};
   }
 
-  // Fill tx_buf based on mode and initiate send
+  // Mark the published responses as in use so they aren't overwritten while
+  // being transmitted
+  uint responses = published_responses;
+  sending_responses = responses;
+  clear_read_origin(response_buffers[responses][mode]);
+
+  // Track how stale the response is
+  int32_t age_sixteenths = (time_us_32() - published_at[responses]) << 4;
+  data_age_sixteenths +=
+      (age_sixteenths - static_cast<int32_t>(data_age_sixteenths)) >> 3;
+
+  // Stick samples aggregated from now on are for the next poll, and presses
+  // reported by this response can be released
+  poll_epoch = poll_epoch + 1;
+
+#if JOYBUS_STATISTICS
+  // Track how long the first response with a button change took to send
+  uint32_t buttons_changed_at = published_buttons_changed_at[responses];
+  if (buttons_changed_at != reported_buttons_changed_at) {
+    reported_buttons_changed_at = buttons_changed_at;
+    joybus_stats.button_latency.record(time_us_32() - buttons_changed_at);
+  }
+#endif
+
+  return {response_buffers[responses][mode].data(), RESPONSE_LENGTHS[mode]};
+}
+
+void track_poll(uint32_t timestamp) {
+  uint32_t since_last_poll = timestamp - last_poll;
+  last_poll = timestamp;
+
+  int32_t error = timestamp - (poll_phase + (period_sixteenths >> 4));
+  uint32_t distance = error < 0 ? -error : error;
+
+  if (distance > (period_sixteenths >> 6)) {
+    // Too far from prediction to be jitter, restart from observed period
+    period_sixteenths = since_last_poll << 4;
+    jitter_sixteenths = 0;
+    poll_phase = timestamp;
+    polls_in_lock = 0;
+  } else {
+    // Move phase halfway to the observed poll, and nudge period by 1/16 of
+    // the error
+    poll_phase = timestamp - (error / 2);
+    period_sixteenths += error;
+    jitter_sixteenths +=
+        (static_cast<int32_t>(distance << 4) -
+         static_cast<int32_t>(jitter_sixteenths)) >>
+        3;
+    if (polls_in_lock < POLL_LOCK_COUNT) {
+      ++polls_in_lock;
+    }
+  }
+
+  timing.store({poll_phase + (period_sixteenths >> 4), period_sixteenths >> 4,
+                jitter_sixteenths >> 4, data_age_sixteenths >> 4,
+                polls_in_lock >= POLL_LOCK_COUNT});
+}
+
+poll_timing get_poll_timing() { return timing.load(); }
+
+uint32_t get_poll_epoch() { return poll_epoch; }
+
+uint8_t encode_mode(uint8_t mode, uint16_t buttons, sticks analog_sticks,
+                    triggers analog_triggers, joybus_response &out) {
+  // Triggers are only reduced to the console's resolution here
+  uint8_t l_trigger = quantize_trigger(analog_triggers.l_trigger);
+  uint8_t r_trigger = quantize_trigger(analog_triggers.r_trigger);
+
+  // Fill buffer based on mode
   switch (mode) {
     case 0x00:
-      tx_buf[0] = state.buttons >> 8;
-      tx_buf[1] = state.buttons & 0x00FF;
-      tx_buf[2] = sticks_copy.l_stick.x;
-      tx_buf[3] = sticks_copy.l_stick.y;
-      tx_buf[4] = sticks_copy.r_stick.x;
-      tx_buf[5] = sticks_copy.r_stick.y;
-      tx_buf[6] =
-          (triggers_copy.l_trigger & 0xF0) | (triggers_copy.r_trigger >> 4);
-      tx_buf[7] = 0x00;
-      send_data(8);
+      out[0] = buttons >> 8;
+      out[1] = buttons & 0x00FF;
+      out[2] = analog_sticks.l_stick.x;
+      out[3] = analog_sticks.l_stick.y;
+      out[4] = analog_sticks.r_stick.x;
+      out[5] = analog_sticks.r_stick.y;
+      out[6] = (l_trigger & 0xF0) | (r_trigger >> 4);
+      out[7] = 0x00;
       break;
     case 0x01:
-      tx_buf[0] = state.buttons >> 8;
-      tx_buf[1] = state.buttons & 0x00FF;
-      tx_buf[2] = sticks_copy.l_stick.x;
-      tx_buf[3] = sticks_copy.l_stick.y;
-      tx_buf[4] = (sticks_copy.r_stick.x & 0xF0) | (sticks_copy.r_stick.y >> 4);
-      tx_buf[5] = triggers_copy.l_trigger;
-      tx_buf[6] = triggers_copy.r_trigger;
-      tx_buf[7] = 0x00;
-      send_data(8);
+      out[0] = buttons >> 8;
+      out[1] = buttons & 0x00FF;
+      out[2] = analog_sticks.l_stick.x;
+      out[3] = analog_sticks.l_stick.y;
+      out[4] =
+          (analog_sticks.r_stick.x & 0xF0) | (analog_sticks.r_stick.y >> 4);
+      out[5] = l_trigger;
+      out[6] = r_trigger;
+      out[7] = 0x00;
       break;
     case 0x02:
-      tx_buf[0] = state.buttons >> 8;
-      tx_buf[1] = state.buttons & 0x00FF;
-      tx_buf[2] = sticks_copy.l_stick.x;
-      tx_buf[3] = sticks_copy.l_stick.y;
-      tx_buf[4] = (sticks_copy.r_stick.x & 0xF0) | (sticks_copy.r_stick.y >> 4);
-      tx_buf[5] =
-          (triggers_copy.l_trigger & 0xF0) | (triggers_copy.r_trigger >> 4);
-      tx_buf[6] = 0x00;
-      tx_buf[7] = 0x00;
-      send_data(8);
+      out[0] = buttons >> 8;
+      out[1] = buttons & 0x00FF;
+      out[2] = analog_sticks.l_stick.x;
+      out[3] = analog_sticks.l_stick.y;
+      out[4] =
+          (analog_sticks.r_stick.x & 0xF0) | (analog_sticks.r_stick.y >> 4);
+      out[5] = (l_trigger & 0xF0) | (r_trigger >> 4);
+      out[6] = 0x00;
+      out[7] = 0x00;
       break;
     case 0x03:
-      tx_buf[0] = state.buttons >> 8;
-      tx_buf[1] = state.buttons & 0x00FF;
-      tx_buf[2] = sticks_copy.l_stick.x;
-      tx_buf[3] = sticks_copy.l_stick.y;
-      tx_buf[4] = sticks_copy.r_stick.x;
-      tx_buf[5] = sticks_copy.r_stick.y;
-      tx_buf[6] = triggers_copy.l_trigger;
-      tx_buf[7] = triggers_copy.r_trigger;
-      send_data(8);
+      out[0] = buttons >> 8;
+      out[1] = buttons & 0x00FF;
+      out[2] = analog_sticks.l_stick.x;
+      out[3] = analog_sticks.l_stick.y;
+      out[4] = analog_sticks.r_stick.x;
+      out[5] = analog_sticks.r_stick.y;
+      out[6] = l_trigger;
+      out[7] = r_trigger;
       break;
     case 0x04:
-      tx_buf[0] = state.buttons >> 8;
-      tx_buf[1] = state.buttons & 0x00FF;
-      tx_buf[2] = sticks_copy.l_stick.x;
-      tx_buf[3] = sticks_copy.l_stick.y;
-      tx_buf[4] = sticks_copy.r_stick.x;
-      tx_buf[5] = sticks_copy.r_stick.y;
-      tx_buf[6] = 0x00;
-      tx_buf[7] = 0x00;
-      send_data(8);
+      out[0] = buttons >> 8;
+      out[1] = buttons & 0x00FF;
+      out[2] = analog_sticks.l_stick.x;
+      out[3] = analog_sticks.l_stick.y;
+      out[4] = analog_sticks.r_stick.x;
+      out[5] = analog_sticks.r_stick.y;
+      out[6] = 0x00;
+      out[7] = 0x00;
       break;
     case 0x05:
-      tx_buf[0] = state.buttons >> 8;
-      tx_buf[1] = state.buttons & 0x00FF;
-      tx_buf[2] = sticks_copy.l_stick.x;
-      tx_buf[3] = sticks_copy.l_stick.y;
-      tx_buf[4] = sticks_copy.r_stick.x;
-      tx_buf[5] = sticks_copy.r_stick.y;
-      tx_buf[6] = triggers_copy.l_trigger;
-      tx_buf[7] = triggers_copy.r_trigger;
-      tx_buf[8] = 0x00;
-      tx_buf[9] = 0x00;
-      send_data(10);
+      out[0] = buttons >> 8;
+      out[1] = buttons & 0x00FF;
+      out[2] = analog_sticks.l_stick.x;
+      out[3] = analog_sticks.l_stick.y;
+      out[4] = analog_sticks.r_stick.x;
+      out[5] = analog_sticks.r_stick.y;
+      out[6] = l_trigger;
+      out[7] = r_trigger;
+      out[8] = 0x00;
+      out[9] = 0x00;
       break;
     case 0x06:
       // Origin state
-      tx_buf[0] = 0x00;
-      tx_buf[1] = 0x80;
-      tx_buf[2] = 0x7F;
-      tx_buf[3] = 0x7F;
-      tx_buf[4] = 0x7F;
-      tx_buf[5] = 0x7F;
-      tx_buf[6] = 0x00;
-      tx_buf[7] = 0x00;
-      tx_buf[8] = 0x00;
-      tx_buf[9] = 0x00;
-      send_data(10);
+      out[0] = 0x00;
+      out[1] = 0x80;
+      out[2] = 0x7F;
+      out[3] = 0x7F;
+      out[4] = 0x7F;
+      out[5] = 0x7F;
+      out[6] = 0x00;
+      out[7] = 0x00;
+      out[8] = 0x00;
+      out[9] = 0x00;
       break;
   }
+
+  return RESPONSE_LENGTHS[mode];
 }
+
+bool same_inputs(const response_inputs &a, const response_inputs &b) {
+  return a.buttons == b.buttons &&
+         a.analog_sticks.l_stick.x == b.analog_sticks.l_stick.x &&
+         a.analog_sticks.l_stick.y == b.analog_sticks.l_stick.y &&
+         a.analog_sticks.r_stick.x == b.analog_sticks.r_stick.x &&
+         a.analog_sticks.r_stick.y == b.analog_sticks.r_stick.y &&
+         a.analog_triggers.l_trigger == b.analog_triggers.l_trigger &&
+         a.analog_triggers.r_trigger == b.analog_triggers.r_trigger;
+}
+
+void update_responses() {
+  // Snapshot state that could be updated from other core, reporting latched
+  // presses as pressed
+  response_inputs inputs;
+  uint16_t buttons = state.buttons;
+  uint16_t presses = latch_presses(buttons);
+  inputs.buttons = buttons | presses;
+  inputs.analog_sticks = state.analog_sticks.load();
+  inputs.analog_triggers = state.analog_triggers.load();
+
+  // Nothing to encode if the published responses are already of this state,
+  // they're just confirmed as current
+  uint32_t now = time_us_32();
+  if (responses_published && same_inputs(inputs, published_inputs)) {
+    published_at[published_responses] = now;
+    return;
+  }
+
+  // Write to the buffer that is neither published nor being transmitted. The
+  // interrupt handler can only mark the published buffer as being
+  // transmitted, so the chosen buffer stays free while it's written.
+  uint responses = 0;
+  while (responses == published_responses || responses == sending_responses) {
+    ++responses;
+  }
+
+  for (uint8_t mode = 0; mode < NUM_POLL_MODES; ++mode) {
+    encode_mode(mode, inputs.buttons, inputs.analog_sticks,
+                inputs.analog_triggers, response_buffers[responses][mode]);
+  }
+
+  published_at[responses] = now;
+  published_latched_presses[responses] = presses;
+#if JOYBUS_STATISTICS
+  published_buttons_changed_at[responses] = state.buttons_changed_at;
+#endif
+  published_inputs = inputs;
+  responses_published = true;
+
+  // Ensure responses are written before they're published, with one store the
+  // interrupt handler sees either side of
+  __dmb();
+  published_responses = responses;
+}
+
+void set_press_latching(bool enabled) {
+  press_latch_mask = enabled ? PRESS_LATCH_BUTTONS : 0;
+}
+
+uint16_t latch_presses(uint16_t buttons) {
+  // Release presses reported since the last call. Each published buffer
+  // holds every press still latched when it was encoded, so the buffer last
+  // marked as being transmitted holds every press reported since then. The
+  // epoch is read first, as the interrupt handler marks the buffer before
+  // advancing the epoch.
+  uint32_t epoch = poll_epoch;
+  if (epoch != latch_released_epoch) {
+    latch_released_epoch = epoch;
+    latched_presses &= ~published_latched_presses[sending_responses];
+  }
+
+  uint16_t presses = buttons & ~latch_previous_buttons & press_latch_mask;
+  latch_previous_buttons = buttons;
+  latched_presses |= presses;
+
+  return latched_presses;
+}
+
+#if JOYBUS_STATISTICS
+void print_joybus_statistics() {
+  // Copy so the interrupt can't update statistics mid-print
+  joybus_statistics stats = joybus_stats;
+  poll_timing poll = get_poll_timing();
+
+  printf("Responses: %" PRIu32 "\n", stats.response_latency.total_count());
+  printf("Response latency (us): mean %" PRIu32 ", p99 %" PRIu32
+         ", max %" PRIu32 "\n",
+         stats.response_latency.mean_value(),
+         stats.response_latency.percentile(99),
+         stats.response_latency.max_value());
+  for (uint bucket = 0; bucket < LATENCY_HISTOGRAM_BUCKETS; ++bucket) {
+    uint32_t count = stats.response_latency.bucket_count(bucket);
+    if (count != 0) {
+      printf("  %3" PRIu32 " us: %" PRIu32 "\n",
+             stats.response_latency.bucket_start(bucket), count);
+    }
+  }
+  printf("Button changes reported: %" PRIu32 "\n",
+         stats.button_latency.total_count());
+  printf("Button latency (us): mean %" PRIu32 ", p99 %" PRIu32
+         ", max %" PRIu32 "\n",
+         stats.button_latency.mean_value(),
+         stats.button_latency.percentile(99),
+         stats.button_latency.max_value());
+  printf("Poll period (us): %" PRIu32 ", jitter %" PRIu32 ", %s\n",
+         poll.period, poll.jitter, poll.locked ? "locked" : "unlocked");
+  printf("Data age (us): %" PRIu32 "\n", poll.data_age);
+  printf("Request timeouts: %" PRIu32 "\n", stats.request_timeouts);
+  printf("Unknown commands: %" PRIu32 "\n", stats.unknown_commands);
+  for (uint mode = 0; mode < NUM_POLL_MODES; ++mode) {
+    printf("Mode %u polls: %" PRIu32 "\n", mode, stats.polls_per_mode[mode]);
+  }
+}
+#endif
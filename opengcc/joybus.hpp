@@ -22,6 +22,8 @@
 #include <array>
 
 #include "hardware/pio.h"
+#include "histogram.hpp"
+#include "state.hpp"
 
 /** \file joybus.hpp
  * \brief Joybus protocol implementation
@@ -259,19 +261,121 @@
  * transfer of the appropriate length from the transaction buffer, and the DMA
  * moves the data as needed into the FIFO.
  * 
+ * <h2>Pre-encoded Responses</h2>
+ * Rather than packing the controller state when a poll arrives, the main loop
+ * encodes the state for every poll mode whenever it changes, including analog
+ * state updated by the other core. Responses are kept in three buffers – the
+ * published one, the one being transmitted, and one that is free to be
+ * written – so the interrupt handler only has to pick the published buffer
+ * and start the DMA, and a buffer is never overwritten while it is being
+ * transmitted. As the encoding and the interrupt handler are on the same
+ * core, and each buffer index is only written by one of them, publishing
+ * never takes a lock or disables interrupts.
+ * 
+ * The DMA also collects console requests from the RX FIFO, so the main
+ * processor never waits on the data line for request bytes.
+ * 
  * <h2>Interrupt Handler</h2>
- * The main processor's execution is interrupted when the first byte is pushed
- * into the RX state machine's RX FIFO. Based on the command's request length,
- * the processor either waits for the request bytes to be pushed into the FIFO
- * or proceeds immediately. From the time the last byte is received, the
- * processor has the remaining 3µs of the last bit and the 3µs of the stop bit to
- * process the command and get the state machine ready to transmit.
+ * The main processor's execution is interrupted when the DMA has moved the
+ * command byte out of the RX state machine's RX FIFO. Based on the command's
+ * request length, the processor either has the DMA collect the request bytes
+ * and returns, to be interrupted again once they are all present, or proceeds
+ * immediately. A timer alarm abandons the request if the request bytes never
+ * arrive. From the time the last byte is received, the processor has the
+ * remaining 3µs of the last bit and the 3µs of the stop bit to process the
+ * command and get the state machine ready to transmit.
  * 
  * \note The 3+3µs is not entirely accurate – while USB adapters have fairly
  * precise timing, console transmission timings can be significantly different.
  * </details>
  */
 
+/// \brief Number of poll modes, including the origin mode
+constexpr uint NUM_POLL_MODES = 7;
+
+/// \brief Maximum length of a response to a poll
+constexpr uint MAX_RESPONSE_LENGTH = 10;
+
+/// \brief Buffer holding a response to the console
+using joybus_response = std::array<uint8_t, MAX_RESPONSE_LENGTH>;
+
+/// \brief Data to transmit in response to a console command
+struct joybus_transmission {
+  /// \brief Buffer to send from, `nullptr` if there is no response
+  const uint8_t *data;
+  /// \brief Number of bytes to send
+  uint32_t length;
+};
+
+/// \brief Buttons whose presses can be latched, excluding status bits
+constexpr uint16_t PRESS_LATCH_BUTTONS =
+    0xFFFF & ~((1 << ALWAYS_HIGH) | (1 << ORIGIN));
+
+/** \brief Number of consecutive polls close to their prediction before the
+ * poll timing is considered locked
+ */
+constexpr uint POLL_LOCK_COUNT = 8;
+
+/// \brief Timing of console polls, tracked from the arrival of each poll
+struct poll_timing {
+  /// \brief Predicted arrival of the next poll, in microseconds since boot
+  uint32_t next_poll;
+  /// \brief Estimated time between polls in microseconds
+  uint32_t period;
+  /// \brief Average deviation of polls from their prediction in microseconds
+  uint32_t jitter;
+  /** \brief Average time between a response's controller state last being
+   * checked as current and the response being sent in microseconds
+   */
+  uint32_t data_age;
+  /// \brief `true` if polls are arriving at a steady rate, `false` otherwise
+  bool locked;
+};
+
+#if JOYBUS_STATISTICS
+/// \brief Number of buckets in the response latency histogram
+constexpr uint LATENCY_HISTOGRAM_BUCKETS = 64;
+
+/// \brief Width of each response latency histogram bucket in microseconds
+constexpr uint LATENCY_HISTOGRAM_BUCKET_US = 2;
+
+/// \brief Number of buckets in the button latency histogram
+constexpr uint BUTTON_LATENCY_HISTOGRAM_BUCKETS = 64;
+
+/// \brief Width of each button latency histogram bucket in microseconds
+constexpr uint BUTTON_LATENCY_HISTOGRAM_BUCKET_US = 256;
+
+/** \brief Joybus latency and error statistics
+ *
+ * \note Only kept if built with `OPENGCC_JOYBUS_STATISTICS` enabled.
+ */
+struct joybus_statistics {
+  /** \brief Time from a command byte being received to its response starting
+   * to be sent in microseconds
+   */
+  histogram<LATENCY_HISTOGRAM_BUCKETS, LATENCY_HISTOGRAM_BUCKET_US>
+      response_latency;
+  /** \brief Time from a physical button change to the first response
+   * reporting it starting to be sent in microseconds
+   */
+  histogram<BUTTON_LATENCY_HISTOGRAM_BUCKETS,
+            BUTTON_LATENCY_HISTOGRAM_BUCKET_US>
+      button_latency;
+  /// \brief Number of requests abandoned waiting for request bytes
+  uint32_t request_timeouts;
+  /// \brief Number of unrecognized commands
+  uint32_t unknown_commands;
+  /// \brief Number of responses sent in each poll mode
+  std::array<uint32_t, NUM_POLL_MODES> polls_per_mode;
+};
+
+/// \brief Joybus statistics, updated by the console request interrupt
+extern joybus_statistics joybus_stats;
+
+/// \brief Print Joybus statistics to stdio
+void print_joybus_statistics();
+#endif
+
 /** \brief Initialize Joybus functionality
  *
  * \param pio The PIO instance to use for Joybus
@@ -282,27 +386,160 @@ void joybus_init(PIO pio, uint in_pin, uint out_pin);
 
 /** \brief Interrupt handler that reads commands and starts response
  * transmission
+ *
+ * Raised each time the RX DMA completes, first for the command byte and then,
+ * if the command has any, for the request bytes.
  */
 void handle_console_request();
 
-/** \brief Triggers a transmission of the specified length from the transmission
+/** \brief Alarm handler that abandons a request whose request bytes did not
+ * arrive in time
+ *
+ * \param alarm_num The hardware alarm that fired
+ */
+void handle_request_timeout(uint alarm_num);
+
+/** \brief Get the number of request bytes that follow a command
+ *
+ * \param cmd Command byte
+ *
+ * \return Number of request bytes
+ */
+uint request_length(uint8_t cmd);
+
+/** \brief Triggers collection of the specified length from the console into a
  * buffer
+ *
+ * \note Collection is handled asynchronously by the DMA, which raises the
+ * console request interrupt when complete.
+ *
+ * \param data Buffer to receive into
+ * \param length Number of bytes to receive
+ */
+void receive_data(uint8_t *data, uint32_t length);
+
+/** \brief Triggers a transmission of the specified length from a buffer
  *
  * \note Transmissions are handled asynchronously. This function simply
- * configures the DMA to transfer the specified length from the transmission
- * buffer to the Joybus TX state machine, so other controller processes can
- * continue to run in the background as data is fed to the state machine.
+ * configures the DMA to transfer the specified length from the buffer to the
+ * Joybus TX state machine, so other controller processes can continue to run
+ * in the background as data is fed to the state machine. The buffer must not
+ * be modified until the transmission is complete.
  *
+ * \param data Buffer to send from
  * \param length Number of bytes from data to send
  */
-void send_data(uint32_t length);
+void send_data(const uint8_t *data, uint32_t length);
+
+/** \brief Determine the response to a complete console command
+ *
+ * Implements the protocol independently of the PIO and DMA, so it has no
+ * side effects on the hardware – the caller is responsible for transmitting
+ * the response.
+ *
+ * \param cmd Command byte
+ * \param mode First request byte, ignored for commands without one
+ * \param timestamp Time the command was received, in microseconds since boot
+ *
+ * \return Data to transmit, with `data` set to `nullptr` if the command should
+ * not be responded to
+ */
+joybus_transmission respond_to_command(uint8_t cmd, uint8_t mode,
+                                       uint32_t timestamp);
 
-/** \brief Sends controller state with appropriate data based on a specific poll
- * mode
+/** \brief Clear the origin bit of a response about to be sent, if the
+ * console has read the origin since it was encoded
+ *
+ * \param response Response to send
+ */
+void clear_read_origin(joybus_response &response);
+
+/** \brief Get the controller state response for a specific poll mode
  *
  * \param mode The poll mode which determines how controller state is mapped
  * for transmission
+ *
+ * \return Data to transmit
+ */
+joybus_transmission mode_response(uint8_t mode);
+
+/** \brief Update poll timing with the arrival of a poll
+ *
+ * Tracks the poll period and phase like a PLL – each poll's deviation from
+ * its prediction moves the phase halfway to the observed poll and nudges the
+ * period. If a poll is far from its prediction, such as when a game changes
+ * poll rate, tracking restarts from the observed period.
+ *
+ * \param timestamp Time the poll arrived, in microseconds since boot
+ */
+void track_poll(uint32_t timestamp);
+
+/** \brief Get the current poll timing
+ *
+ * \note Safe to call from either core.
+ *
+ * \return Poll timing
+ */
+poll_timing get_poll_timing();
+
+/** \brief Get the current poll epoch, which advances each time a response is
+ * sent from published state
+ *
+ * \note Safe to call from either core.
+ *
+ * \return Poll epoch
+ */
+uint32_t get_poll_epoch();
+
+/** \brief Encode controller state for a specific poll mode
+ *
+ * \param mode The poll mode which determines how controller state is mapped
+ * for transmission
+ * \param buttons State of digital inputs
+ * \param analog_sticks State of sticks
+ * \param analog_triggers State of triggers
+ * \param out Buffer to write the response to
+ *
+ * \return Number of bytes in the response
+ */
+uint8_t encode_mode(uint8_t mode, uint16_t buttons, sticks analog_sticks,
+                    triggers analog_triggers, joybus_response &out);
+
+/** \brief Encode the current controller state for every poll mode and publish
+ * it for the interrupt handler to send
+ *
+ * Presses latched since the last response was sent are encoded as pressed,
+ * even if since released. Responses are only encoded again if the state has
+ * changed since they were last published.
+ *
+ * \note Must only be called from core 0, which handles console requests, so
+ * buffers are only chosen & published by one writer. Must be called whenever
+ * controller state sent to the console is updated, including analog state
+ * updated by core 1.
+ */
+void update_responses();
+
+/** \brief Enable or disable press latching
+ *
+ * While enabled, a button pressed since the last response was sent is
+ * reported as pressed in the next response, so taps shorter than the poll
+ * period still reach the console.
+ *
+ * \param enabled Whether presses are latched
+ */
+void set_press_latching(bool enabled);
+
+/** \brief Latch new presses of buttons, and release latched presses reported
+ * by responses sent since the last call
+ *
+ * \note Must only be called by `update_responses()`, as it tracks presses
+ * against the buttons it was last called with, and releases presses against
+ * the responses it published.
+ *
+ * \param buttons State of digital inputs
+ *
+ * \return Presses latched and not yet reported, including new presses
  */
-void send_mode(uint8_t mode);
+uint16_t latch_presses(uint16_t buttons);
 
 #endif  // JOYBUS_H_
@@ -22,23 +22,41 @@
 #include <cmath>
 
 #include "analog_controller.hpp"
+#include "button_remap.hpp"
 #include "calibration.hpp"
 #include "configuration.hpp"
+#include "curve_fitting.hpp"
+#include "debounce.hpp"
 #include "hardware/clocks.h"
+#include "hardware/interp.h"
 #include "joybus.hpp"
 #include "pico/multicore.h"
+#include "pico/stdlib.h"
+#include "snapback.hpp"
 #include "state.hpp"
+#include "stick_aggregation.hpp"
+#include "stick_filter.hpp"
+#include "stick_pipeline.hpp"
+#include "trigger_transfer.hpp"
 
 controller_state state;
 
+// The benchmark & host tests provide their own entry points
+#if !defined(OPENGCC_BENCHMARK) && !defined(OPENGCC_HOST_TESTS)
 int main() {
   // Configure system PLL to 128 MHZ
   set_sys_clock_pll(1536 * MHZ, 6, 2);
 
+#if JOYBUS_STATISTICS_STDIO
+  // Statistics are printed over USB serial
+  stdio_init_all();
+#endif
+
   // Setup buttons, sticks, and triggers to be read
   init_buttons();
   init_sticks();
   init_triggers();
+  init_stick_interpolators();
 
   // Load configuration
   controller_configuration &config = controller_configuration::get_instance();
@@ -54,14 +72,12 @@ int main() {
       break;
   }
 
-  state.l_stick_coefficients =
-      stick_calibration(config.l_stick_range,
-                        config.l_stick_calibration_measurement)
-          .generate_coefficients();
-  state.r_stick_coefficients =
-      stick_calibration(config.r_stick_range,
-                        config.r_stick_calibration_measurement)
-          .generate_coefficients();
+  stick_calibration(config.l_stick_range,
+                    config.l_stick_calibration_measurement)
+      .generate_coefficients(state.l_stick_coefficients);
+  stick_calibration(config.r_stick_range,
+                    config.r_stick_calibration_measurement)
+      .generate_coefficients(state.r_stick_coefficients);
 
   // Read buttons, sticks, and triggers once before starting communication
   read_digital(startup_buttons);
@@ -74,22 +90,47 @@ int main() {
   // Launch analog on core 1
   multicore_launch_core1(analog_main);
 
+  uint16_t physical_buttons = startup_buttons;
   while (true) {
-    uint16_t physical_buttons = get_buttons();
-    read_digital(physical_buttons);
+    // Take changes one at a time, so each is reported to the console in order
+    button_change change;
+    bool changed = get_button_change(change);
+    if (changed) {
+      physical_buttons = change.buttons;
+    }
+
+    // Combos act on physical buttons, so only remapped buttons are debounced.
+    // Changes are timed from when they were seen, not when they were taken.
+    uint32_t timestamp = changed ? change.timestamp : time_us_32();
+    read_digital(
+        debounce_buttons(physical_buttons, timestamp, state.button_debounce));
+    if (changed) {
+      state.buttons_changed_at = change.timestamp;
+    }
+    // Publish changes to buttons, and to analog state from core 1
+    update_responses();
     check_combos(physical_buttons);
   }
 
   return 0;
 }
+#endif
 
 void read_digital(uint16_t physical_buttons) {
-  controller_configuration &config = controller_configuration::get_instance();
+  // Apply remaps & digital trigger modes
+  uint32_t remapped_buttons =
+      apply_button_remap(current_button_remap(), physical_buttons,
+                         (1 << ALWAYS_HIGH) | (state.origin << ORIGIN));
 
-  // Output sent to console
-  uint16_t remapped_buttons = (1 << ALWAYS_HIGH) | (state.origin << ORIGIN);
+  state.lt_pressed = (remapped_buttons & (1 << REMAP_LT_PRESSED)) != 0;
+  state.rt_pressed = (remapped_buttons & (1 << REMAP_RT_PRESSED)) != 0;
 
-  // Apply remaps
+  // Update state
+  state.buttons = remapped_buttons;
+}
+
+uint16_t remap_buttons(controller_configuration &config,
+                       uint16_t physical_buttons, uint16_t remapped_buttons) {
   remap(remapped_buttons, physical_buttons, START, config.mapping(12));
   remap(remapped_buttons, physical_buttons, Y, config.mapping(11));
   remap(remapped_buttons, physical_buttons, X, config.mapping(10));
@@ -103,17 +144,7 @@ void read_digital(uint16_t physical_buttons) {
   remap(remapped_buttons, physical_buttons, DPAD_RIGHT, config.mapping(1));
   remap(remapped_buttons, physical_buttons, DPAD_LEFT, config.mapping(0));
 
-  state.lt_pressed = (remapped_buttons & (1 << LT_DIGITAL)) != 0;
-  state.rt_pressed = (remapped_buttons & (1 << RT_DIGITAL)) != 0;
-
-  // Apply digital trigger modes
-  apply_trigger_mode_digital(remapped_buttons, LT_DIGITAL,
-                             config.l_trigger_mode());
-  apply_trigger_mode_digital(remapped_buttons, RT_DIGITAL,
-                             config.r_trigger_mode());
-
-  // Update state
-  state.buttons = remapped_buttons;
+  return remapped_buttons;
 }
 
 void remap(uint16_t &remapped_buttons, uint16_t physical_buttons,
@@ -160,9 +191,18 @@ void check_combos(uint32_t physical_buttons) {
     switch (physical_buttons) {
       case (1 << START) | (1 << X) | (1 << A):
       case (1 << START) | (1 << X) | (1 << Z):
+      case (1 << START) | (1 << X) | (1 << B):
       case (1 << START) | (1 << X) | (1 << LT_DIGITAL):
       case (1 << START) | (1 << X) | (1 << RT_DIGITAL):
       case (1 << START) | (1 << Y) | (1 << Z):
+      case (1 << START) | (1 << Y) | (1 << DPAD_UP):
+      case (1 << START) | (1 << Y) | (1 << DPAD_LEFT):
+      case (1 << START) | (1 << Y) | (1 << DPAD_RIGHT):
+      case (1 << START) | (1 << Y) | (1 << LT_DIGITAL):
+      case (1 << START) | (1 << Y) | (1 << RT_DIGITAL):
+#if JOYBUS_STATISTICS_STDIO
+      case (1 << START) | (1 << X) | (1 << Y):
+#endif
         state.active_combo = physical_buttons;
         state.combo_trigger_timestamp = make_timeout_time_ms(3000);
         break;
@@ -170,6 +210,18 @@ void check_combos(uint32_t physical_buttons) {
   }
 }
 
+void display_on_left_stick(stick display_stick) {
+  sticks display_sticks = state.analog_sticks.load();
+  display_sticks.l_stick = display_stick;
+  state.analog_sticks.store(display_sticks);
+}
+
+void display_on_right_stick(stick display_stick) {
+  sticks display_sticks = state.analog_sticks.load();
+  display_sticks.r_stick = display_stick;
+  state.analog_sticks.store(display_sticks);
+}
+
 void execute_combo() {
   controller_configuration &config = controller_configuration::get_instance();
 
@@ -186,19 +238,42 @@ void execute_combo() {
     case (1 << START) | (1 << X) | (1 << Z):
       config.configure_triggers();
       break;
+    case (1 << START) | (1 << X) | (1 << B):
+      config.toggle_press_latching();
+      break;
     case (1 << START) | (1 << X) | (1 << LT_DIGITAL):
       config.configure_stick(config.l_stick_range, state.l_stick_coefficients,
                              config.l_stick_calibration_measurement,
-                             state.analog_sticks.r_stick, get_left_stick);
+                             display_on_right_stick, get_left_stick);
       break;
     case (1 << START) | (1 << X) | (1 << RT_DIGITAL):
       config.configure_stick(config.r_stick_range, state.r_stick_coefficients,
                              config.r_stick_calibration_measurement,
-                             state.analog_sticks.l_stick, get_right_stick);
+                             display_on_left_stick, get_right_stick);
       break;
     case (1 << START) | (1 << Y) | (1 << B):
       controller_configuration::factory_reset();
       break;
+    case (1 << START) | (1 << Y) | (1 << DPAD_UP):
+      config.cycle_stick_aggregation();
+      break;
+    case (1 << START) | (1 << Y) | (1 << DPAD_LEFT):
+      config.toggle_l_stick_snapback_mode();
+      break;
+    case (1 << START) | (1 << Y) | (1 << DPAD_RIGHT):
+      config.toggle_r_stick_snapback_mode();
+      break;
+    case (1 << START) | (1 << Y) | (1 << LT_DIGITAL):
+      config.toggle_l_stick_filter();
+      break;
+    case (1 << START) | (1 << Y) | (1 << RT_DIGITAL):
+      config.toggle_r_stick_filter();
+      break;
+#if JOYBUS_STATISTICS_STDIO
+    case (1 << START) | (1 << X) | (1 << Y):
+      print_joybus_statistics();
+      break;
+#endif
   }
 
   state.active_combo = 0;
@@ -209,226 +284,274 @@ void analog_main() {
   // Enable lockout
   multicore_lockout_victim_init();
 
+  // Interpolators are per core, so core 1 needs its own setup
+  init_stick_interpolators();
+
+  uint32_t iteration_time = 0;
+
   while (true) {
+    wait_for_next_poll(iteration_time);
+
+    uint32_t iteration_start = time_us_32();
     read_triggers();
     read_sticks();
+    uint32_t iteration_end = time_us_32();
+
+    // Track slowest recent iteration, decaying slowly towards the current one
+    uint32_t current_iteration_time = iteration_end - iteration_start;
+    if (current_iteration_time > iteration_time) {
+      iteration_time = current_iteration_time;
+    } else {
+      iteration_time -= (iteration_time - current_iteration_time) >> 6;
+    }
+  }
+}
+
+void wait_for_next_poll(uint32_t iteration_time) {
+  poll_timing timing = get_poll_timing();
+  if (!timing.locked) {
+    return;
+  }
+
+  // Time before the poll an iteration must start to finish before it
+  int32_t lead_time = iteration_time + timing.jitter + POLL_LEAD_MARGIN_US;
+  int32_t time_until_poll = timing.next_poll - time_us_32();
+
+  // If another iteration can't fit before the final one, wait to start the
+  // final one so its data is as fresh as possible when the poll arrives
+  if (time_until_poll > lead_time &&
+      time_until_poll < lead_time + static_cast<int32_t>(iteration_time)) {
+    busy_wait_us_32(time_until_poll - lead_time);
   }
 }
 
 void read_triggers() {
   controller_configuration &config = controller_configuration::get_instance();
 
-  uint8_t l_trigger, r_trigger;
-
   // Read trigger values
   raw_triggers trigger_data = get_triggers();
 
+  // Calibrate & linearize
+  uint16_t l_trigger =
+      calibrate_trigger(trigger_data.l, config.l_trigger_calibration);
+  uint16_t r_trigger =
+      calibrate_trigger(trigger_data.r, config.r_trigger_calibration);
+
   // Adjust trigger values based on center values
-  l_trigger -= std::min(trigger_data.l, state.l_trigger_center);
-  r_trigger -= std::min(trigger_data.r, state.r_trigger_center);
+  l_trigger -= std::min(l_trigger, state.l_trigger_center);
+  r_trigger -= std::min(r_trigger, state.r_trigger_center);
 
   // Apply analog trigger modes
-  triggers new_triggers;
-  new_triggers.l_trigger = apply_trigger_mode_analog(
-      l_trigger, config.l_trigger_configured_value(), state.lt_pressed,
-      config.mapping(LT_DIGITAL) == LT_DIGITAL, config.l_trigger_mode());
-  new_triggers.r_trigger = apply_trigger_mode_analog(
-      r_trigger, config.r_trigger_configured_value(), state.rt_pressed,
-      config.mapping(RT_DIGITAL) == RT_DIGITAL, config.r_trigger_mode());
-  state.analog_triggers = new_triggers;
+  state.analog_triggers.store(apply_trigger_transfers(
+      l_trigger, r_trigger, state.lt_pressed, state.rt_pressed));
 }
 
-uint8_t apply_trigger_mode_analog(uint8_t analog_value,
-                                  uint8_t configured_value, bool digital_value,
-                                  bool enable_analog, trigger_mode mode) {
-  uint8_t out = 0;
-
-  switch (mode) {
-    case digital_only:
-      out = 0;
-      break;
-    case both:
-    case analog_only:
-      out = analog_value * enable_analog;
-      break;
-    case capped_analog:
-      if (analog_value > configured_value) {
-        out = configured_value * enable_analog;
-      } else {
-        out = analog_value * enable_analog;
-      }
-      break;
-    case analog_on_digital:
-    case both_on_digital:
-      out = configured_value * digital_value * enable_analog;
-      break;
-    case multiplied_analog:
-      float multiplier =
-          (configured_value * TRIGGER_MULTIPLIER_M) + TRIGGER_MULTIPLIER_B;
-      float multiplied_value = analog_value * multiplier;
-      if (multiplied_value > 255) {
-        out = 255 * enable_analog;
-      } else {
-        out = static_cast<uint8_t>(multiplied_value) * enable_analog;
-      }
-      break;
+uint16_t calibrate_trigger(uint16_t raw_value,
+                           const trigger_calibration &calibration) {
+  // Scale the calibrated range to the full trigger range
+  if (calibration.max <= calibration.min) {
+    return 0;
   }
-
-  return out;
+  uint32_t clamped_value =
+      std::clamp(raw_value, calibration.min, calibration.max);
+  uint32_t span = calibration.max - calibration.min;
+
+  // Interpolate between the curve points either side, dividing only once so
+  // the points themselves are hit exactly
+  constexpr uint segments = NUM_TRIGGER_CURVE_POINTS - 1;
+  uint32_t position = (clamped_value - calibration.min) * segments;
+  uint segment = std::min<uint32_t>(position / span, segments - 1);
+  uint32_t offset = position - (segment * span);
+  int32_t from = calibration.curve[segment];
+  int32_t to = calibration.curve[segment + 1];
+
+  return from + (((to - from) * static_cast<int32_t>(offset)) /
+                 static_cast<int32_t>(span));
 }
 
 void read_sticks() {
   controller_configuration &config = controller_configuration::get_instance();
 
-  raw_sticks sticks_data = get_sticks();
+  sample_sticks();
+  sticks previous_sticks = state.analog_sticks.load();
+  uint32_t epoch = get_poll_epoch();
 
   sticks new_sticks;
-  new_sticks.l_stick =
-      process_raw_stick(sticks_data.l_stick, state.analog_sticks.l_stick,
-                        state.l_stick_coefficients,
-                        state.l_stick_snapback_state, config.l_stick_range);
-
-  new_sticks.r_stick =
-      process_raw_stick(sticks_data.r_stick, state.analog_sticks.r_stick,
-                        state.r_stick_coefficients,
-                        state.r_stick_snapback_state, config.r_stick_range);
-  state.analog_sticks = new_sticks;
+  new_sticks.l_stick = process_stick_samples(
+      left_stick_samples(), previous_sticks.l_stick,
+      state.l_stick_coefficients, config.l_stick_snapback_parameters(),
+      state.l_stick_snapback_state, config.l_stick_filter_parameters(),
+      state.l_stick_filter_state, config.l_stick_range,
+      config.stick_aggregation(), state.l_stick_aggregation_state, epoch);
+
+  new_sticks.r_stick = process_stick_samples(
+      right_stick_samples(), previous_sticks.r_stick,
+      state.r_stick_coefficients, config.r_stick_snapback_parameters(),
+      state.r_stick_snapback_state, config.r_stick_filter_parameters(),
+      state.r_stick_filter_state, config.r_stick_range,
+      config.stick_aggregation(), state.r_stick_aggregation_state, epoch);
+  state.analog_sticks.store(new_sticks);
 }
 
-stick process_raw_stick(raw_stick stick_data, stick previous_stick,
-                        stick_coefficients coefficients,
-                        stick_snapback_state &snapback_state, uint8_t range) {
-  if (!stick_data.fresh) {
-    return previous_stick;
+stick process_stick_samples(
+    stick_sample_ring &samples, stick previous_stick,
+    const stick_coefficients &coefficients,
+    const snapback_parameters &stick_snapback_parameters,
+    stick_snapback_state &snapback_state,
+    const stick_filter_parameters &stick_filter_parameters,
+    stick_filter_state &filter_state, uint8_t range,
+    stick_aggregation_mode aggregation_mode,
+    stick_aggregation_state &aggregation_state, uint32_t epoch) {
+  stick_context context = {coefficients,   stick_snapback_parameters,
+                           snapback_state, stick_filter_parameters,
+                           filter_state,   range};
+
+  // Filters need every sample in order, and every sample until the next poll
+  // is aggregated for output
+  bool processed = aggregation_state.count != 0;
+  raw_stick stick_data;
+  while (samples.pop(stick_data)) {
+    if (stick_data.fresh) {
+      aggregate_stick(
+          configured_stick_pipeline::process_precise(stick_data, context),
+          epoch, aggregation_state);
+      processed = true;
+    }
   }
 
-  double normalized_x =
-      normalize_axis(stick_data.x, coefficients.x_coefficients);
-  double normalized_y =
-      normalize_axis(stick_data.y, coefficients.y_coefficients);
-
-  return remap_stick(normalized_x, normalized_y, snapback_state, range);
-}
-
-double normalize_axis(uint16_t raw_axis,
-                      std::array<double, NUM_COEFFICIENTS> axis_coefficients) {
-  double normalized_axis = 0;
-  for (int i = 0; i < NUM_COEFFICIENTS; ++i) {
-    double raised_raw = 1;
-    for (int j = 0; j < i; ++j) {
-      raised_raw *= raw_axis;
-    }
-    normalized_axis += axis_coefficients[i] * raised_raw;
+  if (!processed) {
+    return previous_stick;
   }
 
-  return normalized_axis;
+  return configured_stick_pipeline::quantize(
+      aggregated_stick(aggregation_mode, epoch, aggregation_state), context);
 }
 
-stick remap_stick(double normalized_x, double normalized_y,
-                  stick_snapback_state &snapback_state, uint8_t range) {
-  controller_configuration &config = controller_configuration::get_instance();
+#if NORMALIZATION_TABLE_BUDGET > 0
+int32_t normalize_axis(uint16_t raw_axis,
+                       const normalization_table &axis_table) {
+  // Blend between the entries either side of the raw value, using the top 8
+  // bits of the remainder
+  uint index = raw_axis >> NORMALIZATION_TABLE_SHIFT;
+  uint8_t alpha = (static_cast<uint32_t>(raw_axis) << 8) >>
+                  NORMALIZATION_TABLE_SHIFT;
 
-  precise_stick unsnapped_stick =
-      unsnap_stick(normalized_x, normalized_y, snapback_state);
-
-  double min_value = CENTER - range;
-  double max_value = CENTER + range;
+  return blend_axis(axis_table[index], axis_table[index + 1], alpha);
+}
+#endif
 
-  uint8_t x = round(std::clamp(unsnapped_stick.x, min_value, max_value));
-  uint8_t y = round(std::clamp(unsnapped_stick.y, min_value, max_value));
+int32_t normalize_axis(
+    uint16_t raw_axis,
+    const std::array<int64_t, NUM_COEFFICIENTS> &axis_coefficients) {
+  int64_t normalized_axis =
+      evaluate_fixed_point<NUM_COEFFICIENTS>(axis_coefficients, raw_axis);
 
-  return stick{x, y};
+  return std::clamp<int64_t>(normalized_axis, INT32_MIN, INT32_MAX);
 }
 
-precise_stick unsnap_stick(double normalized_x, double normalized_y,
-                           stick_snapback_state &snapback_state) {
-  absolute_time_t now = get_absolute_time();
-
-  double x_displacement = normalized_x - CENTER;
-  double y_displacement = normalized_y - CENTER;
-  double x_distance = fabs(x_displacement);
-  double y_distance = fabs(y_displacement);
-
-  if (x_distance >= SNAPBACK_DISTANCE) {
-    snapback_state.x.eligible_to_snapback = true;
-    snapback_state.x.last_eligible_to_snapback = now;
-  } else if (!is_nil_time(snapback_state.x.last_eligible_to_snapback) &&
-             absolute_time_diff_us(snapback_state.x.last_eligible_to_snapback,
-                                   now) >= SNAPBACK_ELIGIBILITY_TIMEOUT_US) {
-    snapback_state.x.eligible_to_snapback = false;
-    snapback_state.x.last_eligible_to_snapback = nil_time;
-  }
+precise_stick remap_notches(
+    precise_stick normalized_stick,
+    const std::array<octant_transform, NUM_NOTCHES> &octants) {
+  constexpr int32_t center = CENTER << NORMALIZED_FRACTIONAL_BITS;
+  int32_t x =
+      std::clamp((normalized_stick.x - center) >> OCTANT_DISPLACEMENT_SHIFT,
+                 -OCTANT_DISPLACEMENT_MAX, OCTANT_DISPLACEMENT_MAX);
+  int32_t y =
+      std::clamp((normalized_stick.y - center) >> OCTANT_DISPLACEMENT_SHIFT,
+                 -OCTANT_DISPLACEMENT_MAX, OCTANT_DISPLACEMENT_MAX);
+
+  for (size_t i = 0; i < NUM_NOTCHES; ++i) {
+    const octant_transform &octant = octants[i];
+    const octant_transform &next_octant = octants[(i + 1) % NUM_NOTCHES];
+
+    // The stick is in this octant if it's counterclockwise of the starting
+    // notch, and clockwise of the next notch
+    if ((octant.start_x * y) - (octant.start_y * x) >= 0 &&
+        (x * next_octant.start_y) - (y * next_octant.start_x) > 0) {
+      // Octants left unchanged, such as those of skipped notches, keep full
+      // precision rather than that of the remapping
+      if (octant.matrix == OCTANT_IDENTITY_MATRIX) {
+        return normalized_stick;
+      }
 
-  if (y_distance >= SNAPBACK_DISTANCE) {
-    snapback_state.y.eligible_to_snapback = true;
-    snapback_state.y.last_eligible_to_snapback = now;
-  } else if (!is_nil_time(snapback_state.y.last_eligible_to_snapback) &&
-             absolute_time_diff_us(snapback_state.y.last_eligible_to_snapback,
-                                   now) >= SNAPBACK_ELIGIBILITY_TIMEOUT_US) {
-    snapback_state.y.eligible_to_snapback = false;
-    snapback_state.y.last_eligible_to_snapback = nil_time;
+      constexpr uint shift =
+          OCTANT_MATRIX_FRACTIONAL_BITS - OCTANT_DISPLACEMENT_SHIFT;
+      int32_t remapped_x =
+          ((octant.matrix[0] * x) + (octant.matrix[1] * y)) >> shift;
+      int32_t remapped_y =
+          ((octant.matrix[2] * x) + (octant.matrix[3] * y)) >> shift;
+      return {center + remapped_x, center + remapped_y};
+    }
   }
 
-  double unsnapped_x = unsnap_axis(normalized_x, x_displacement, x_distance,
-                                   y_distance, now, snapback_state.x);
-  double unsnapped_y = unsnap_axis(normalized_y, y_displacement, y_distance,
-                                   x_distance, now, snapback_state.y);
+  // Only reached at center, or if the notches are out of order
+  return normalized_stick;
+}
 
-  return {unsnapped_x, unsnapped_y};
+void init_stick_interpolators() {
+  // interp0 blends between normalization table entries, with lane 0 passing
+  // alpha through unchanged & lane 1 producing the signed blend
+  interp_config blend_lane0 = interp_default_config();
+  interp_config_set_blend(&blend_lane0, true);
+  interp_set_config(interp0, 0, &blend_lane0);
+
+  interp_config blend_lane1 = interp_default_config();
+  interp_config_set_signed(&blend_lane1, true);
+  interp_set_config(interp0, 1, &blend_lane1);
+
+  // interp1 lane 0 drops the fractional bits of a normalized value, then
+  // clamps it to the stick range
+  interp_config clamp_lane0 = interp_default_config();
+  interp_config_set_clamp(&clamp_lane0, true);
+  interp_config_set_signed(&clamp_lane0, true);
+  interp_config_set_shift(&clamp_lane0, NORMALIZED_FRACTIONAL_BITS);
+  interp_config_set_mask(&clamp_lane0, 0, 31 - NORMALIZED_FRACTIONAL_BITS);
+  interp_set_config(interp1, 0, &clamp_lane0);
 }
 
-bool axis_crossed_center(double displacement, double last_displacement,
-                         double other_axis_distance) {
-  return std::signbit(displacement) != std::signbit(last_displacement) &&
-         other_axis_distance <= CROSSING_DISTANCE;
+int32_t blend_axis(int32_t from, int32_t to, uint8_t alpha) {
+#if PICO_ON_DEVICE
+  return interpolated_blend_axis(from, to, alpha);
+#else
+  return calculated_blend_axis(from, to, alpha);
+#endif
 }
 
-double unsnap_axis(double normalized_axis, double axis_displacement,
-                   double axis_distance, double other_axis_distance,
-                   absolute_time_t now, axis_snapback_state &snapback_state) {
-  double last_distance = fabs(snapback_state.last_displacement);
-
-  if (snapback_state.eligible_to_snapback &&
-      axis_crossed_center(axis_displacement, snapback_state.last_displacement,
-                          other_axis_distance)) {
-    snapback_state.falling = false;
-    snapback_state.falling_count = 0;
-    snapback_state.wave_started_at = now;
-    snapback_state.wave_expires_at =
-        delayed_by_us(now, DEFAULT_WAVE_DURATION_US);
-    snapback_state.in_snapback = true;
-    snapback_state.eligible_to_snapback = false;
-  } else if (snapback_state.in_snapback) {
-    bool snapback_expired =
-        absolute_time_diff_us(snapback_state.wave_expires_at, now) >= 0;
-
-    if (snapback_expired) {
-      snapback_state.in_snapback = false;
-      snapback_state.eligible_to_snapback = false;
-    } else if (!snapback_state.falling) {
-      if (axis_distance <= last_distance &&
-          axis_distance >= CENTERED_DISTANCE) {
-        snapback_state.falling_count += 1;
-      } else {
-        snapback_state.falling_count = 0;
-      }
+int32_t interpolated_blend_axis(int32_t from, int32_t to, uint8_t alpha) {
+  interp0->accum[0] = alpha;
+  interp0->base[0] = from;
+  interp0->base[1] = to;
+  return interp0->peek[1];
+}
 
-      if (snapback_state.falling_count >= 3) {
-        snapback_state.falling = true;
-        snapback_state.falling_count = 0;
-        uint64_t new_wave_duration =
-            absolute_time_diff_us(snapback_state.wave_started_at, now) +
-            SNAPBACK_WAVE_DURATION_BUFFER;
-        snapback_state.wave_expires_at = delayed_by_us(now, new_wave_duration);
-      }
-    }
-  }
+int32_t calculated_blend_axis(int32_t from, int32_t to, uint8_t alpha) {
+  return from + ((static_cast<int64_t>(to - from) * alpha) >> 8);
+}
 
-  snapback_state.last_displacement = axis_displacement;
+uint8_t round_and_clamp_axis(int32_t normalized_axis, int32_t min_value,
+                             int32_t max_value) {
+#if PICO_ON_DEVICE
+  return interpolated_round_and_clamp_axis(normalized_axis, min_value,
+                                           max_value);
+#else
+  return calculated_round_and_clamp_axis(normalized_axis, min_value,
+                                         max_value);
+#endif
+}
 
-  if (snapback_state.in_snapback) {
-    return CENTER;
-  }
+uint8_t interpolated_round_and_clamp_axis(int32_t normalized_axis,
+                                          int32_t min_value,
+                                          int32_t max_value) {
+  interp1->accum[0] = normalized_axis + (1 << (NORMALIZED_FRACTIONAL_BITS - 1));
+  interp1->base[0] = min_value;
+  interp1->base[1] = max_value;
+  return interp1->peek[0];
+}
 
-  return normalized_axis;
+uint8_t calculated_round_and_clamp_axis(int32_t normalized_axis,
+                                        int32_t min_value, int32_t max_value) {
+  int32_t rounded_axis =
+      normalized_axis + (1 << (NORMALIZED_FRACTIONAL_BITS - 1));
+  return std::clamp(rounded_axis >> NORMALIZED_FRACTIONAL_BITS, min_value,
+                    max_value);
 }
@@ -36,6 +36,20 @@
  */
 void read_digital(uint16_t physical_buttons);
 
+/** \brief Remap physical button states with the current profile's mappings
+ *
+ * Reference for the tables compiled by `compile_button_remap()`, which are
+ * used instead while running.
+ *
+ * \param config Configuration to take mappings from
+ * \param physical_buttons Physical button states
+ * \param remapped_buttons Output button states before remapping
+ *
+ * \return Output button states
+ */
+uint16_t remap_buttons(controller_configuration& config,
+                       uint16_t physical_buttons, uint16_t remapped_buttons);
+
 /** \brief Map a physical button to its remapped value
  *
  * \param physical_buttons Physical button states
@@ -67,92 +81,209 @@ void apply_trigger_mode_digital(uint16_t& buttons, uint8_t bit_to_set,
  */
 void check_combos(uint32_t physical_buttons);
 
+/** \brief Show a stick position on the left stick
+ *
+ * \param display_stick Stick position to show
+ */
+void display_on_left_stick(stick display_stick);
+
+/** \brief Show a stick position on the right stick
+ *
+ * \param display_stick Stick position to show
+ */
+void display_on_right_stick(stick display_stick);
+
 /// \brief Executes the current combo
 void execute_combo();
 
-/// \brief Main analog input loop, run on second core
+/** \brief Margin left between analog processing finishing and a poll, which
+ * covers the main loop encoding the new analog state for the console
+ */
+constexpr int32_t POLL_LEAD_MARGIN_US = 20;
+
+/** \brief Main analog input loop, run on second core
+ *
+ * Runs continuously, but once poll timing is locked, delays the last
+ * iteration before each poll so it finishes just before the poll arrives.
+ */
 void analog_main();
 
+/** \brief Wait if needed so the next analog iteration finishes just before
+ * the next poll
+ *
+ * \param iteration_time Time an analog iteration takes in microseconds
+ */
+void wait_for_next_poll(uint32_t iteration_time);
+
 /// \brief Process analog trigger values
 void read_triggers();
 
-/** \brief Update analog trigger value based on trigger mode
+/** \brief Scale a raw trigger value to its calibrated range, and linearize it
  *
- * \param analog_value Current analog trigger value
- * \param configured_value Configured value
- * \param digital_value Digital value for this trigger
- * \param enable_analog Whether analog output is enabled
- * \param mode Current trigger mode
+ * \param raw_value Raw trigger value
+ * \param calibration Calibration for this trigger
  *
- * \return New analog value after applying trigger mode
+ * \return Calibrated trigger value, from 0 to `TRIGGER_MAX`
  */
-uint8_t apply_trigger_mode_analog(uint8_t analog_value,
-                                  uint8_t configured_value, bool digital_value,
-                                  bool enable_analog, trigger_mode mode);
+uint16_t calibrate_trigger(uint16_t raw_value,
+                           const trigger_calibration& calibration);
 
 /// \brief Read analog sticks and update state
 void read_sticks();
 
-/** \brief Process raw stick data, running it through normalization and rempping
- * 
- * \param stick_data Raw stick data
+/** \brief Process every queued sample of a stick in order, aggregating them
+ * with the others processed since the last poll
+ *
+ * \param samples Queued raw samples of the stick
  * \param previous_stick Last stick state
  * \param stick_coefficients Coefficients used to normalize stick
+ * \param stick_snapback_parameters Snapback filter parameters for the stick
  * \param snapback_state Current state of snapback for the stick
+ * \param stick_filter_parameters Adaptive filter parameters for the stick
+ * \param filter_state Current adaptive filter state for the stick
  * \param range Maximum range around center
- * 
- * \return Stick data for use in state
+ * \param aggregation_mode How samples are aggregated between polls
+ * \param aggregation_state Samples of the stick aggregated since the last poll
+ * \param epoch Current poll epoch
+ *
+ * \return Stick data for the aggregated samples, or `previous_stick` if none
+ * have been processed
+ */
+stick process_stick_samples(
+    stick_sample_ring& samples, stick previous_stick,
+    const stick_coefficients& coefficients,
+    const snapback_parameters& stick_snapback_parameters,
+    stick_snapback_state& snapback_state,
+    const stick_filter_parameters& stick_filter_parameters,
+    stick_filter_state& filter_state, uint8_t range,
+    stick_aggregation_mode aggregation_mode,
+    stick_aggregation_state& aggregation_state, uint32_t epoch);
+
+#if NORMALIZATION_TABLE_BUDGET > 0
+/** \brief Normalize an axis using the given lookup table
+ *
+ * \param raw_axis Raw axis value to normalize
+ * \param axis_table Table to use for axis normalization
+ *
+ * \return Normalized axis value with `NORMALIZED_FRACTIONAL_BITS` fractional
+ * bits
  */
-stick process_raw_stick(raw_stick stick_data, stick previous_stick,
-                        stick_coefficients coefficients,
-                        stick_snapback_state& snapback_state, uint8_t range);
+int32_t normalize_axis(uint16_t raw_axis,
+                       const normalization_table& axis_table);
+#endif
 
 /** \brief Normalize an axis using the given polynomial coefficients
  *
  * \param raw_axis Raw axis value to normalize
- * \param axis_coefficients Coefficients to use for axis normalization
+ * \param axis_coefficients Fixed-point coefficients to use for axis
+ * normalization
  *
- * \return Normalized axis value
+ * \return Normalized axis value with `NORMALIZED_FRACTIONAL_BITS` fractional
+ * bits
  */
-double normalize_axis(uint16_t raw_axis,
-                      std::array<double, NUM_COEFFICIENTS> coefficients);
+int32_t normalize_axis(
+    uint16_t raw_axis,
+    const std::array<int64_t, NUM_COEFFICIENTS>& axis_coefficients);
 
-/** \brief Remap normalized stick data for snapback and cardinals
- * 
- * \param normalized_x Normalized x-axis value
- * \param normalized_y Normalized y-axis value
- * \param snapback_state Current state of snapback for the stick
- * \param range Maximum range around center
- * 
- * \return Stick data for use in state
+/** \brief Remap a normalized stick so calibrated notches hit their targets
+ *
+ * Displacements are remapped at `OCTANT_DISPLACEMENT_SHIFT` reduced
+ * precision, except in octants with an identity transform, which are left
+ * unchanged.
+ *
+ * \param normalized_stick Normalized stick
+ * \param octants Notch remapping for each octant
+ *
+ * \return Remapped stick
  */
-stick remap_stick(double x, double y, stick_snapback_state& snapback_state,
-                  uint8_t range);
+precise_stick remap_notches(
+    precise_stick normalized_stick,
+    const std::array<octant_transform, NUM_NOTCHES>& octants);
 
-/** \brief Filter a stick for snapback
- * 
- * \param normalized_x Normalized x-axis value
- * \param normalized_y Normalized y-axis value
- * \param snapback_state Current state of snapback for the stick
- * 
- * \return Stick data with snapback removed
+/** \brief Configure the calling core's interpolators for stick processing
+ *
+ * \note Must be called on each core which processes sticks, and nothing else
+ * on those cores may reconfigure the interpolators.
+ */
+void init_stick_interpolators();
+
+/** \brief Linearly interpolate between two normalized axis values
+ *
+ * Uses `interpolated_blend_axis()` on device, and `calculated_blend_axis()`
+ * elsewhere.
+ *
+ * \param from Value when `alpha` is 0
+ * \param to Value when `alpha` is 256
+ * \param alpha Position between `from` & `to`, in 256ths
+ *
+ * \return Interpolated value
+ */
+int32_t blend_axis(int32_t from, int32_t to, uint8_t alpha);
+
+/** \brief Linearly interpolate between two normalized axis values with the
+ * interpolator blend mode
+ *
+ * \note Requires `init_stick_interpolators()` on the calling core.
+ *
+ * \param from Value when `alpha` is 0
+ * \param to Value when `alpha` is 256
+ * \param alpha Position between `from` & `to`, in 256ths
+ *
+ * \return Interpolated value
+ */
+int32_t interpolated_blend_axis(int32_t from, int32_t to, uint8_t alpha);
+
+/** \brief Linearly interpolate between two normalized axis values with
+ * integer arithmetic, as the interpolator blend mode does
+ *
+ * \param from Value when `alpha` is 0
+ * \param to Value when `alpha` is 256
+ * \param alpha Position between `from` & `to`, in 256ths
+ *
+ * \return Interpolated value
  */
-precise_stick unsnap_stick(double normalized_x, double normalized_y,
-                           stick_snapback_state& snapback_state);
+int32_t calculated_blend_axis(int32_t from, int32_t to, uint8_t alpha);
 
-/** \brief Filter an axis for snapback
- * 
+/** \brief Round a normalized axis value to the nearest output value, and
+ * clamp it to a range
+ *
+ * Uses `interpolated_round_and_clamp_axis()` on device, and
+ * `calculated_round_and_clamp_axis()` elsewhere.
+ *
+ * \param normalized_axis Normalized axis value
+ * \param min_value Minimum output value
+ * \param max_value Maximum output value
+ *
+ * \return Rounded & clamped axis value
+ */
+uint8_t round_and_clamp_axis(int32_t normalized_axis, int32_t min_value,
+                             int32_t max_value);
+
+/** \brief Round a normalized axis value to the nearest output value, and
+ * clamp it to a range with the interpolator clamp mode
+ *
+ * \note Requires `init_stick_interpolators()` on the calling core.
+ *
  * \param normalized_axis Normalized axis value
- * \param axis_displacement Displacement from center of the axis
- * \param axis_distance Distance from center of the axis
- * \param other_axis_distance Distance from center of the other axis
- * \param now Current timestamp
- * \param snapback_state Snapback state for this axis
- * 
- * \return
- */
-double unsnap_axis(double normalized_axis, double axis_displacement,
-                   double axis_distance, double other_axis_distance,
-                   absolute_time_t now, axis_snapback_state& snapback_state);
+ * \param min_value Minimum output value
+ * \param max_value Maximum output value
+ *
+ * \return Rounded & clamped axis value
+ */
+uint8_t interpolated_round_and_clamp_axis(int32_t normalized_axis,
+                                          int32_t min_value,
+                                          int32_t max_value);
+
+/** \brief Round a normalized axis value to the nearest output value, and
+ * clamp it to a range with integer arithmetic
+ *
+ * \param normalized_axis Normalized axis value
+ * \param min_value Minimum output value
+ * \param max_value Maximum output value
+ *
+ * \return Rounded & clamped axis value
+ */
+uint8_t calculated_round_and_clamp_axis(int32_t normalized_axis,
+                                        int32_t min_value, int32_t max_value);
 
 #endif  // MAIN_H_
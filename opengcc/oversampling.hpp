@@ -0,0 +1,92 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef OVERSAMPLING_H_
+#define OVERSAMPLING_H_
+
+#include <pico/types.h>
+
+#include <array>
+
+#include "analog_controller.hpp"
+
+/** \file oversampling.hpp
+ * \brief Reduction of several raw stick samples into one
+ *
+ * Samples are reduced with the method chosen by
+ * `STICK_OVERSAMPLING_REDUCTION`:
+ * * `MEDIAN` takes the median of each axis, the mean of the middle two for an
+ *   even number of samples.
+ * * `TRIMMED_MEAN` drops the lowest & highest quarter of each axis, at least
+ *   one each when there are three or more samples, and takes the mean of the
+ *   rest.
+ *
+ * Both reject single-sample outliers, such as a corrupted read, which a plain
+ * mean would pass through.
+ */
+
+/** \brief Ring of the most recent raw samples of a stick
+ *
+ * \tparam num_samples Number of samples kept
+ */
+template <uint num_samples>
+class stick_oversampler {
+ private:
+  std::array<uint16_t, num_samples> x_samples = {};
+  std::array<uint16_t, num_samples> y_samples = {};
+  std::array<uint32_t, num_samples> timestamps = {};
+  uint next = 0;
+  uint count = 0;
+
+ public:
+  /** \brief Record a sample, replacing the oldest once the ring is full
+   *
+   * \param sample Raw stick sample
+   */
+  void record(const raw_stick &sample);
+
+  /// \brief Discard all recorded samples
+  void reset();
+
+  /** \brief Reduce the recorded samples into one
+   *
+   * \note Must not be called before a sample has been recorded.
+   *
+   * \return Reduced sample, marked fresh, with the timestamp of the middle
+   * sample, as that best represents when the reduced value was measured
+   */
+  raw_stick reduce() const;
+};
+
+/** \brief Reduce samples of an axis with the `STICK_OVERSAMPLING_REDUCTION`
+ * method
+ *
+ * \tparam num_samples Capacity of the sample array
+ *
+ * \param samples Axis samples, only the first `count` of which are used
+ * \param count Number of samples to reduce, at least 1
+ *
+ * \return Reduced axis value
+ */
+template <uint num_samples>
+uint16_t reduce_axis_samples(std::array<uint16_t, num_samples> samples,
+                             uint count);
+
+#include "oversampling.tpp"
+
+#endif  // OVERSAMPLING_H_
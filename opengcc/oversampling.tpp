@@ -0,0 +1,80 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+template <uint num_samples>
+void stick_oversampler<num_samples>::record(const raw_stick &sample) {
+  x_samples[next] = sample.x;
+  y_samples[next] = sample.y;
+  timestamps[next] = sample.timestamp;
+
+  next = (next + 1) % num_samples;
+  if (count < num_samples) {
+    ++count;
+  }
+}
+
+template <uint num_samples>
+void stick_oversampler<num_samples>::reset() {
+  next = 0;
+  count = 0;
+}
+
+template <uint num_samples>
+raw_stick stick_oversampler<num_samples>::reduce() const {
+  // Samples are stored from index 0 until the ring is full, and oldest first
+  // from `next` after that
+  uint oldest = count < num_samples ? 0 : next;
+  uint32_t timestamp = timestamps[(oldest + (count - 1) / 2) % num_samples];
+
+  return {reduce_axis_samples<num_samples>(x_samples, count),
+          reduce_axis_samples<num_samples>(y_samples, count), true, timestamp};
+}
+
+template <uint num_samples>
+uint16_t reduce_axis_samples(std::array<uint16_t, num_samples> samples,
+                             uint count) {
+  // Insertion sort, as there are only ever a handful of samples
+  for (uint i = 1; i < count; ++i) {
+    uint16_t sample = samples[i];
+    uint j = i;
+    for (; j > 0 && samples[j - 1] > sample; --j) {
+      samples[j] = samples[j - 1];
+    }
+    samples[j] = sample;
+  }
+
+#if STICK_OVERSAMPLING_REDUCTION == TRIMMED_MEAN
+  uint trim = count / 4;
+  if (trim == 0 && count >= 3) {
+    trim = 1;
+  }
+
+  uint32_t sum = 0;
+  for (uint i = trim; i < count - trim; ++i) {
+    sum += samples[i];
+  }
+  uint kept = count - (2 * trim);
+  return (sum + (kept / 2)) / kept;
+#else
+  uint middle = count / 2;
+  if (count % 2 == 0) {
+    return (samples[middle - 1] + samples[middle] + 1) / 2;
+  }
+  return samples[middle];
+#endif
+}
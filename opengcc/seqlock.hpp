@@ -0,0 +1,72 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <pico/types.h>
+
+/** \file seqlock.hpp
+ * \brief Lock-free snapshots of state shared between cores
+ */
+
+/** \brief Value shared between cores which is always read as a consistent
+ * snapshot
+ *
+ * The writer increments a sequence number before and after updating the
+ * value, so readers can detect and retry a read that overlapped a write.
+ * Writers never wait, and readers only retry while a write on the other core
+ * is in progress, which takes a handful of cycles. Writes are made with
+ * interrupts disabled, so an interrupt handler reading the value never spins
+ * on a write it interrupted.
+ *
+ * \note Only one core may write the value at a time.
+ *
+ * \tparam T Type of value to share, must be trivially copyable
+ */
+template <typename T>
+class seqlock {
+ private:
+  volatile uint32_t sequence = 0;
+  T value = {};
+
+ public:
+  seqlock() = default;
+
+  /** \brief Construct the seqlock with an initial value
+   *
+   * \param initial_value Value to initialize with
+   */
+  seqlock(const T &initial_value);
+
+  /** \brief Replace the shared value
+   *
+   * \param new_value Value to publish
+   */
+  void store(const T &new_value);
+
+  /** \brief Read a consistent snapshot of the shared value
+   *
+   * \return Current value
+   */
+  T load() const;
+};
+
+#include "seqlock.tpp"
+
+#endif  // SEQLOCK_H_
@@ -0,0 +1,55 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "hardware/sync.h"
+
+template <typename T>
+seqlock<T>::seqlock(const T &initial_value) : value(initial_value) {}
+
+template <typename T>
+void seqlock<T>::store(const T &new_value) {
+  uint32_t saved_irq = save_and_disable_interrupts();
+
+  // Odd sequence marks a write in progress
+  uint32_t current_sequence = sequence;
+  sequence = current_sequence + 1;
+  __dmb();
+
+  value = new_value;
+
+  __dmb();
+  sequence = current_sequence + 2;
+
+  restore_interrupts(saved_irq);
+}
+
+template <typename T>
+T seqlock<T>::load() const {
+  while (true) {
+    uint32_t start_sequence = sequence;
+    __dmb();
+
+    T ret = value;
+
+    __dmb();
+    // Snapshot is consistent if no write started or finished during the copy
+    if ((start_sequence & 1) == 0 && start_sequence == sequence) {
+      return ret;
+    }
+  }
+}
@@ -0,0 +1,233 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "snapback.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+precise_stick unsnap_stick(precise_stick normalized_stick, uint32_t timestamp,
+                           const snapback_parameters &parameters,
+                           stick_snapback_state &snapback_state) {
+  int32_t x_displacement =
+      normalized_stick.x - (CENTER << NORMALIZED_FRACTIONAL_BITS);
+  int32_t y_displacement =
+      normalized_stick.y - (CENTER << NORMALIZED_FRACTIONAL_BITS);
+
+  int32_t unsnapped_x =
+      unsnap_axis(normalized_stick.x, x_displacement, abs(y_displacement),
+                  timestamp, parameters, snapback_state.x);
+  int32_t unsnapped_y =
+      unsnap_axis(normalized_stick.y, y_displacement, abs(x_displacement),
+                  timestamp, parameters, snapback_state.y);
+
+  return {unsnapped_x, unsnapped_y};
+}
+
+void update_snapback_eligibility(int32_t axis_distance, uint32_t timestamp,
+                                 const snapback_parameters &parameters,
+                                 snapback_eligibility &eligibility) {
+  if (axis_distance >= parameters.snapback_distance
+                           << NORMALIZED_FRACTIONAL_BITS) {
+    eligibility.eligible_to_snapback = true;
+    eligibility.last_eligible_to_snapback = timestamp;
+  } else if (eligibility.eligible_to_snapback &&
+             timestamp_reached(timestamp,
+                               eligibility.last_eligible_to_snapback +
+                                   parameters.eligibility_timeout_us)) {
+    eligibility.eligible_to_snapback = false;
+  }
+}
+
+bool axis_crossed_center(int32_t displacement, int32_t last_displacement,
+                         int32_t other_axis_distance,
+                         const snapback_parameters &parameters) {
+  return (displacement < 0) != (last_displacement < 0) &&
+         other_axis_distance <= parameters.crossing_distance
+                                    << NORMALIZED_FRACTIONAL_BITS;
+}
+
+int32_t unsnap_axis(int32_t normalized_axis, int32_t axis_displacement,
+                    int32_t other_axis_distance, uint32_t timestamp,
+                    const snapback_parameters &parameters,
+                    axis_snapback_state &snapback_state) {
+  switch (parameters.mode) {
+    case velocity_snapback: {
+      velocity_snapback_state *velocity_state =
+          std::get_if<velocity_snapback_state>(&snapback_state);
+      if (velocity_state == nullptr) {
+        velocity_state = &snapback_state.emplace<velocity_snapback_state>();
+      }
+      return unsnap_axis_velocity(normalized_axis, axis_displacement,
+                                  timestamp, parameters, *velocity_state);
+    }
+    case wave_snapback:
+    default: {
+      wave_snapback_state *wave_state =
+          std::get_if<wave_snapback_state>(&snapback_state);
+      if (wave_state == nullptr) {
+        wave_state = &snapback_state.emplace<wave_snapback_state>();
+      }
+      return unsnap_axis_wave(normalized_axis, axis_displacement,
+                              other_axis_distance, timestamp, parameters,
+                              *wave_state);
+    }
+  }
+}
+
+int32_t unsnap_axis_wave(int32_t normalized_axis, int32_t axis_displacement,
+                         int32_t other_axis_distance, uint32_t timestamp,
+                         const snapback_parameters &parameters,
+                         wave_snapback_state &snapback_state) {
+  int32_t axis_distance = abs(axis_displacement);
+  int32_t last_distance = abs(snapback_state.last_displacement);
+
+  update_snapback_eligibility(axis_distance, timestamp, parameters,
+                              snapback_state.eligibility);
+
+  if (snapback_state.eligibility.eligible_to_snapback &&
+      axis_crossed_center(axis_displacement, snapback_state.last_displacement,
+                          other_axis_distance, parameters)) {
+    snapback_state.falling = false;
+    snapback_state.decreasing = false;
+    snapback_state.wave_started_at = timestamp;
+    snapback_state.wave_expires_at = timestamp + parameters.wave_duration_us;
+    snapback_state.in_snapback = true;
+    snapback_state.eligibility.eligible_to_snapback = false;
+  } else if (snapback_state.in_snapback) {
+    if (timestamp_reached(timestamp, snapback_state.wave_expires_at)) {
+      snapback_state.in_snapback = false;
+      snapback_state.eligibility.eligible_to_snapback = false;
+    } else if (!snapback_state.falling) {
+      if (axis_distance <= last_distance &&
+          axis_distance >= parameters.centered_distance
+                               << NORMALIZED_FRACTIONAL_BITS) {
+        if (!snapback_state.decreasing) {
+          snapback_state.decreasing = true;
+          snapback_state.decreasing_since = timestamp;
+        }
+      } else {
+        snapback_state.decreasing = false;
+      }
+
+      // Once the wave has been falling long enough to be sure it's past its
+      // peak, expect it to take about as long to fall as it did to rise
+      if (snapback_state.decreasing &&
+          timestamp_reached(timestamp, snapback_state.decreasing_since +
+                                           parameters.falling_time_us)) {
+        snapback_state.falling = true;
+        snapback_state.decreasing = false;
+        uint32_t rise_time = timestamp - snapback_state.wave_started_at;
+        snapback_state.wave_expires_at =
+            timestamp + rise_time + parameters.wave_duration_buffer_us;
+      }
+    }
+  }
+
+  snapback_state.last_displacement = axis_displacement;
+
+  if (snapback_state.in_snapback) {
+    return CENTER << NORMALIZED_FRACTIONAL_BITS;
+  }
+
+  return normalized_axis;
+}
+
+int32_t unsnap_axis_velocity(int32_t normalized_axis,
+                             int32_t axis_displacement, uint32_t timestamp,
+                             const snapback_parameters &parameters,
+                             velocity_snapback_state &snapback_state) {
+  int32_t axis_distance = abs(axis_displacement);
+  update_snapback_eligibility(axis_distance, timestamp, parameters,
+                              snapback_state.eligibility);
+
+  constexpr uint precision_shift =
+      NORMALIZED_FRACTIONAL_BITS - VELOCITY_SNAPBACK_FRACTIONAL_BITS;
+  int32_t displacement = axis_displacement >> precision_shift;
+
+  // Restart tracking after a gap, otherwise update the smoothed velocity &
+  // acceleration, weighting each sample by how much time it covers
+  int32_t elapsed = timestamp - snapback_state.last_timestamp;
+  if (!snapback_state.primed || elapsed <= 0 ||
+      elapsed > VELOCITY_SNAPBACK_MAX_SAMPLE_GAP_US) {
+    snapback_state.primed = true;
+    snapback_state.velocity = 0;
+    snapback_state.acceleration = 0;
+  } else {
+    int32_t weight = (elapsed << 8) / (elapsed + parameters.smoothing_us);
+
+    int32_t velocity =
+        ((displacement - snapback_state.last_displacement) * 1000) / elapsed;
+    velocity = std::clamp(velocity, -VELOCITY_SNAPBACK_MOTION_MAX,
+                          VELOCITY_SNAPBACK_MOTION_MAX);
+    int32_t last_velocity = snapback_state.velocity;
+    snapback_state.velocity +=
+        ((velocity - snapback_state.velocity) * weight) >> 8;
+
+    int32_t acceleration =
+        ((snapback_state.velocity - last_velocity) * 1000) / elapsed;
+    acceleration = std::clamp(acceleration, -VELOCITY_SNAPBACK_MOTION_MAX,
+                              VELOCITY_SNAPBACK_MOTION_MAX);
+    snapback_state.acceleration +=
+        ((acceleration - snapback_state.acceleration) * weight) >> 8;
+  }
+  snapback_state.last_timestamp = timestamp;
+  snapback_state.last_displacement = displacement;
+
+  // Only filter after a large displacement, and short of the distance the
+  // axis reached, so slow movements and the stick reaching the gate aren't
+  // affected
+  if (!snapback_state.eligibility.eligible_to_snapback) {
+    snapback_state.peak_distance = 0;
+    return normalized_axis;
+  }
+  snapback_state.peak_distance =
+      std::max(snapback_state.peak_distance, axis_distance);
+  if (axis_distance >= snapback_state.peak_distance -
+                           (snapback_state.peak_distance >> 3)) {
+    return normalized_axis;
+  }
+
+  // For a damped spring, x'' = -w^2 (x - x_rest) - 2 z w x', so the position
+  // it's oscillating around is x_rest = x + x'' / w^2 + (2 z / w) x'. Gains
+  // are in milliseconds, with 8 fractional bits, from the period in
+  // milliseconds with 8 fractional bits.
+  int32_t period = (parameters.natural_period_us << 8) / 1000;
+  int32_t acceleration_gain = (period * period) / 10106;  // 4 pi^2 * 2^8
+  int32_t velocity_gain =
+      (parameters.damping_percent * period) / 314;  // 100 pi
+  int64_t rest_displacement =
+      displacement +
+      ((static_cast<int64_t>(snapback_state.acceleration) * acceleration_gain +
+        static_cast<int64_t>(snapback_state.velocity) * velocity_gain) >>
+       8);
+
+  // Never push output further from center than the axis actually is, or
+  // past center
+  int32_t filtered_displacement;
+  if (displacement >= 0) {
+    filtered_displacement = std::clamp<int64_t>(rest_displacement, 0,
+                                                displacement);
+  } else {
+    filtered_displacement = std::clamp<int64_t>(rest_displacement,
+                                                displacement, 0);
+  }
+
+  return (CENTER << NORMALIZED_FRACTIONAL_BITS) +
+         (filtered_displacement << precision_shift);
+}
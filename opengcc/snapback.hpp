@@ -0,0 +1,158 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef SNAPBACK_H_
+#define SNAPBACK_H_
+
+#include <pico/types.h>
+
+#include "state.hpp"
+
+/** \file snapback.hpp
+ * \brief Snapback filtering
+ *
+ * When a stick is released from a large displacement it overshoots center and
+ * oscillates, which the console can read as an input in the opposite
+ * direction. Two filter modes are available:
+ * * `wave_snapback` holds an axis at center from when it crosses center until
+ *   the oscillation dies down. Simple & robust, but fast intentional center
+ *   crossings are also held for the duration of a wave.
+ * * `velocity_snapback` models the stick as a damped spring, and uses the
+ *   velocity & acceleration of the axis to estimate the position it's
+ *   oscillating around. After a large displacement, and short of the distance
+ *   the axis reached, output is pulled towards that estimate, but never
+ *   further from center than the actual position, so motion driven by the
+ *   player passes through.
+ *
+ * All decisions are based on sample timestamps rather than sample counts, so
+ * the filter behaves the same regardless of how often sticks are sampled.
+ */
+
+/// \brief Fractional bits used for `velocity_snapback` motion tracking
+constexpr uint VELOCITY_SNAPBACK_FRACTIONAL_BITS = 8;
+
+/** \brief Longest gap between samples used for `velocity_snapback` motion
+ * tracking, in microseconds
+ *
+ * Longer gaps restart tracking, which also keeps the arithmetic within 32
+ * bits.
+ */
+constexpr uint32_t VELOCITY_SNAPBACK_MAX_SAMPLE_GAP_US = 4000;
+
+/// \brief Largest `velocity_snapback` velocity & acceleration magnitude
+constexpr int32_t VELOCITY_SNAPBACK_MOTION_MAX = 1 << 19;
+
+/** \brief Filter a stick for snapback
+ *
+ * \param normalized_stick Normalized stick
+ * \param timestamp Time the stick was sampled, in microseconds since boot
+ * \param parameters Snapback filter parameters for the stick
+ * \param snapback_state Current state of snapback for the stick
+ *
+ * \return Stick data with snapback removed
+ */
+precise_stick unsnap_stick(precise_stick normalized_stick, uint32_t timestamp,
+                           const snapback_parameters &parameters,
+                           stick_snapback_state &snapback_state);
+
+/** \brief Update whether an axis is eligible to snapback
+ *
+ * \param axis_distance Distance from center of the axis
+ * \param timestamp Time the axis was sampled
+ * \param parameters Snapback filter parameters for the stick
+ * \param eligibility Snapback eligibility for this axis
+ */
+void update_snapback_eligibility(int32_t axis_distance, uint32_t timestamp,
+                                 const snapback_parameters &parameters,
+                                 snapback_eligibility &eligibility);
+
+/** \brief Check if an axis has crossed the center for snapback purposes
+ *
+ * \param displacement Current displacement from center of the axis
+ * \param last_displacement Previous displacement from center of the axis
+ * \param other_axis_distance Distance from center of the other axis
+ * \param parameters Snapback filter parameters for the stick
+ *
+ * \return `true` if the axis crossed center, `false` otherwise
+ */
+bool axis_crossed_center(int32_t displacement, int32_t last_displacement,
+                         int32_t other_axis_distance,
+                         const snapback_parameters &parameters);
+
+/** \brief Filter an axis for snapback with the mode set in `parameters`
+ *
+ * Resets the axis state if the mode has changed since the last sample.
+ *
+ * \param normalized_axis Normalized axis value
+ * \param axis_displacement Displacement from center of the axis
+ * \param other_axis_distance Distance from center of the other axis
+ * \param timestamp Time the axis was sampled
+ * \param parameters Snapback filter parameters for the stick
+ * \param snapback_state Snapback state for this axis
+ *
+ * \return Normalized axis value with snapback removed
+ */
+int32_t unsnap_axis(int32_t normalized_axis, int32_t axis_displacement,
+                    int32_t other_axis_distance, uint32_t timestamp,
+                    const snapback_parameters &parameters,
+                    axis_snapback_state &snapback_state);
+
+/** \brief Filter an axis for snapback in `wave_snapback` mode
+ *
+ * \param normalized_axis Normalized axis value
+ * \param axis_displacement Displacement from center of the axis
+ * \param other_axis_distance Distance from center of the other axis
+ * \param timestamp Time the axis was sampled
+ * \param parameters Snapback filter parameters for the stick
+ * \param snapback_state Wave snapback state for this axis
+ *
+ * \return Normalized axis value with snapback removed
+ */
+int32_t unsnap_axis_wave(int32_t normalized_axis, int32_t axis_displacement,
+                         int32_t other_axis_distance, uint32_t timestamp,
+                         const snapback_parameters &parameters,
+                         wave_snapback_state &snapback_state);
+
+/** \brief Filter an axis for snapback in `velocity_snapback` mode
+ *
+ * \param normalized_axis Normalized axis value
+ * \param axis_displacement Displacement from center of the axis
+ * \param timestamp Time the axis was sampled
+ * \param parameters Snapback filter parameters for the stick
+ * \param snapback_state Velocity snapback state for this axis
+ *
+ * \return Normalized axis value with snapback removed
+ */
+int32_t unsnap_axis_velocity(int32_t normalized_axis,
+                             int32_t axis_displacement, uint32_t timestamp,
+                             const snapback_parameters &parameters,
+                             velocity_snapback_state &snapback_state);
+
+/** \brief Check if a timestamp has been reached
+ *
+ * \param timestamp Current timestamp
+ * \param deadline Timestamp to check against
+ *
+ * \return `true` if `timestamp` is at or after `deadline`, accounting for
+ * wrapping, `false` otherwise
+ */
+inline bool timestamp_reached(uint32_t timestamp, uint32_t deadline) {
+  return static_cast<int32_t>(timestamp - deadline) >= 0;
+}
+
+#endif  // SNAPBACK_H_
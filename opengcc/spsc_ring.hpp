@@ -0,0 +1,93 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <pico/types.h>
+
+#include <array>
+
+/** \file spsc_ring.hpp
+ * \brief Wait-free queue between one producer and one consumer
+ */
+
+/** \brief Fixed-size queue with one producer and one consumer, which may be on
+ * different cores or in an interrupt handler
+ *
+ * Each side only writes its own index, so neither ever waits for the other.
+ * Indices run freely and wrap, so a full ring is distinguished from an empty
+ * one without sacrificing an item. When the ring is full, new items are
+ * dropped and counted rather than overwriting unread ones, as only the
+ * consumer may advance past an item.
+ *
+ * \note Only one producer & one consumer may use the ring at a time.
+ *
+ * \tparam T Type of item, must be trivially copyable
+ * \tparam capacity Maximum number of queued items, a power of two
+ */
+template <typename T, uint capacity>
+class spsc_ring {
+  static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+ private:
+  std::array<T, capacity> items = {};
+  /// \brief Number of items ever pushed, only written by the producer
+  volatile uint32_t head = 0;
+  /// \brief Number of items ever popped, only written by the consumer
+  volatile uint32_t tail = 0;
+  /// \brief Number of items dropped as the ring was full
+  volatile uint32_t dropped = 0;
+
+ public:
+  /** \brief Queue an item, from the producer
+   *
+   * \param item Item to queue
+   *
+   * \return `true` if the item was queued, `false` if the ring was full and
+   * it was dropped
+   */
+  bool push(const T &item);
+
+  /** \brief Take the oldest queued item, from the consumer
+   *
+   * \param item Output for the item
+   *
+   * \return `true` if an item was taken, `false` if the ring was empty
+   */
+  bool pop(T &item);
+
+  /** \brief Get the number of queued items
+   *
+   * \note Only exact from the consumer, as the producer may push at any time.
+   *
+   * \return Number of items
+   */
+  uint32_t size() const;
+
+  /** \brief Get the number of items dropped as the ring was full
+   *
+   * \return Number of items dropped since the ring was created
+   */
+  uint32_t dropped_count() const;
+};
+
+#include "spsc_ring.tpp"
+
+#endif  // SPSC_RING_H_
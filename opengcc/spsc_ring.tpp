@@ -0,0 +1,62 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "hardware/sync.h"
+
+template <typename T, uint capacity>
+bool spsc_ring<T, capacity>::push(const T &item) {
+  uint32_t current_head = head;
+  if (current_head - tail == capacity) {
+    dropped = dropped + 1;
+    return false;
+  }
+
+  items[current_head % capacity] = item;
+
+  // Publish the item before the index which makes it visible
+  __dmb();
+  head = current_head + 1;
+  return true;
+}
+
+template <typename T, uint capacity>
+bool spsc_ring<T, capacity>::pop(T &item) {
+  uint32_t current_tail = tail;
+  if (head == current_tail) {
+    return false;
+  }
+
+  // Don't read the item until the index which published it has been seen
+  __dmb();
+  item = items[current_tail % capacity];
+
+  // Finish reading the item before the producer can reuse its slot
+  __dmb();
+  tail = current_tail + 1;
+  return true;
+}
+
+template <typename T, uint capacity>
+uint32_t spsc_ring<T, capacity>::size() const {
+  return head - tail;
+}
+
+template <typename T, uint capacity>
+uint32_t spsc_ring<T, capacity>::dropped_count() const {
+  return dropped;
+}
@@ -18,15 +18,16 @@
 
 #include "state.hpp"
 
+#include "joybus.hpp"
 #include "pico/multicore.h"
 
 void controller_state::display_alert() {
   multicore_lockout_start_blocking();
-  this->analog_triggers.l_trigger = 255;
-  this->analog_triggers.r_trigger = 255;
+  this->analog_triggers.store({precise_trigger(255), precise_trigger(255)});
+  update_responses();
   busy_wait_ms(1500);
-  this->analog_triggers.l_trigger = 0;
-  this->analog_triggers.r_trigger = 0;
+  this->analog_triggers.store({0, 0});
+  update_responses();
   multicore_lockout_end_blocking();
 }
 
@@ -20,9 +20,11 @@
 #define STATE_H_
 
 #include <array>
+#include <variant>
 
 #include "hardware/pio.h"
 #include "pico/time.h"
+#include "seqlock.hpp"
 
 /** \file state.hpp
  * \brief Controller's volatile state
@@ -85,59 +87,252 @@ constexpr int NUM_COEFFICIENTS = 2;
 constexpr int NUM_COEFFICIENTS = 2;
 #endif
 
-/// \brief Calibration coefficients for x- & y- axis of an analog stick
+/// \brief Number of fractional bits in normalized stick values
+constexpr uint NORMALIZED_FRACTIONAL_BITS = 16;
+
+#if NORMALIZATION_TABLE_BUDGET > 0
+#ifndef STICK_RAW_BITS
+#error "STICK_RAW_BITS must be set by the controller to use normalization tables"
+#endif
+
+/** \brief Number of normalization table index bits which fit in the budget
+ *
+ * Each of the four axes has `2^bits + 1` 4-byte entries, so the tables take
+ * `(2^bits + 1) * 16` bytes in total.
+ *
+ * \return Largest number of index bits, up to `STICK_RAW_BITS`, for which the
+ * tables fit in `NORMALIZATION_TABLE_BUDGET` bytes
+ */
+constexpr uint normalization_table_index_bits() {
+  uint bits = STICK_RAW_BITS;
+  while (bits > 0 &&
+         ((1u << bits) + 1) * sizeof(int32_t) * 4 > NORMALIZATION_TABLE_BUDGET) {
+    --bits;
+  }
+  return bits;
+}
+
+/** \brief Number of bits of a raw axis value used to index its normalization
+ * table
+ *
+ * Remaining low bits interpolate between adjacent entries. When this is
+ * `STICK_RAW_BITS` every raw value has its own entry.
+ */
+constexpr uint NORMALIZATION_TABLE_INDEX_BITS =
+    normalization_table_index_bits();
+
+static_assert(NORMALIZATION_TABLE_INDEX_BITS > 0,
+              "NORMALIZATION_TABLE_BUDGET is too small for any table");
+
+/// \brief Shift from a raw axis value to its normalization table index
+constexpr uint NORMALIZATION_TABLE_SHIFT =
+    STICK_RAW_BITS - NORMALIZATION_TABLE_INDEX_BITS;
+
+/// \brief Number of entries in each normalization table
+constexpr size_t NUM_NORMALIZATION_TABLE_ENTRIES =
+    (1 << NORMALIZATION_TABLE_INDEX_BITS) + 1;
+
+/** \brief Normalized axis values at evenly spaced raw values
+ *
+ * Entry `i` is the normalized value for raw value
+ * `i << NORMALIZATION_TABLE_SHIFT`, with `NORMALIZED_FRACTIONAL_BITS`
+ * fractional bits.
+ */
+using normalization_table =
+    std::array<int32_t, NUM_NORMALIZATION_TABLE_ENTRIES>;
+#endif
+
+/// \brief Number of notches in a stick gate
+constexpr size_t NUM_NOTCHES = 8;
+
+/// \brief Number of fractional bits in octant transform matrices
+constexpr uint OCTANT_MATRIX_FRACTIONAL_BITS = 12;
+
+/** \brief Largest magnitude of an octant transform matrix element
+ *
+ * Keeps notch remapping within 32-bit arithmetic. Notches which would need a
+ * larger transform are too distorted to be genuine, so their octants are left
+ * unchanged.
+ */
+constexpr int32_t OCTANT_MATRIX_ELEMENT_MAX = 2
+                                              << OCTANT_MATRIX_FRACTIONAL_BITS;
+
+/// \brief Octant transform matrix which leaves the octant unchanged
+constexpr std::array<int32_t, 4> OCTANT_IDENTITY_MATRIX = {
+    1 << OCTANT_MATRIX_FRACTIONAL_BITS, 0,
+    0, 1 << OCTANT_MATRIX_FRACTIONAL_BITS};
+
+/** \brief Shift from a normalized displacement to the precision used for notch
+ * remapping
+ */
+constexpr uint OCTANT_DISPLACEMENT_SHIFT = NORMALIZED_FRACTIONAL_BITS - 8;
+
+/** \brief Largest displacement from center used for notch remapping, at
+ * notch remapping precision
+ *
+ * Keeps cross products within 32 bits. Displacements are clamped to the
+ * largest possible range afterwards anyway.
+ */
+constexpr int32_t OCTANT_DISPLACEMENT_MAX =
+    127 << (NORMALIZED_FRACTIONAL_BITS - OCTANT_DISPLACEMENT_SHIFT);
+
+/** \brief Linear remapping of the region between two adjacent notches
+ *
+ * Maps the displacement from center of the first notch onto its target
+ * position, and likewise for the next notch counterclockwise, interpolating
+ * the region between them.
+ */
+struct octant_transform {
+  /** \brief X displacement of the notch the octant starts at, with
+   * `NORMALIZED_FRACTIONAL_BITS - OCTANT_DISPLACEMENT_SHIFT` fractional bits
+   */
+  int32_t start_x;
+  /** \brief Y displacement of the notch the octant starts at, with
+   * `NORMALIZED_FRACTIONAL_BITS - OCTANT_DISPLACEMENT_SHIFT` fractional bits
+   */
+  int32_t start_y;
+  /** \brief Row-major 2x2 transform matrix, with
+   * `OCTANT_MATRIX_FRACTIONAL_BITS` fractional bits
+   */
+  std::array<int32_t, 4> matrix;
+};
+
+/** \brief Calibration coefficients for x- & y- axis of an analog stick
+ *
+ * \note Stored in fixed point, see `convert_to_fixed_point` in
+ * curve_fitting.hpp for the format.
+ */
 struct stick_coefficients {
   /// \brief Coefficients for x-axis for normalization
-  std::array<double, NUM_COEFFICIENTS> x_coefficients;
+  std::array<int64_t, NUM_COEFFICIENTS> x_coefficients;
 
   /// \brief Coefficients for y-axis for normalization
-  std::array<double, NUM_COEFFICIENTS> y_coefficients;
-};
+  std::array<int64_t, NUM_COEFFICIENTS> y_coefficients;
 
-/// \brief Distance from CENTER outside which an axis is eligible to snapback
-constexpr double SNAPBACK_DISTANCE = 40;
+  /// \brief Notch remapping for each octant, counterclockwise from +x
+  std::array<octant_transform, NUM_NOTCHES> octants;
 
-/// \brief Distance from CENTER within which an axis is considered to be centered for snapback purposes
-constexpr uint16_t CENTERED_DISTANCE = 5;
+#if NORMALIZATION_TABLE_BUDGET > 0
+  /// \brief Lookup table for x-axis normalization, built from the coefficients
+  normalization_table x_table;
 
-/** \brief Distance from CENTER within which the other axis can be considered to be crossing the center for snapback purposes
- * 
- * Used to differentiate between, for instance, a stick freely returning to center and a stick being spun around the outer gate
-*/
-constexpr uint16_t CROSSING_DISTANCE = 32;
+  /// \brief Lookup table for y-axis normalization, built from the coefficients
+  normalization_table y_table;
+#endif
+};
 
-/// \brief Default timeout for snapback wave after crossing zero
-constexpr uint64_t DEFAULT_WAVE_DURATION_US = 6500;
+/// \brief Enumeration of snapback filter modes
+enum snapback_mode : uint8_t {
+  wave_snapback,     ///< Hold the axis at center for the duration of a wave
+  velocity_snapback  ///< Cancel the oscillation predicted from its motion
+};
 
-/// \brief Timeout for snapback eligibility when close to zero
-constexpr uint64_t SNAPBACK_ELIGIBILITY_TIMEOUT_US = 5000;
+/** \brief Tunable snapback filter parameters for one stick
+ *
+ * Distances are in output units from CENTER, and times in microseconds, so
+ * behavior is independent of how often the stick is sampled.
+ */
+struct snapback_parameters {
+  /// \brief Filter mode
+  snapback_mode mode;
+  /// \brief Distance outside which an axis is eligible to snapback
+  uint8_t snapback_distance;
+  /// \brief Distance within which an axis is considered to be centered
+  uint8_t centered_distance;
+  /** \brief Distance within which the other axis can be considered to be
+   * crossing the center
+   *
+   * Used to differentiate between, for instance, a stick freely returning to
+   * center and a stick being spun around the outer gate
+   */
+  uint8_t crossing_distance;
+  /// \brief Timeout for a snapback wave after crossing center
+  uint16_t wave_duration_us;
+  /// \brief Timeout for snapback eligibility when close to center
+  uint16_t eligibility_timeout_us;
+  /** \brief How long an axis must be continuously falling during snapback to
+   * enter the falling state
+   */
+  uint16_t falling_time_us;
+  /// \brief Time added to the rise time of a snapback wave to allow it to fall
+  uint16_t wave_duration_buffer_us;
+  /// \brief Period of the stick's free oscillation, for velocity mode
+  uint16_t natural_period_us;
+  /// \brief Damping ratio of the stick's free oscillation in percent, for velocity mode
+  uint8_t damping_percent;
+  /// \brief Time constant for smoothing velocity & acceleration, for velocity mode
+  uint16_t smoothing_us;
+};
 
-/// \brief Number of consecutive falling measurements required during snapback to enter the falling state
-constexpr uint8_t FALLING_COUNT_THRESHOLD = 3;
+/// \brief Default snapback filter parameters
+constexpr snapback_parameters DEFAULT_SNAPBACK_PARAMETERS = {
+    wave_snapback,  // mode
+    40,             // snapback_distance
+    5,              // centered_distance
+    32,             // crossing_distance
+    6500,           // wave_duration_us
+    5000,           // eligibility_timeout_us
+    160,            // falling_time_us, three samples 80 us apart
+    80,             // wave_duration_buffer_us
+    6000,           // natural_period_us
+    20,             // damping_percent
+    100,            // smoothing_us
+};
 
-/// \brief Buffer added to rise time of snapback wave to allow it to fall
-constexpr uint8_t SNAPBACK_WAVE_DURATION_BUFFER = 80;
+/// \brief Whether an axis is eligible to snapback
+struct snapback_eligibility {
+  /// \brief `true` if the axis is eligible to enter snapback, `false` otherwise
+  bool eligible_to_snapback;
+  /// \brief Last timestamp at which the axis was set to be eligible to enter snapback
+  uint32_t last_eligible_to_snapback;
+};
 
-/// \brief Individual axis snapback state
-struct axis_snapback_state {
-  /// \brief Previous displacement of the axis
-  double last_displacement;
+/// \brief Individual axis state for `wave_snapback` mode
+struct wave_snapback_state {
+  /// \brief Snapback eligibility
+  snapback_eligibility eligibility;
+  /// \brief Previous displacement of the axis, in normalized fixed point
+  int32_t last_displacement;
   /// \brief `true` if the axis value is returning to zero during snapback, `false` otherwise
   bool falling;
-  /// \brief Number of consecutive falling measurements
-  uint8_t falling_count;
+  /// \brief `true` if the axis distance has not increased since `decreasing_since`
+  bool decreasing;
+  /// \brief Timestamp of the first sample in the current decreasing run
+  uint32_t decreasing_since;
   /// \brief Timestamp at which the current snapback wave started
-  absolute_time_t wave_started_at;
+  uint32_t wave_started_at;
   /// \brief Timestamp at which the current snapback wave expires
-  absolute_time_t wave_expires_at;
+  uint32_t wave_expires_at;
   /// \brief `true` if the axis is currently in snapback, `false` otherwise
   bool in_snapback;
-  /// \brief `true` if the axis is eligible to enter snapback, `false` otherwise
-  bool eligible_to_snapback;
-  /// \brief Last timestamp at which the axis was set to be eligible to enter snapback
-  absolute_time_t last_eligible_to_snapback;
 };
 
+/** \brief Individual axis state for `velocity_snapback` mode
+ *
+ * \note Motion is tracked with 8 fractional bits, in output units per
+ * millisecond & per millisecond squared.
+ */
+struct velocity_snapback_state {
+  /// \brief Snapback eligibility
+  snapback_eligibility eligibility;
+  /// \brief `true` once a previous sample has been recorded, `false` otherwise
+  bool primed;
+  /// \brief Timestamp of the previous sample
+  uint32_t last_timestamp;
+  /// \brief Previous displacement of the axis
+  int32_t last_displacement;
+  /// \brief Smoothed velocity of the axis
+  int32_t velocity;
+  /// \brief Smoothed acceleration of the axis
+  int32_t acceleration;
+  /// \brief Largest distance from center since becoming eligible to snapback
+  int32_t peak_distance;
+};
+
+/// \brief Individual axis snapback state, for whichever mode is in use
+using axis_snapback_state =
+    std::variant<wave_snapback_state, velocity_snapback_state>;
+
 /// \brief Grouping of axis snapback states for a single analog stick
 struct stick_snapback_state {
   /// \brief X-axis snapback state
@@ -146,12 +341,172 @@ struct stick_snapback_state {
   axis_snapback_state y;
 };
 
-/// \brief Grouping of axes for a single analog stick with full precision
+/** \brief Adaptive stick filter parameters
+ *
+ * The filter is a one euro filter: a low-pass filter whose cutoff frequency
+ * rises with the speed of the stick, so it smooths noise heavily while the
+ * stick is still & barely at all while it's moving quickly.
+ */
+struct stick_filter_parameters {
+  /// \brief `true` to smooth the stick, `false` to pass it through
+  bool enabled;
+  /// \brief Cutoff frequency while the stick is still, in centihertz
+  uint16_t min_cutoff_chz;
+  /** \brief Increase in cutoff frequency per output unit per millisecond of
+   * stick speed, in centihertz
+   */
+  uint16_t beta;
+  /// \brief Cutoff frequency for smoothing the stick speed, in centihertz
+  uint16_t speed_cutoff_chz;
+  /** \brief Distance past a rounding boundary an axis must move before its
+   * output changes, in 256ths of an output unit
+   *
+   * Applied whether or not smoothing is enabled.
+   */
+  uint8_t hysteresis;
+};
+
+/// \brief Default adaptive stick filter parameters
+constexpr stick_filter_parameters DEFAULT_STICK_FILTER_PARAMETERS = {
+    false,  // enabled
+    100,    // min_cutoff_chz
+    5000,   // beta
+    2000,   // speed_cutoff_chz
+    0,      // hysteresis
+};
+
+/** \brief Individual axis state for the adaptive stick filter
+ *
+ * \note Speed has 8 fractional bits, in output units per millisecond.
+ */
+struct axis_filter_state {
+  /// \brief Smoothed axis value, in normalized fixed point
+  int32_t filtered;
+  /// \brief Smoothed speed of the axis
+  int32_t speed;
+  /// \brief Output value last reported, for hysteresis
+  int32_t held_output;
+};
+
+/// \brief Adaptive filter state for a single analog stick
+struct stick_filter_state {
+  /// \brief `true` once a previous sample has been recorded, `false` otherwise
+  bool primed;
+  /// \brief Timestamp of the previous sample
+  uint32_t last_timestamp;
+  /// \brief X-axis filter state
+  axis_filter_state x;
+  /// \brief Y-axis filter state
+  axis_filter_state y;
+};
+
+/// \brief Period of button debounce counters, in microseconds
+constexpr uint32_t DEBOUNCE_TICK_US = 250;
+
+/// \brief Bits of each button's debounce counter
+constexpr uint DEBOUNCE_COUNTER_BITS = 5;
+
+/** \brief Per-button debounce parameters
+ *
+ * A change a button's mode doesn't pass on immediately is only passed on once
+ * the button has stayed in its new state for the configured time. Bounces
+ * back to the previous state restart the wait.
+ */
+struct button_debounce_parameters {
+  /** \brief Buttons whose presses are passed on immediately, rather than once
+   * held for `press_us`
+   */
+  uint16_t eager_press;
+  /** \brief Buttons whose releases are only passed on once released for
+   * `release_us`, rather than immediately
+   */
+  uint16_t defer_release;
+  /// \brief Time a deferred press must be held for, in microseconds
+  uint16_t press_us;
+  /// \brief Time a deferred release must be held for, in microseconds
+  uint16_t release_us;
+};
+
+/// \brief Default button debounce parameters, which pass all changes through
+constexpr button_debounce_parameters DEFAULT_BUTTON_DEBOUNCE_PARAMETERS = {
+    0xFFFF,  // eager_press
+    0x0000,  // defer_release
+    1000,    // press_us
+    2000,    // release_us
+};
+
+/** \brief Button debounce state
+ *
+ * Each button has a counter of the ticks its input has differed from its
+ * output, stored as bit planes so every button is counted at once.
+ */
+struct button_debounce_state {
+  /// \brief Debounced button states
+  uint16_t output;
+  /// \brief Buttons whose input differed from their output at the last update
+  uint16_t pending;
+  /// \brief Bit `i` of each button's counter, for each bit `i`
+  std::array<uint16_t, DEBOUNCE_COUNTER_BITS> counter;
+  /// \brief Time of the most recent tick
+  uint32_t last_tick;
+};
+
+/** \brief Grouping of axes for a single analog stick with full precision
+ *
+ * \note Axes have `NORMALIZED_FRACTIONAL_BITS` fractional bits.
+ */
 struct precise_stick {
   /// \brief X-axis
-  double x;
+  int32_t x;
   /// \brief Y-axis
-  double y;
+  int32_t y;
+};
+
+/// \brief Enumeration of ways stick samples are aggregated between polls
+enum stick_aggregation_mode : uint8_t {
+  latest_aggregation,  ///< Report the newest sample
+  mean_aggregation,    ///< Report the mean of samples, reducing noise
+  extreme_aggregation  ///< Report the furthest sample from center, for flicks
+};
+
+/** \brief Stick samples aggregated since the last poll
+ *
+ * \note Displacements are from center, with
+ * `STICK_AGGREGATION_FRACTIONAL_BITS` fractional bits.
+ */
+struct stick_aggregation_state {
+  /// \brief Poll epoch the samples were taken in
+  uint32_t epoch;
+  /// \brief Number of samples aggregated
+  uint32_t count;
+  /// \brief Sum of X-axis displacements
+  int32_t x_sum;
+  /// \brief Sum of Y-axis displacements
+  int32_t y_sum;
+  /// \brief Squared distance from center of `extreme`, at reduced precision
+  uint32_t extreme_distance;
+  /// \brief Sample furthest from center
+  precise_stick extreme;
+  /// \brief Newest sample
+  precise_stick latest;
+};
+
+/** \brief Calibration, parameters & state used to process a single analog
+ * stick
+ */
+struct stick_context {
+  /// \brief Calibration coefficients
+  const stick_coefficients &coefficients;
+  /// \brief Snapback filter parameters
+  const snapback_parameters &snapback;
+  /// \brief Snapback filter state
+  stick_snapback_state &snapback_state;
+  /// \brief Adaptive filter parameters
+  const stick_filter_parameters &filter;
+  /// \brief Adaptive filter state
+  stick_filter_state &filter_state;
+  /// \brief Maximum range around center
+  uint8_t range;
 };
 
 /// \brief Grouping of axes for a single analog stick after processing
@@ -170,18 +525,66 @@ struct sticks {
   stick r_stick;
 };
 
-/// \brief Grouping of analog triggers
+/// \brief Number of bits in raw & processed trigger values
+constexpr uint TRIGGER_BITS = 12;
+
+/** \brief Number of bits of trigger values below the 8-bit output resolution
+ *
+ * Triggers are processed at full ADC resolution, and only quantized to 8 bits
+ * when encoded for the console.
+ */
+constexpr uint TRIGGER_FRACTIONAL_BITS = TRIGGER_BITS - 8;
+
+/// \brief Largest trigger value
+constexpr uint16_t TRIGGER_MAX = (1 << TRIGGER_BITS) - 1;
+
+/** \brief Convert an 8-bit output trigger value to a full resolution one
+ *
+ * \param output_value Output value
+ *
+ * \return Trigger value which is quantized to `output_value`
+ */
+constexpr uint16_t precise_trigger(uint8_t output_value) {
+  return output_value << TRIGGER_FRACTIONAL_BITS;
+}
+
+/** \brief Quantize a full resolution trigger value to 8 bits for output
+ *
+ * \param trigger_value Trigger value
+ *
+ * \return Nearest output value
+ */
+constexpr uint8_t quantize_trigger(uint16_t trigger_value) {
+  uint32_t rounded = (trigger_value + (1 << (TRIGGER_FRACTIONAL_BITS - 1))) >>
+                     TRIGGER_FRACTIONAL_BITS;
+  return rounded > 255 ? 255 : rounded;
+}
+
+/** \brief Grouping of analog triggers
+ *
+ * \note Values have `TRIGGER_BITS` bits.
+ */
 struct triggers {
   /// \brief state of left trigger
-  uint8_t l_trigger;
+  uint16_t l_trigger;
   /// \brief state of right trigger
-  uint8_t r_trigger;
+  uint16_t r_trigger;
 };
 
 /// \brief Controller state
 struct controller_state {
-  /// \brief State of digital inputs
+  /** \brief State of digital inputs
+   *
+   * \note Not wrapped in a seqlock, as a halfword is always stored and loaded
+   * in one access.
+   */
   uint16_t buttons = 0;
+  /** \brief Time of the latest physical button change reflected in `buttons`,
+   * in microseconds since boot
+   */
+  uint32_t buttons_changed_at = 0;
+  /// \brief Button debounce state
+  button_debounce_state button_debounce = {};
   /// \brief Whether left trigger digital is pressed (post remap)
   bool lt_pressed = false;
   /// \brief Whether right trigger digital is pressed (post remap)
@@ -191,17 +594,17 @@ struct controller_state {
   /// \brief Calibration coefficients for right stick
   stick_coefficients r_stick_coefficients;
   /// \brief State of sticks
-  sticks analog_sticks;
+  seqlock<sticks> analog_sticks;
   /// \brief State of triggers (analog)
-  triggers analog_triggers;
+  seqlock<triggers> analog_triggers;
   /// \brief `true` if origin has not been set, `false` if it has
   bool origin = true;
   /// \brief `false` if stick and trigger centers have not been set, `true` if they have
   bool center_set = false;
   /// \brief Left trigger center value, used to offset readings
-  uint8_t l_trigger_center = 0;
+  uint16_t l_trigger_center = 0;
   /// \brief Right trigger center value, used to offset readings
-  uint8_t r_trigger_center = 0;
+  uint16_t r_trigger_center = 0;
   /// \brief `true` if safe mode is active, `false` if it is not
   bool safe_mode = true;
   /// \brief State of digital inputs of the in-progress combo
@@ -212,6 +615,14 @@ struct controller_state {
   stick_snapback_state l_stick_snapback_state;
   /// \brief Right stick snapback state
   stick_snapback_state r_stick_snapback_state;
+  /// \brief Left stick adaptive filter state
+  stick_filter_state l_stick_filter_state;
+  /// \brief Right stick adaptive filter state
+  stick_filter_state r_stick_filter_state;
+  /// \brief Left stick samples aggregated since the last poll
+  stick_aggregation_state l_stick_aggregation_state = {};
+  /// \brief Right stick samples aggregated since the last poll
+  stick_aggregation_state r_stick_aggregation_state = {};
 
   /// \brief Max out triggers for 1.5 seconds to indicate an alert
   void display_alert();
@@ -222,7 +633,8 @@ struct controller_state {
 
 /** \brief Global state
  * \note Not inherently thread-safe, take care with any state shared between
- * cores.
+ * cores. Analog state is read and written through seqlocks, so a reader never
+ * sees one axis or trigger from a different update than the other.
  */
 extern controller_state state;
 
@@ -0,0 +1,97 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "stick_aggregation.hpp"
+
+#include <algorithm>
+
+// Bits dropped from normalized values when aggregating
+constexpr uint AGGREGATION_SHIFT =
+    NORMALIZED_FRACTIONAL_BITS - STICK_AGGREGATION_FRACTIONAL_BITS;
+
+// Center at aggregation precision
+constexpr int32_t AGGREGATION_CENTER =
+    CENTER << STICK_AGGREGATION_FRACTIONAL_BITS;
+
+// Displacement of an axis from center, at aggregation precision
+int32_t aggregation_displacement(int32_t normalized_axis) {
+  int32_t displacement =
+      (normalized_axis >> AGGREGATION_SHIFT) - AGGREGATION_CENTER;
+  return std::clamp(displacement, -STICK_AGGREGATION_MAX_DISPLACEMENT,
+                    STICK_AGGREGATION_MAX_DISPLACEMENT);
+}
+
+void aggregate_stick(precise_stick normalized_stick, uint32_t epoch,
+                     stick_aggregation_state &aggregation_state) {
+  // Start again each epoch
+  if (aggregation_state.epoch != epoch) {
+    aggregation_state.epoch = epoch;
+    aggregation_state.count = 0;
+    aggregation_state.x_sum = 0;
+    aggregation_state.y_sum = 0;
+    aggregation_state.extreme_distance = 0;
+    aggregation_state.extreme = normalized_stick;
+  }
+
+  int32_t x_displacement = aggregation_displacement(normalized_stick.x);
+  int32_t y_displacement = aggregation_displacement(normalized_stick.y);
+
+  // Saturate the mean once the sums could overflow, while the newest & most
+  // extreme samples are still tracked
+  if (aggregation_state.count < STICK_AGGREGATION_MAX_SAMPLES) {
+    ++aggregation_state.count;
+    aggregation_state.x_sum += x_displacement;
+    aggregation_state.y_sum += y_displacement;
+  }
+  aggregation_state.latest = normalized_stick;
+
+  // Ties keep the earlier sample, so a stick held at the rim doesn't jitter
+  int32_t x_distance = x_displacement >> STICK_AGGREGATION_DISTANCE_SHIFT;
+  int32_t y_distance = y_displacement >> STICK_AGGREGATION_DISTANCE_SHIFT;
+  uint32_t distance = x_distance * x_distance + y_distance * y_distance;
+  if (distance > aggregation_state.extreme_distance) {
+    aggregation_state.extreme_distance = distance;
+    aggregation_state.extreme = normalized_stick;
+  }
+}
+
+precise_stick aggregated_stick(
+    stick_aggregation_mode mode, uint32_t epoch,
+    const stick_aggregation_state &aggregation_state) {
+  if (aggregation_state.epoch != epoch || aggregation_state.count == 0) {
+    return aggregation_state.latest;
+  }
+
+  switch (mode) {
+    case mean_aggregation: {
+      // Round to nearest, then restore center & full precision
+      int32_t count = aggregation_state.count;
+      int32_t x_sum = aggregation_state.x_sum;
+      int32_t y_sum = aggregation_state.y_sum;
+      int32_t x_mean = (x_sum + (x_sum < 0 ? -count : count) / 2) / count;
+      int32_t y_mean = (y_sum + (y_sum < 0 ? -count : count) / 2) / count;
+      return {(x_mean + AGGREGATION_CENTER) * (1 << AGGREGATION_SHIFT),
+              (y_mean + AGGREGATION_CENTER) * (1 << AGGREGATION_SHIFT)};
+    }
+    case extreme_aggregation:
+      return aggregation_state.extreme;
+    case latest_aggregation:
+    default:
+      return aggregation_state.latest;
+  }
+}
@@ -0,0 +1,87 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef STICK_AGGREGATION_H_
+#define STICK_AGGREGATION_H_
+
+#include <pico/types.h>
+
+#include "state.hpp"
+
+/** \file stick_aggregation.hpp
+ * \brief Aggregation of processed stick samples between console polls
+ *
+ * Many samples are processed for each poll, and only one can be reported.
+ * Every processed sample is aggregated until the next poll, which starts a new
+ * poll epoch, and the aggregate is reported:
+ * * `latest_aggregation` reports the newest sample.
+ * * `mean_aggregation` reports the mean of the samples, for less noise.
+ * * `extreme_aggregation` reports the sample furthest from center, so a flick
+ *   out and back between polls is still seen. Near center, this also reports
+ *   the largest excursion of any noise.
+ *
+ * Output hysteresis is applied to the aggregate as it's quantized, so it holds
+ * the value reported rather than each sample.
+ *
+ * Everything is integer arithmetic. Samples are only aggregated on core 1,
+ * and the poll only advances the epoch, so nothing is shared but the epoch.
+ */
+
+/// \brief Fractional bits of aggregated displacements
+constexpr uint STICK_AGGREGATION_FRACTIONAL_BITS = 8;
+
+/// \brief Largest aggregated displacement from center, in each direction
+constexpr int32_t STICK_AGGREGATION_MAX_DISPLACEMENT =
+    256 << STICK_AGGREGATION_FRACTIONAL_BITS;
+
+/** \brief Most samples aggregated in one epoch
+ *
+ * Keeps displacement sums within 32 bits. Once reached, the mean is of the
+ * first samples of the epoch, while the newest & most extreme samples are
+ * still tracked.
+ */
+constexpr uint32_t STICK_AGGREGATION_MAX_SAMPLES = 4096;
+
+/** \brief Bits dropped from displacements when comparing distances from
+ * center, keeping squared distances within 32 bits
+ */
+constexpr uint STICK_AGGREGATION_DISTANCE_SHIFT = 4;
+
+/** \brief Aggregate a processed stick sample
+ *
+ * \param normalized_stick Processed stick, before quantization
+ * \param epoch Current poll epoch
+ * \param aggregation_state Aggregation state for the stick
+ */
+void aggregate_stick(precise_stick normalized_stick, uint32_t epoch,
+                     stick_aggregation_state &aggregation_state);
+
+/** \brief Get the aggregate of the samples in the current poll epoch
+ *
+ * \param mode Aggregation mode
+ * \param epoch Current poll epoch
+ * \param aggregation_state Aggregation state for the stick
+ *
+ * \return Aggregated stick, or the newest sample if none were taken this
+ * epoch
+ */
+precise_stick aggregated_stick(
+    stick_aggregation_mode mode, uint32_t epoch,
+    const stick_aggregation_state &aggregation_state);
+
+#endif  // STICK_AGGREGATION_H_
@@ -0,0 +1,111 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "stick_filter.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+precise_stick filter_stick(precise_stick normalized_stick, uint32_t timestamp,
+                           const stick_filter_parameters &parameters,
+                           stick_filter_state &filter_state) {
+  precise_stick filtered_stick = normalized_stick;
+
+  if (parameters.enabled) {
+    // Restart the filter after a gap
+    uint32_t elapsed = timestamp - filter_state.last_timestamp;
+    if (!filter_state.primed || elapsed == 0 ||
+        elapsed > STICK_FILTER_MAX_SAMPLE_GAP_US) {
+      filter_state.x.filtered = normalized_stick.x;
+      filter_state.x.speed = 0;
+      filter_state.y.filtered = normalized_stick.y;
+      filter_state.y.speed = 0;
+    } else {
+      filtered_stick.x =
+          smooth_axis(normalized_stick.x, elapsed, parameters, filter_state.x);
+      filtered_stick.y =
+          smooth_axis(normalized_stick.y, elapsed, parameters, filter_state.y);
+    }
+    filter_state.primed = true;
+    filter_state.last_timestamp = timestamp;
+  }
+
+  return filtered_stick;
+}
+
+precise_stick hold_stick(precise_stick normalized_stick,
+                         const stick_filter_parameters &parameters,
+                         stick_filter_state &filter_state) {
+  return {apply_hysteresis(normalized_stick.x, parameters.hysteresis,
+                           filter_state.x.held_output),
+          apply_hysteresis(normalized_stick.y, parameters.hysteresis,
+                           filter_state.y.held_output)};
+}
+
+int32_t smooth_axis(int32_t normalized_axis, uint32_t elapsed,
+                    const stick_filter_parameters &parameters,
+                    axis_filter_state &axis_state) {
+  // How far the smoothed value lags behind grows with speed, so it stands in
+  // for speed. It's taken as the distance covered in a millisecond rather than
+  // in one sample, so a movement raises the cutoff equally at any sample rate.
+  constexpr uint speed_shift = NORMALIZED_FRACTIONAL_BITS - 8;
+  int32_t speed = (normalized_axis - axis_state.filtered) >> speed_shift;
+  speed = std::clamp(speed, -STICK_FILTER_SPEED_MAX, STICK_FILTER_SPEED_MAX);
+  int32_t speed_weight = smoothing_weight(elapsed, parameters.speed_cutoff_chz);
+  axis_state.speed +=
+      (static_cast<int64_t>(speed - axis_state.speed) * speed_weight) >> 16;
+
+  // Raise the cutoff frequency with speed
+  uint64_t cutoff_chz =
+      parameters.min_cutoff_chz +
+      ((static_cast<uint64_t>(abs(axis_state.speed)) * parameters.beta) >> 8);
+  int32_t weight = smoothing_weight(
+      elapsed, std::min<uint64_t>(cutoff_chz, STICK_FILTER_MAX_CUTOFF_CHZ));
+  axis_state.filtered +=
+      (static_cast<int64_t>(normalized_axis - axis_state.filtered) * weight) >>
+      16;
+
+  return axis_state.filtered;
+}
+
+int32_t apply_hysteresis(int32_t normalized_axis, uint8_t hysteresis,
+                         int32_t &held_output) {
+  // Half an output unit is the usual rounding boundary, so no hysteresis
+  // behaves exactly like rounding
+  int32_t threshold = (1 << (NORMALIZED_FRACTIONAL_BITS - 1)) +
+                      (hysteresis << (NORMALIZED_FRACTIONAL_BITS - 8));
+  int32_t held_axis = held_output << NORMALIZED_FRACTIONAL_BITS;
+  if (abs(normalized_axis - held_axis) < threshold) {
+    return held_axis;
+  }
+
+  held_output = (normalized_axis + (1 << (NORMALIZED_FRACTIONAL_BITS - 1))) >>
+                NORMALIZED_FRACTIONAL_BITS;
+  return normalized_axis;
+}
+
+int32_t smoothing_weight(uint32_t elapsed, uint32_t cutoff_chz) {
+  if (cutoff_chz == 0) {
+    return 0;
+  }
+
+  // Time constant of the filter, 1 / (2 pi f), in microseconds
+  uint32_t time_constant_us = 15915494 / cutoff_chz;
+
+  return (elapsed << 16) / (elapsed + time_constant_us);
+}
@@ -0,0 +1,116 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef STICK_FILTER_H_
+#define STICK_FILTER_H_
+
+#include <pico/types.h>
+
+#include "state.hpp"
+
+/** \file stick_filter.hpp
+ * \brief Adaptive stick smoothing & output hysteresis
+ *
+ * Sensor noise near a rounding boundary makes the reported coordinate flicker
+ * between polls. Two stages suppress it:
+ * * A one euro filter, which smooths heavily while an axis is slow & barely at
+ *   all while it's fast, so noise is removed without adding noticeable
+ *   latency to deliberate movements. It runs on every sample.
+ * * Hysteresis, which only changes the output of an axis once it has moved
+ *   some distance past the rounding boundary. It runs on the value to be
+ *   reported, after samples are aggregated, so aggregation can't move the
+ *   report off a held value.
+ *
+ * Everything is integer arithmetic, and based on sample timestamps rather than
+ * sample counts.
+ */
+
+/** \brief Longest gap between samples used for smoothing, in microseconds
+ *
+ * Longer gaps restart the filter, which also keeps the arithmetic within 32
+ * bits.
+ */
+constexpr uint32_t STICK_FILTER_MAX_SAMPLE_GAP_US = 20000;
+
+/// \brief Highest cutoff frequency, in centihertz
+constexpr uint32_t STICK_FILTER_MAX_CUTOFF_CHZ = 1000000;
+
+/// \brief Largest stick speed magnitude
+constexpr int32_t STICK_FILTER_SPEED_MAX = 1 << 22;
+
+/** \brief Smooth a stick
+ *
+ * \param normalized_stick Normalized stick
+ * \param timestamp Time the stick was sampled, in microseconds since boot
+ * \param parameters Adaptive filter parameters for the stick
+ * \param filter_state Current filter state for the stick
+ *
+ * \return Smoothed stick
+ */
+precise_stick filter_stick(precise_stick normalized_stick, uint32_t timestamp,
+                           const stick_filter_parameters &parameters,
+                           stick_filter_state &filter_state);
+
+/** \brief Apply hysteresis to a stick about to be reported
+ *
+ * \param normalized_stick Stick to be reported, before quantization
+ * \param parameters Adaptive filter parameters for the stick
+ * \param filter_state Current filter state for the stick
+ *
+ * \return Stick with each axis held at its previous output where it should be
+ */
+precise_stick hold_stick(precise_stick normalized_stick,
+                         const stick_filter_parameters &parameters,
+                         stick_filter_state &filter_state);
+
+/** \brief Smooth an axis with a one euro filter
+ *
+ * \param normalized_axis Normalized axis value
+ * \param elapsed Time since the previous sample, in microseconds
+ * \param parameters Adaptive filter parameters for the stick
+ * \param axis_state Filter state for this axis
+ *
+ * \return Smoothed axis value
+ */
+int32_t smooth_axis(int32_t normalized_axis, uint32_t elapsed,
+                    const stick_filter_parameters &parameters,
+                    axis_filter_state &axis_state);
+
+/** \brief Hold an axis at its previous output value unless it has moved far
+ * enough past a rounding boundary
+ *
+ * \param normalized_axis Normalized axis value
+ * \param hysteresis Distance past the rounding boundary needed to change the
+ * output, in 256ths of an output unit
+ * \param held_output Output value last reported
+ *
+ * \return `normalized_axis`, or exactly `held_output` if it should be held
+ */
+int32_t apply_hysteresis(int32_t normalized_axis, uint8_t hysteresis,
+                         int32_t &held_output);
+
+/** \brief Weight given to a new sample by a first order low-pass filter
+ *
+ * \param elapsed Time since the previous sample, in microseconds
+ * \param cutoff_chz Cutoff frequency, in centihertz
+ *
+ * \return Weight, with 16 fractional bits
+ */
+int32_t smoothing_weight(uint32_t elapsed, uint32_t cutoff_chz);
+
+#endif  // STICK_FILTER_H_
@@ -0,0 +1,182 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef STICK_PIPELINE_H_
+#define STICK_PIPELINE_H_
+
+#include <pico/types.h>
+
+#include <type_traits>
+
+#include "analog_controller.hpp"
+#include "state.hpp"
+
+/** \file stick_pipeline.hpp
+ * \brief Stick processing composed from stages at compile time
+ *
+ * Each stage is a type with a static function, so a pipeline is a chain of
+ * direct calls which the compiler can inline, and a stage left out of a
+ * pipeline costs nothing. Stages come in three kinds:
+ * * Normalization, with `static precise_stick normalize(raw_stick, const
+ *   stick_context &)`, turns raw sensor values into normalized values.
+ * * Remapping, with `static precise_stick apply(precise_stick, uint32_t,
+ *   stick_context &)`, transforms normalized values, given the time the
+ *   sample was taken.
+ * * Quantization, with `static stick quantize(precise_stick, stick_context
+ *   &)`, produces the values reported to the console from the aggregate of
+ *   the processed samples.
+ *
+ * Controllers choose which remapping stages run with the `NOTCH_REMAPPING`,
+ * `SNAPBACK_FILTER` & `ADAPTIVE_FILTER` definitions, each enabled unless set
+ * to 0. Normalization uses lookup tables when `NORMALIZATION_TABLE_BUDGET` is
+ * set, and the calibration polynomial otherwise.
+ */
+
+#ifndef NOTCH_REMAPPING
+#define NOTCH_REMAPPING 1
+#endif
+
+#ifndef SNAPBACK_FILTER
+#define SNAPBACK_FILTER 1
+#endif
+
+#ifndef ADAPTIVE_FILTER
+#define ADAPTIVE_FILTER 1
+#endif
+
+/// \brief Normalization by evaluating the calibration polynomial
+struct polynomial_normalization {
+  static precise_stick normalize(raw_stick stick_data,
+                                 const stick_context &context);
+};
+
+#if NORMALIZATION_TABLE_BUDGET > 0
+/// \brief Normalization by interpolating the calibration lookup tables
+struct table_normalization {
+  static precise_stick normalize(raw_stick stick_data,
+                                 const stick_context &context);
+};
+#endif
+
+/// \brief Remapping stage which leaves the stick unchanged
+struct passthrough_stage {
+  static precise_stick apply(precise_stick normalized_stick,
+                             uint32_t timestamp, stick_context &context);
+};
+
+/// \brief Remapping of calibrated notches to their targets
+struct notch_remapping {
+  static precise_stick apply(precise_stick normalized_stick,
+                             uint32_t timestamp, stick_context &context);
+};
+
+/// \brief Snapback filtering
+struct snapback_filtering {
+  static precise_stick apply(precise_stick normalized_stick,
+                             uint32_t timestamp, stick_context &context);
+};
+
+/// \brief Adaptive smoothing
+struct adaptive_filtering {
+  static precise_stick apply(precise_stick normalized_stick,
+                             uint32_t timestamp, stick_context &context);
+};
+
+/// \brief Quantization by rounding & clamping to the stick range
+struct round_and_clamp_quantization {
+  static stick quantize(precise_stick normalized_stick,
+                        stick_context &context);
+};
+
+/** \brief Output hysteresis, then quantization by rounding & clamping to the
+ * stick range
+ */
+struct hysteresis_quantization {
+  static stick quantize(precise_stick normalized_stick,
+                        stick_context &context);
+};
+
+/** \brief Stick processing pipeline
+ *
+ * \tparam normalization Normalization stage
+ * \tparam quantization Quantization stage
+ * \tparam stages Remapping stages, applied in order
+ */
+template <typename normalization, typename quantization, typename... stages>
+struct stick_pipeline {
+  /** \brief Run a raw sample through every stage
+   *
+   * \param stick_data Raw stick sample
+   * \param context Calibration, parameters & state for the stick
+   *
+   * \return Stick data for use in state
+   */
+  static stick process(raw_stick stick_data, stick_context &context);
+
+  /** \brief Run a raw sample through every stage but quantization
+   *
+   * \param stick_data Raw stick sample
+   * \param context Calibration, parameters & state for the stick
+   *
+   * \return Processed stick, before quantization
+   */
+  static precise_stick process_precise(raw_stick stick_data,
+                                       stick_context &context);
+
+  /** \brief Quantize a processed stick for use in state
+   *
+   * \param normalized_stick Processed stick
+   * \param context Calibration, parameters & state for the stick
+   *
+   * \return Stick data for use in state
+   */
+  static stick quantize(precise_stick normalized_stick,
+                        stick_context &context);
+};
+
+/** \brief A remapping stage, or `passthrough_stage` if disabled
+ *
+ * \tparam enabled Whether the stage is used
+ * \tparam stage Remapping stage
+ */
+template <bool enabled, typename stage>
+using optional_stage = std::conditional_t<enabled, stage, passthrough_stage>;
+
+#if NORMALIZATION_TABLE_BUDGET > 0
+/// \brief Normalization stage used by the firmware
+using configured_normalization = table_normalization;
+#else
+/// \brief Normalization stage used by the firmware
+using configured_normalization = polynomial_normalization;
+#endif
+
+/// \brief Quantization stage used by the firmware
+using configured_quantization =
+    std::conditional_t<ADAPTIVE_FILTER, hysteresis_quantization,
+                       round_and_clamp_quantization>;
+
+/// \brief Stick processing pipeline used by the firmware
+using configured_stick_pipeline =
+    stick_pipeline<configured_normalization, configured_quantization,
+                   optional_stage<NOTCH_REMAPPING, notch_remapping>,
+                   optional_stage<SNAPBACK_FILTER, snapback_filtering>,
+                   optional_stage<ADAPTIVE_FILTER, adaptive_filtering>>;
+
+#include "stick_pipeline.tpp"
+
+#endif  // STICK_PIPELINE_H_
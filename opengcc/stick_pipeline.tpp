@@ -0,0 +1,99 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "main.hpp"
+#include "snapback.hpp"
+#include "stick_filter.hpp"
+
+inline precise_stick polynomial_normalization::normalize(
+    raw_stick stick_data, const stick_context &context) {
+  return {normalize_axis(stick_data.x, context.coefficients.x_coefficients),
+          normalize_axis(stick_data.y, context.coefficients.y_coefficients)};
+}
+
+#if NORMALIZATION_TABLE_BUDGET > 0
+inline precise_stick table_normalization::normalize(
+    raw_stick stick_data, const stick_context &context) {
+  return {normalize_axis(stick_data.x, context.coefficients.x_table),
+          normalize_axis(stick_data.y, context.coefficients.y_table)};
+}
+#endif
+
+inline precise_stick passthrough_stage::apply(precise_stick normalized_stick,
+                                              uint32_t, stick_context &) {
+  return normalized_stick;
+}
+
+inline precise_stick notch_remapping::apply(precise_stick normalized_stick,
+                                            uint32_t, stick_context &context) {
+  return remap_notches(normalized_stick, context.coefficients.octants);
+}
+
+inline precise_stick snapback_filtering::apply(precise_stick normalized_stick,
+                                               uint32_t timestamp,
+                                               stick_context &context) {
+  return unsnap_stick(normalized_stick, timestamp, context.snapback,
+                      context.snapback_state);
+}
+
+inline precise_stick adaptive_filtering::apply(precise_stick normalized_stick,
+                                               uint32_t timestamp,
+                                               stick_context &context) {
+  return filter_stick(normalized_stick, timestamp, context.filter,
+                      context.filter_state);
+}
+
+inline stick round_and_clamp_quantization::quantize(
+    precise_stick normalized_stick, stick_context &context) {
+  return {round_and_clamp_axis(normalized_stick.x, CENTER - context.range,
+                               CENTER + context.range),
+          round_and_clamp_axis(normalized_stick.y, CENTER - context.range,
+                               CENTER + context.range)};
+}
+
+inline stick hysteresis_quantization::quantize(precise_stick normalized_stick,
+                                               stick_context &context) {
+  return round_and_clamp_quantization::quantize(
+      hold_stick(normalized_stick, context.filter, context.filter_state),
+      context);
+}
+
+template <typename normalization, typename quantization, typename... stages>
+stick stick_pipeline<normalization, quantization, stages...>::process(
+    raw_stick stick_data, stick_context &context) {
+  return quantize(process_precise(stick_data, context), context);
+}
+
+template <typename normalization, typename quantization, typename... stages>
+precise_stick
+stick_pipeline<normalization, quantization, stages...>::process_precise(
+    raw_stick stick_data, stick_context &context) {
+  precise_stick normalized_stick =
+      normalization::normalize(stick_data, context);
+  ((normalized_stick =
+        stages::apply(normalized_stick, stick_data.timestamp, context)),
+   ...);
+
+  return normalized_stick;
+}
+
+template <typename normalization, typename quantization, typename... stages>
+stick stick_pipeline<normalization, quantization, stages...>::quantize(
+    precise_stick normalized_stick, stick_context &context) {
+  return quantization::quantize(normalized_stick, context);
+}
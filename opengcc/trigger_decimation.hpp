@@ -0,0 +1,109 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef TRIGGER_DECIMATION_H_
+#define TRIGGER_DECIMATION_H_
+
+#include <pico/types.h>
+
+#include <array>
+
+#include "analog_controller.hpp"
+
+/** \file trigger_decimation.hpp
+ * \brief Decimation of a DMA ring of trigger samples into one value per
+ * trigger
+ *
+ * The ADC converts both triggers round robin, and DMA writes the conversions
+ * into a ring of `TRIGGER_OVERSAMPLING` samples per trigger, interleaved left
+ * then right. Whenever the triggers are read, the ring is decimated with the
+ * filter chosen by `TRIGGER_DECIMATION`:
+ * * `BOXCAR` takes the mean of every sample in the ring.
+ * * `CIC` takes the output of a second order CIC filter with a decimation
+ *   ratio of half the ring, which weighs the most recent
+ *   `TRIGGER_OVERSAMPLING - 1` samples of each trigger with a triangular
+ *   window. Its sidelobes are lower than those of `BOXCAR`, so it attenuates
+ *   interference far above the output rate more, at the cost of slightly more
+ *   white noise for the same ring.
+ */
+
+/// \brief Number of samples of both triggers in the ring
+constexpr uint TRIGGER_RING_ENTRIES = 2 * TRIGGER_OVERSAMPLING;
+
+/// \brief Size of the ring in bytes, which it must also be aligned to
+constexpr uint TRIGGER_RING_BYTES = TRIGGER_RING_ENTRIES * sizeof(uint16_t);
+
+/// \brief Size of the ring as a power of two, for DMA address wrapping
+constexpr uint TRIGGER_RING_SIZE_BITS = __builtin_ctz(TRIGGER_RING_BYTES);
+
+/** \brief Number of transfers for each DMA channel writing the ring
+ *
+ * This is a multiple of the ring size, so that the samples of each trigger
+ * stay at the same parity when a channel chains to the next.
+ */
+constexpr uint32_t TRIGGER_RING_TRANSFER_COUNT =
+    0xFFFFFFFF - (0xFFFFFFFF % TRIGGER_RING_ENTRIES);
+
+static_assert((TRIGGER_OVERSAMPLING & (TRIGGER_OVERSAMPLING - 1)) == 0,
+              "TRIGGER_OVERSAMPLING must be a power of two");
+static_assert(TRIGGER_RING_SIZE_BITS <= 15,
+              "TRIGGER_OVERSAMPLING is too large for DMA address wrapping");
+#if TRIGGER_DECIMATION == CIC
+static_assert(TRIGGER_OVERSAMPLING >= 2,
+              "CIC decimation requires TRIGGER_OVERSAMPLING of at least 2");
+#endif
+
+/// \brief Ring of interleaved trigger samples written by DMA
+using trigger_sample_ring = std::array<uint16_t, TRIGGER_RING_ENTRIES>;
+
+/** \brief Decimate the samples of one trigger in a ring with the
+ * `TRIGGER_DECIMATION` filter
+ *
+ * \note DMA may overwrite samples while they are being read. This only moves
+ * a sample between the oldest & newest positions of the window, which doesn't
+ * matter for `BOXCAR`, and misweighs one sample for `CIC`.
+ *
+ * \tparam depth Number of samples of each trigger in the ring
+ *
+ * \param ring Ring of `2 * depth` interleaved samples
+ * \param trigger Trigger to decimate, 0 for left or 1 for right
+ * \param next Index of the entry DMA will write next
+ *
+ * \return Decimated trigger value
+ */
+template <uint depth>
+uint16_t decimate_trigger_samples(const volatile uint16_t *ring, uint trigger,
+                                  uint next);
+
+/** \brief Decimate both triggers in a ring
+ *
+ * \param ring Ring written by DMA
+ * \param next Index of the entry DMA will write next
+ *
+ * \return Decimated trigger values
+ */
+inline raw_triggers decimate_triggers(const trigger_sample_ring &ring,
+                                      uint next) {
+  const volatile uint16_t *samples = ring.data();
+  return {decimate_trigger_samples<TRIGGER_OVERSAMPLING>(samples, 0, next),
+          decimate_trigger_samples<TRIGGER_OVERSAMPLING>(samples, 1, next)};
+}
+
+#include "trigger_decimation.tpp"
+
+#endif  // TRIGGER_DECIMATION_H_
@@ -0,0 +1,57 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include <cstdint>
+#include <type_traits>
+
+template <uint depth>
+uint16_t decimate_trigger_samples(const volatile uint16_t *ring, uint trigger,
+                                  uint next) {
+  constexpr uint entries = 2 * depth;
+
+  // Oldest sample of the trigger, the first one at its parity from `next`
+  uint oldest = next + ((trigger - next) & 1);
+
+#if TRIGGER_DECIMATION == CIC
+  // The impulse response of a second order CIC filter with a decimation ratio
+  // of R is a triangle 2R - 1 samples wide, with a gain of R^2
+  constexpr uint ratio = depth / 2;
+  constexpr uint gain = ratio * ratio;
+  using accumulator =
+      std::conditional_t<(uint64_t{UINT16_MAX} * gain <= UINT32_MAX), uint32_t,
+                         uint64_t>;
+
+  // The oldest sample falls outside the triangle
+  accumulator sum = 0;
+  for (uint i = 1; i < depth; ++i) {
+    uint weight = i <= ratio ? i : depth - i;
+    sum += static_cast<accumulator>(weight) *
+           ring[(oldest + (2 * i)) & (entries - 1)];
+  }
+#else
+  constexpr uint gain = depth;
+  using accumulator = uint32_t;
+
+  accumulator sum = 0;
+  for (uint i = 0; i < depth; ++i) {
+    sum += ring[(oldest + (2 * i)) & (entries - 1)];
+  }
+#endif
+
+  return (sum + (gain / 2)) / gain;
+}
@@ -0,0 +1,117 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "trigger_transfer.hpp"
+
+#include <algorithm>
+
+#include "hardware/sync.h"
+
+std::array<trigger_transfers, 2> trigger_transfer_buffers = {};
+trigger_transfers *volatile published_trigger_transfers =
+    &trigger_transfer_buffers[0];
+volatile uint32_t trigger_transfers_generation = 0;
+
+trigger_transfer compile_trigger_transfer(trigger_mode mode,
+                                          uint8_t configured_value,
+                                          bool enable_analog) {
+  trigger_transfer transfer = {};
+  uint32_t precise_configured_value = precise_trigger(configured_value);
+
+  for (uint point = 0; point < TRIGGER_TRANSFER_POINTS; ++point) {
+    uint32_t input = point * TRIGGER_TRANSFER_STEP;
+
+    // Output scaled by `numerator / denominator`, rounded up into the
+    // fractional bits so interpolation never falls just short of an integer
+    uint64_t numerator = 0;
+    uint32_t denominator = 1;
+    switch (mode) {
+      case digital_only:
+        break;
+      case both:
+      case analog_only:
+        numerator = input;
+        break;
+      case capped_analog:
+        numerator = std::min(input, precise_configured_value);
+        break;
+      case analog_on_digital:
+      case both_on_digital:
+        numerator = precise_configured_value;
+        break;
+      case multiplied_analog:
+        numerator = input * (configured_value + TRIGGER_MULTIPLIER_OFFSET);
+        denominator = TRIGGER_MULTIPLIER_DIVISOR;
+        break;
+    }
+
+    numerator = (numerator << TRIGGER_TRANSFER_FRACTIONAL_BITS) * enable_analog;
+    transfer.curve[point] = (numerator + denominator - 1) / denominator;
+  }
+
+  transfer.on_digital = mode == analog_on_digital || mode == both_on_digital;
+
+  return transfer;
+}
+
+void compile_trigger_transfers(controller_configuration &config) {
+  // Build in whichever buffer isn't published
+  trigger_transfers *transfers = published_trigger_transfers;
+  transfers = transfers == &trigger_transfer_buffers[0]
+                  ? &trigger_transfer_buffers[1]
+                  : &trigger_transfer_buffers[0];
+
+  // A reader which took that buffer before it was last unpublished may still
+  // be reading it, so make sure it sees a new generation before it's changed
+  trigger_transfers_generation = trigger_transfers_generation + 1;
+  __dmb();
+
+  transfers->l_trigger = compile_trigger_transfer(
+      config.l_trigger_mode(), config.l_trigger_configured_value(),
+      config.mapping(LT_DIGITAL) == LT_DIGITAL);
+  transfers->r_trigger = compile_trigger_transfer(
+      config.r_trigger_mode(), config.r_trigger_configured_value(),
+      config.mapping(RT_DIGITAL) == RT_DIGITAL);
+
+  // Make sure the whole set is written before it's published
+  __dmb();
+  published_trigger_transfers = transfers;
+}
+
+triggers apply_trigger_transfers(uint16_t l_trigger, uint16_t r_trigger,
+                                 bool l_digital, bool r_digital) {
+  triggers out;
+  uint32_t generation;
+  do {
+    // The generation is read before the buffer is taken, so any compile which
+    // could reuse the buffer changes it
+    generation = trigger_transfers_generation;
+    __dmb();
+    const trigger_transfers *transfers = published_trigger_transfers;
+    __dmb();
+
+    out.l_trigger =
+        apply_trigger_transfer(transfers->l_trigger, l_trigger, l_digital);
+    out.r_trigger =
+        apply_trigger_transfer(transfers->r_trigger, r_trigger, r_digital);
+
+    __dmb();
+  } while (generation != trigger_transfers_generation);
+
+  return out;
+}
@@ -0,0 +1,141 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef TRIGGER_TRANSFER_H_
+#define TRIGGER_TRANSFER_H_
+
+#include <pico/types.h>
+
+#include <array>
+
+#include "configuration.hpp"
+#include "state.hpp"
+
+/** \file trigger_transfer.hpp
+ * \brief Analog trigger modes compiled into lookup tables
+ *
+ * Whenever the profile changes or a configuration is saved, the trigger mode,
+ * configured value & mapping of each trigger are compiled into a transfer
+ * curve. Each trigger sample is then a lookup into its curve, rather than a
+ * switch over the mode.
+ *
+ * Curves have a point at every `TRIGGER_TRANSFER_STEP` input values, and are
+ * interpolated in between. Every mode is linear between the points, and the
+ * points hold outputs with `TRIGGER_TRANSFER_FRACTIONAL_BITS` fractional
+ * bits, rounded up, so interpolated outputs exactly match evaluating the mode
+ * directly for every input.
+ *
+ * Compiled transfers are double buffered. A new set is built in the buffer
+ * not published, then published with a single pointer store. The analog core
+ * may still be reading the other buffer when it's reused, so every compile
+ * first advances a generation, and readers retry if it changed while they
+ * read. Compiling never waits on the analog core, which may not be running
+ * yet, or be locked out by the configuration menus.
+ */
+
+/// \brief Input values between points on a transfer curve
+constexpr uint TRIGGER_TRANSFER_STEP = 1 << TRIGGER_FRACTIONAL_BITS;
+
+/// \brief Number of points on a transfer curve
+constexpr uint TRIGGER_TRANSFER_POINTS =
+    (TRIGGER_MAX + 1) / TRIGGER_TRANSFER_STEP + 1;
+
+/// \brief Fractional bits of transfer curve points
+constexpr uint TRIGGER_TRANSFER_FRACTIONAL_BITS = 16;
+
+/// \brief Trigger mode of a single trigger, compiled into a curve
+struct trigger_transfer {
+  /** \brief Output at every `TRIGGER_TRANSFER_STEP` input values
+   *
+   * \note Not limited to `TRIGGER_MAX`, so the kink where an output saturates
+   * needn't fall on a point.
+   */
+  std::array<uint32_t, TRIGGER_TRANSFER_POINTS> curve;
+
+  /// \brief Whether analog output is only sent while digital is pressed
+  bool on_digital;
+};
+
+/// \brief Trigger modes of the current profile, compiled
+struct trigger_transfers {
+  /// \brief Left trigger transfer
+  trigger_transfer l_trigger;
+
+  /// \brief Right trigger transfer
+  trigger_transfer r_trigger;
+};
+
+/** \brief Compile the trigger mode of a single trigger
+ *
+ * \param mode Trigger mode
+ * \param configured_value Configured value, in 8-bit output units
+ * \param enable_analog Whether analog output is enabled
+ *
+ * \return Compiled transfer
+ */
+trigger_transfer compile_trigger_transfer(trigger_mode mode,
+                                          uint8_t configured_value,
+                                          bool enable_analog);
+
+/** \brief Compile the trigger modes of the current profile, and publish them
+ *
+ * \note Must only be called from core 0.
+ *
+ * \param config Configuration to compile from
+ */
+void compile_trigger_transfers(controller_configuration &config);
+
+/** \brief Apply a compiled trigger mode to an analog trigger value
+ *
+ * \param transfer Compiled trigger mode
+ * \param analog_value Analog trigger value, with `TRIGGER_BITS` bits
+ * \param digital_value Digital value for this trigger
+ *
+ * \return Analog value after applying the trigger mode, with `TRIGGER_BITS`
+ * bits
+ */
+inline uint16_t apply_trigger_transfer(const trigger_transfer &transfer,
+                                       uint16_t analog_value,
+                                       bool digital_value) {
+  uint point = analog_value / TRIGGER_TRANSFER_STEP;
+  uint32_t offset = analog_value % TRIGGER_TRANSFER_STEP;
+  uint32_t from = transfer.curve[point];
+  uint32_t to = transfer.curve[point + 1];
+
+  uint32_t out = (from + (((to - from) * offset) / TRIGGER_TRANSFER_STEP)) >>
+                 TRIGGER_TRANSFER_FRACTIONAL_BITS;
+  if (out > TRIGGER_MAX) {
+    out = TRIGGER_MAX;
+  }
+
+  return out * (digital_value || !transfer.on_digital);
+}
+
+/** \brief Apply the most recently published trigger modes to both triggers
+ *
+ * \param l_trigger Left analog trigger value, with `TRIGGER_BITS` bits
+ * \param r_trigger Right analog trigger value, with `TRIGGER_BITS` bits
+ * \param l_digital Digital value for the left trigger
+ * \param r_digital Digital value for the right trigger
+ *
+ * \return Analog values after applying the trigger modes
+ */
+triggers apply_trigger_transfers(uint16_t l_trigger, uint16_t r_trigger,
+                                 bool l_digital, bool r_digital);
+
+#endif  // TRIGGER_TRANSFER_H_
@@ -0,0 +1,125 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include "console_simulator.hpp"
+
+#include <cstdio>
+
+#include "hardware/pio.h"
+#include "host_sdk.hpp"
+#include "joybus.hpp"
+
+std::string command_name(uint8_t cmd) {
+  switch (cmd) {
+    case 0x00:
+      return "identify";
+    case 0xFF:
+      return "reset";
+    case 0x40:
+      return "poll";
+    case 0x41:
+      return "origin";
+    case 0x42:
+      return "calibrate";
+    case 0x43:
+      return "long poll";
+    default:
+      return "unknown";
+  }
+}
+
+console_simulator::console_simulator(const console_timing &timing)
+    : timing(timing) {
+  joybus_init(pio0, JOYBUS_IN_PIN, JOYBUS_OUT_PIN);
+
+  // Joybus only uses the first state machine's FIFOs
+  rx_channel = host_dma_channel_for(&pio0->rxf[0]);
+  tx_channel = host_dma_channel_for(&pio0->txf[0]);
+}
+
+void console_simulator::set_timing(const console_timing &new_timing) {
+  timing = new_timing;
+}
+
+void console_simulator::set_background(std::function<void()> work) {
+  background = work;
+}
+
+void console_simulator::advance(uint32_t us) {
+  if (background) {
+    background();
+  }
+  host_advance_time_us(us);
+}
+
+std::vector<uint8_t> console_simulator::send(
+    const std::vector<uint8_t> &bytes) {
+  uint64_t start_ns = host_interrupt_ns();
+
+  for (uint8_t byte : bytes) {
+    advance(timing.command_byte_us);
+    host_dma_transfer(rx_channel, byte);
+  }
+  advance(timing.stop_bit_us);
+
+  // Each byte is taken from the response buffer just before it's sent, so
+  // the response must not change while being transmitted
+  std::vector<uint8_t> response;
+  while (host_dma(tx_channel).busy) {
+    response.push_back(host_dma_transfer(tx_channel));
+    advance(timing.response_byte_us);
+  }
+  if (!response.empty()) {
+    advance(timing.response_stop_bit_us);
+  }
+
+  // Wait out the request timeout of a truncated command, so its cost is
+  // counted with it
+  std::string name = command_name(bytes[0]);
+  uint expected_length = 1 + request_length(bytes[0]);
+  if (bytes.size() < expected_length) {
+    idle(48 * (expected_length - 1));
+    name += " (truncated)";
+  }
+
+  uint64_t handling_ns = host_interrupt_ns() - start_ns;
+  command_cost &cost = costs[name];
+  ++cost.count;
+  cost.total_ns += handling_ns;
+  cost.max_ns = std::max(cost.max_ns, handling_ns);
+
+  return response;
+}
+
+void console_simulator::idle(uint32_t us) { advance(us); }
+
+const std::map<std::string, command_cost> &console_simulator::command_costs()
+    const {
+  return costs;
+}
+
+void console_simulator::print_command_costs() const {
+  std::printf("%-22s %8s %10s %10s\n", "Command", "Count", "Mean (ns)",
+              "Max (ns)");
+  for (const auto &[name, cost] : costs) {
+    std::printf("%-22s %8u %10llu %10llu\n", name.c_str(), cost.count,
+                static_cast<unsigned long long>(cost.total_ns / cost.count),
+                static_cast<unsigned long long>(cost.max_ns));
+  }
+}
@@ -0,0 +1,123 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef CONSOLE_SIMULATOR_H_
+#define CONSOLE_SIMULATOR_H_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "pico/types.h"
+
+/** \file console_simulator.hpp
+ * \brief Simulated console driving the Joybus implementation on the host
+ *
+ * Bytes are moved through the Joybus DMA channels of the SDK stand-ins at the
+ * times a console would send & receive them, so the interrupt handler, the
+ * request timeout and the PIO/DMA glue all run as on the controller.
+ */
+
+/// \brief Timing of the simulated console's transmissions in microseconds
+struct console_timing {
+  /// \brief Time to send each command & request byte, 8 bits of 5µs
+  uint32_t command_byte_us = 40;
+  /// \brief Time to send the console stop bit
+  uint32_t stop_bit_us = 3;
+  /// \brief Time for the controller to send each response byte, 8 bits of 4µs
+  uint32_t response_byte_us = 32;
+  /// \brief Time for the controller to send its stop bit
+  uint32_t response_stop_bit_us = 4;
+};
+
+/// \brief Cost of handling one kind of command, on the host's clock
+struct command_cost {
+  /// \brief Number of commands handled
+  uint32_t count;
+  /// \brief Total time spent in interrupt handlers in nanoseconds
+  uint64_t total_ns;
+  /// \brief Most time spent handling one command in nanoseconds
+  uint64_t max_ns;
+};
+
+/// \brief Console which sends commands to the Joybus implementation
+class console_simulator {
+ private:
+  console_timing timing;
+  int rx_channel;
+  int tx_channel;
+  std::function<void()> background;
+  std::map<std::string, command_cost> costs;
+
+  void advance(uint32_t us);
+
+ public:
+  /** \brief Initialize Joybus, and connect to its DMA channels
+   *
+   * \note Joybus can only be initialized once, so only one simulator may be
+   * created per test.
+   *
+   * \param timing Timing of transmissions
+   */
+  explicit console_simulator(const console_timing &timing = {});
+
+  /** \brief Change the timing of transmissions
+   *
+   * \param new_timing Timing of transmissions
+   */
+  void set_timing(const console_timing &new_timing);
+
+  /** \brief Set work to run whenever simulated time passes, such as the main
+   * loop or the analog core
+   *
+   * \param work Function to run, between the console's transmissions and
+   * between each byte of a response
+   */
+  void set_background(std::function<void()> work);
+
+  /** \brief Send a command, then receive the controller's response
+   *
+   * Bytes beyond the command byte are request bytes. Sending fewer request
+   * bytes than the command has simulates a truncated command, which waits
+   * out the controller's request timeout.
+   *
+   * \param bytes Command byte followed by request bytes
+   *
+   * \return Bytes the controller responded with, empty if it didn't respond
+   */
+  std::vector<uint8_t> send(const std::vector<uint8_t> &bytes);
+
+  /** \brief Let time pass without transmitting
+   *
+   * \param us Microseconds to wait
+   */
+  void idle(uint32_t us);
+
+  /** \brief Get the cost of handling each kind of command sent so far
+   *
+   * \return Costs keyed by command name
+   */
+  const std::map<std::string, command_cost> &command_costs() const;
+
+  /// \brief Print the cost of handling each kind of command sent so far
+  void print_command_costs() const;
+};
+
+#endif  // CONSOLE_SIMULATOR_H_
@@ -0,0 +1,83 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <deque>
+
+#include "host_controller.hpp"
+#include "pico/time.h"
+
+uint16_t current_buttons = 0;
+std::deque<button_change> button_changes;
+
+raw_stick current_l_stick = {};
+raw_stick current_r_stick = {};
+stick_sample_ring l_stick_samples;
+stick_sample_ring r_stick_samples;
+
+raw_triggers current_triggers = {};
+
+void host_set_buttons(uint16_t buttons) {
+  if (buttons != current_buttons) {
+    current_buttons = buttons;
+    button_changes.push_back({buttons, time_us_32()});
+  }
+}
+
+void host_set_sticks(raw_stick l_stick, raw_stick r_stick) {
+  current_l_stick = l_stick;
+  current_r_stick = r_stick;
+}
+
+void host_set_triggers(raw_triggers triggers) { current_triggers = triggers; }
+
+void init_buttons() {}
+
+uint16_t get_buttons() { return current_buttons; }
+
+bool get_button_change(button_change &change) {
+  if (button_changes.empty()) {
+    return false;
+  }
+  change = button_changes.front();
+  button_changes.pop_front();
+  return true;
+}
+
+void init_sticks() {}
+
+void sample_sticks() {
+  l_stick_samples.push(get_left_stick());
+  r_stick_samples.push(get_right_stick());
+}
+
+stick_sample_ring &left_stick_samples() { return l_stick_samples; }
+
+stick_sample_ring &right_stick_samples() { return r_stick_samples; }
+
+raw_stick get_left_stick() {
+  return {current_l_stick.x, current_l_stick.y, true, time_us_32()};
+}
+
+raw_stick get_right_stick() {
+  return {current_r_stick.x, current_r_stick.y, true, time_us_32()};
+}
+
+void init_triggers() {}
+
+raw_triggers get_triggers() { return current_triggers; }
@@ -0,0 +1,51 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef HOST_CONTROLLER_H_
+#define HOST_CONTROLLER_H_
+
+#include "analog_controller.hpp"
+
+/** \file host_controller.hpp
+ * \brief Simulated controller hardware for the host tests
+ *
+ * Implements `analog_controller.hpp` from inputs set by the test.
+ */
+
+/** \brief Change the physical buttons, queueing the change at the current
+ * simulated time
+ *
+ * \param buttons Physical button states
+ */
+void host_set_buttons(uint16_t buttons);
+
+/** \brief Set the raw values sampled from the sticks
+ *
+ * \param l_stick Left stick axis values
+ * \param r_stick Right stick axis values
+ */
+void host_set_sticks(raw_stick l_stick, raw_stick r_stick);
+
+/** \brief Set the raw values read from the triggers
+ *
+ * \param triggers Trigger values
+ */
+void host_set_triggers(raw_triggers triggers);
+
+#endif  // HOST_CONTROLLER_H_
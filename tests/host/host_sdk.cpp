@@ -0,0 +1,498 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include "host_sdk.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/interp.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "pico/multicore.h"
+#include "pico/stdlib.h"
+
+constexpr uint NUM_DMA_CHANNELS = 12;
+constexpr uint NUM_ALARMS = 4;
+constexpr uint NUM_SPIN_LOCKS = 32;
+constexpr uint NUM_IRQS = 32;
+
+uint64_t now_us = 0;
+uint64_t interrupt_ns = 0;
+
+std::array<host_dma_channel, NUM_DMA_CHANNELS> dma_channels = {};
+uint dma_channels_claimed = 0;
+
+std::array<hardware_alarm_callback_t, NUM_ALARMS> alarm_callbacks = {};
+std::array<absolute_time_t, NUM_ALARMS> alarm_targets = {};
+std::array<bool, NUM_ALARMS> alarms_armed = {};
+uint alarms_claimed = 0;
+bool miss_next_alarm = false;
+
+std::array<spin_lock_t, NUM_SPIN_LOCKS> spin_locks = {};
+uint spin_locks_claimed = 0;
+
+std::array<irq_handler_t, NUM_IRQS> irq_handlers = {};
+std::array<bool, NUM_IRQS> irqs_enabled = {};
+
+std::array<dma_channel_hw_t, NUM_DMA_CHANNELS> dma_registers = {};
+
+timer_hw_t timer_registers = {};
+timer_hw_t *timer_hw = &timer_registers;
+
+std::array<interp_hw_t, 2> interp_blocks = {};
+interp_hw_t *interp0 = &interp_blocks[0];
+interp_hw_t *interp1 = &interp_blocks[1];
+
+std::array<pio_hw_t, 2> pio_blocks = {};
+PIO pio0 = &pio_blocks[0];
+PIO pio1 = &pio_blocks[1];
+std::array<uint, 2> pio_sms_claimed = {};
+std::vector<uint> pio_executed;
+
+uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+
+// Times a handler on the host's clock, as the cost of the event it handles
+template <typename F>
+void run_interrupt(F handler) {
+  auto start = std::chrono::steady_clock::now();
+  handler();
+  auto end = std::chrono::steady_clock::now();
+  interrupt_ns +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+}
+
+void host_set_time_us(uint64_t time) { now_us = time; }
+
+void host_miss_next_alarm() { miss_next_alarm = true; }
+
+void host_advance_time_us(uint64_t us) {
+  uint64_t until = now_us + us;
+  while (true) {
+    // Fire the earliest alarm reached, at its target time
+    int next_alarm = -1;
+    for (uint alarm = 0; alarm < NUM_ALARMS; ++alarm) {
+      if (alarms_armed[alarm] && alarm_targets[alarm] <= until &&
+          (next_alarm == -1 ||
+           alarm_targets[alarm] < alarm_targets[next_alarm])) {
+        next_alarm = alarm;
+      }
+    }
+    if (next_alarm == -1) {
+      break;
+    }
+
+    alarms_armed[next_alarm] = false;
+    now_us = std::max(now_us, alarm_targets[next_alarm]);
+    run_interrupt([=] { alarm_callbacks[next_alarm](next_alarm); });
+  }
+  now_us = until;
+}
+
+host_dma_channel &host_dma(uint channel) { return dma_channels[channel]; }
+
+int host_dma_channel_for(const volatile void *address) {
+  for (uint channel = 0; channel < dma_channels_claimed; ++channel) {
+    if (dma_channels[channel].read_addr == address ||
+        dma_channels[channel].write_addr == address) {
+      return channel;
+    }
+  }
+  return -1;
+}
+
+uint8_t host_dma_transfer(uint channel, uint8_t byte) {
+  host_dma_channel &dma = dma_channels[channel];
+  if (!dma.busy) {
+    return 0;
+  }
+
+  if (dma.read_increment) {
+    byte = *dma.read_addr++;
+  }
+  if (dma.write_increment) {
+    *dma.write_addr++ = byte;
+  }
+
+  --dma.remaining;
+  if (dma.remaining == 0) {
+    dma.busy = false;
+    if (dma.irq0_enabled) {
+      host_raise_irq(DMA_IRQ_0);
+    }
+  }
+  return byte;
+}
+
+void host_raise_irq(uint num) {
+  if (irqs_enabled[num] && irq_handlers[num] != nullptr) {
+    run_interrupt(irq_handlers[num]);
+  }
+}
+
+uint64_t host_interrupt_ns() { return interrupt_ns; }
+
+std::vector<uint> &host_pio_executed() { return pio_executed; }
+
+// pico/time.h
+
+absolute_time_t get_absolute_time() { return now_us; }
+
+uint32_t time_us_32() { return now_us; }
+
+uint64_t time_us_64() { return now_us; }
+
+bool is_nil_time(absolute_time_t t) { return t == nil_time; }
+
+bool time_reached(absolute_time_t t) { return now_us >= t; }
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+  return static_cast<int64_t>(to - from);
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us) { return now_us + us; }
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+  return now_us + (ms * 1000ull);
+}
+
+void busy_wait_us(uint64_t us) { host_advance_time_us(us); }
+
+void busy_wait_us_32(uint32_t us) { host_advance_time_us(us); }
+
+void busy_wait_ms(uint32_t ms) { host_advance_time_us(ms * 1000ull); }
+
+// pico/stdlib.h & pico/multicore.h
+
+bool stdio_init_all() { return true; }
+
+void multicore_launch_core1(void (*entry)()) {}
+
+// hardware/sync.h
+
+int spin_lock_claim_unused(bool required) { return spin_locks_claimed++; }
+
+spin_lock_t *spin_lock_instance(uint lock_num) {
+  return &spin_locks[lock_num];
+}
+
+// hardware/flash.h
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+  std::memset(host_flash + flash_offs, 0xFF, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data,
+                         size_t count) {
+  // Programming can only clear bits
+  for (size_t i = 0; i < count; ++i) {
+    host_flash[flash_offs + i] &= data[i];
+  }
+}
+
+// hardware/gpio.h & hardware/clocks.h
+
+void gpio_init(uint gpio) {}
+
+void gpio_set_dir(uint gpio, bool out) {}
+
+void gpio_pull_up(uint gpio) {}
+
+bool gpio_get(uint gpio) { return false; }
+
+void gpio_put(uint gpio, bool value) {}
+
+bool set_sys_clock_pll(uint32_t vco_freq, uint post_div1, uint post_div2) {
+  return true;
+}
+
+// hardware/irq.h
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+  irq_handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) { irqs_enabled[num] = enabled; }
+
+// hardware/timer.h
+
+int hardware_alarm_claim_unused(bool required) { return alarms_claimed++; }
+
+void hardware_alarm_set_callback(uint alarm_num,
+                                 hardware_alarm_callback_t callback) {
+  alarm_callbacks[alarm_num] = callback;
+}
+
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t) {
+  // Like the hardware, a target that has already passed is missed
+  if (t <= now_us || miss_next_alarm) {
+    miss_next_alarm = false;
+    alarms_armed[alarm_num] = false;
+    return true;
+  }
+  alarm_targets[alarm_num] = t;
+  alarms_armed[alarm_num] = true;
+  return false;
+}
+
+void hardware_alarm_cancel(uint alarm_num) { alarms_armed[alarm_num] = false; }
+
+// hardware/pio.h
+
+uint pio_add_program(PIO pio, const pio_program_t *program) { return 0; }
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+  return pio_sms_claimed[pio == pio1]++;
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) { return 0; }
+
+void pio_sm_exec(PIO pio, uint sm, uint instr) {
+  pio_executed.push_back(instr);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) { return true; }
+
+uint32_t pio_sm_get(PIO pio, uint sm) { return 0; }
+
+// hardware/interp.h
+
+// Control register fields, as laid out on the RP2040
+constexpr uint INTERP_SHIFT_LSB = 0;
+constexpr uint INTERP_MASK_LSB_LSB = 5;
+constexpr uint INTERP_MASK_MSB_LSB = 10;
+constexpr uint32_t INTERP_SIGNED = 1u << 15;
+constexpr uint32_t INTERP_CROSS_INPUT = 1u << 16;
+constexpr uint32_t INTERP_ADD_RAW = 1u << 18;
+constexpr uint32_t INTERP_BLEND = 1u << 21;
+constexpr uint32_t INTERP_CLAMP = 1u << 22;
+
+// Set a control register field
+void set_interp_field(interp_config *c, uint lsb, uint bits, uint32_t value) {
+  uint32_t mask = ((1u << bits) - 1) << lsb;
+  c->ctrl = (c->ctrl & ~mask) | ((value << lsb) & mask);
+}
+
+void set_interp_flag(interp_config *c, uint32_t flag, bool set) {
+  c->ctrl = set ? (c->ctrl | flag) : (c->ctrl & ~flag);
+}
+
+interp_config interp_default_config() {
+  // No shift, and a mask of every bit
+  interp_config c = {0};
+  set_interp_field(&c, INTERP_MASK_MSB_LSB, 5, 31);
+  return c;
+}
+
+void interp_config_set_shift(interp_config *c, uint shift) {
+  set_interp_field(c, INTERP_SHIFT_LSB, 5, shift);
+}
+
+void interp_config_set_mask(interp_config *c, uint mask_lsb, uint mask_msb) {
+  set_interp_field(c, INTERP_MASK_LSB_LSB, 5, mask_lsb);
+  set_interp_field(c, INTERP_MASK_MSB_LSB, 5, mask_msb);
+}
+
+void interp_config_set_cross_input(interp_config *c, bool cross_input) {
+  set_interp_flag(c, INTERP_CROSS_INPUT, cross_input);
+}
+
+void interp_config_set_signed(interp_config *c, bool _signed) {
+  set_interp_flag(c, INTERP_SIGNED, _signed);
+}
+
+void interp_config_set_add_raw(interp_config *c, bool add_raw) {
+  set_interp_flag(c, INTERP_ADD_RAW, add_raw);
+}
+
+void interp_config_set_blend(interp_config *c, bool blend) {
+  set_interp_flag(c, INTERP_BLEND, blend);
+}
+
+void interp_config_set_clamp(interp_config *c, bool clamp) {
+  set_interp_flag(c, INTERP_CLAMP, clamp);
+}
+
+void interp_set_config(interp_hw_t *interp, uint lane, interp_config *config) {
+  interp->ctrl[lane] = config->ctrl;
+}
+
+// Shift & mask a lane's input, sign extending from the top bit of the mask
+// if the lane is signed
+uint32_t shift_and_mask(const interp_hw_t &interp, uint lane) {
+  uint32_t ctrl = interp.ctrl[lane];
+  uint shift = (ctrl >> INTERP_SHIFT_LSB) & 31;
+  uint mask_lsb = (ctrl >> INTERP_MASK_LSB_LSB) & 31;
+  uint mask_msb = (ctrl >> INTERP_MASK_MSB_LSB) & 31;
+
+  uint32_t input = interp.accum[(ctrl & INTERP_CROSS_INPUT) ? 1 - lane : lane];
+  uint32_t mask = (UINT32_MAX >> (31 - mask_msb)) & (UINT32_MAX << mask_lsb);
+  uint32_t value = (input >> shift) & mask;
+  if ((ctrl & INTERP_SIGNED) && mask_msb < 31 &&
+      (value & (1u << mask_msb)) != 0) {
+    value |= UINT32_MAX << (mask_msb + 1);
+  }
+  return value;
+}
+
+uint32_t interp_peek_t::operator[](uint lane) const {
+  const interp_hw_t *interp = reinterpret_cast<const interp_hw_t *>(
+      reinterpret_cast<const char *>(this) - offsetof(interp_hw_t, peek));
+  uint32_t results[2];
+  for (uint i = 0; i < 2; ++i) {
+    results[i] = (interp->ctrl[i] & INTERP_ADD_RAW) ? interp->accum[i]
+                                                   : shift_and_mask(*interp, i);
+  }
+
+  // Lane 0 of interp0 can blend between the bases, and lane 0 of interp1 can
+  // clamp to them
+  bool blend = interp == interp0 && (interp->ctrl[0] & INTERP_BLEND);
+  bool clamp = interp == interp1 && (interp->ctrl[0] & INTERP_CLAMP);
+  uint32_t masked0 = shift_and_mask(*interp, 0);
+  switch (lane) {
+    case 0:
+      if (blend) {
+        return masked0 & 0xFF;
+      }
+      if (clamp) {
+        if (interp->ctrl[0] & INTERP_SIGNED) {
+          return std::clamp<int32_t>(masked0, interp->base[0],
+                                     interp->base[1]);
+        }
+        return std::clamp<uint32_t>(masked0, interp->base[0], interp->base[1]);
+      }
+      return interp->base[0] + results[0];
+    case 1:
+      if (blend) {
+        uint32_t alpha = masked0 & 0xFF;
+        if (interp->ctrl[1] & INTERP_SIGNED) {
+          int64_t from = static_cast<int32_t>(interp->base[0]);
+          int64_t to = static_cast<int32_t>(interp->base[1]);
+          return from + (((to - from) * alpha) >> 8);
+        }
+        uint64_t from = interp->base[0];
+        uint64_t to = interp->base[1];
+        return from + ((static_cast<int64_t>(to - from) * alpha) >> 8);
+      }
+      return interp->base[1] + results[1];
+    default:
+      return interp->base[2] + masked0 +
+             (blend ? 0 : shift_and_mask(*interp, 1));
+  }
+}
+
+// hardware/dma.h
+
+int dma_claim_unused_channel(bool required) { return dma_channels_claimed++; }
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  // Reads increment & writes don't by default, as on the hardware
+  return {1};
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {}
+
+void channel_config_set_transfer_data_size(
+    dma_channel_config *c, enum dma_channel_transfer_size size) {}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+  c->ctrl = (c->ctrl & ~1u) | incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+  c->ctrl = (c->ctrl & ~2u) | (incr << 1);
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool write,
+                             uint size_bits) {}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to) {}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config,
+                            bool trigger) {
+  dma_channels[channel].read_increment = (config->ctrl & 1) != 0;
+  dma_channels[channel].write_increment = (config->ctrl & 2) != 0;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config,
+                           volatile void *write_addr,
+                           const volatile void *read_addr,
+                           uint transfer_count, bool trigger) {
+  dma_channel_set_config(channel, config, false);
+  dma_channel_set_write_addr(channel, write_addr, false);
+  dma_channel_set_read_addr(channel, read_addr, false);
+  dma_channels[channel].remaining = transfer_count;
+  dma_channels[channel].busy = trigger && transfer_count != 0;
+}
+
+dma_channel_hw_t *dma_channel_hw_addr(uint channel) {
+  // Registers reflect the simulated channel when they're read
+  dma_registers[channel].write_addr =
+      reinterpret_cast<uintptr_t>(dma_channels[channel].write_addr);
+  return &dma_registers[channel];
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr,
+                                bool trigger) {
+  dma_channels[channel].write_addr =
+      static_cast<volatile uint8_t *>(write_addr);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr,
+                               bool trigger) {
+  dma_channels[channel].read_addr =
+      static_cast<const volatile uint8_t *>(read_addr);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel,
+                                          const volatile void *read_addr,
+                                          uint32_t transfer_count) {
+  dma_channel_set_read_addr(channel, read_addr, false);
+  dma_channels[channel].remaining = transfer_count;
+  dma_channels[channel].busy = transfer_count != 0;
+}
+
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void *write_addr,
+                                        uint32_t transfer_count) {
+  dma_channel_set_write_addr(channel, write_addr, false);
+  dma_channels[channel].remaining = transfer_count;
+  dma_channels[channel].busy = transfer_count != 0;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+  dma_channels[channel].irq0_enabled = enabled;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {}
+
+bool dma_channel_is_busy(uint channel) { return dma_channels[channel].busy; }
+
+void dma_channel_abort(uint channel) {
+  dma_channels[channel].remaining = 0;
+  dma_channels[channel].busy = false;
+}
@@ -0,0 +1,124 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef HOST_SDK_H_
+#define HOST_SDK_H_
+
+#include <vector>
+
+#include "pico/types.h"
+
+/** \file host_sdk.hpp
+ * \brief Controls for the host stand-ins of the SDK
+ *
+ * The stand-ins simulate just enough of the RP2040 for firmware code to run
+ * in a test: time only passes when a test advances it, DMA channels only move
+ * data when a test moves it through them, and interrupt handlers & alarm
+ * callbacks run synchronously when their event happens. Time spent in them
+ * is measured on the host's clock, as the cost of handling the event.
+ */
+
+/** \brief Set the simulated time, without firing alarms
+ *
+ * \param time Microseconds since boot
+ */
+void host_set_time_us(uint64_t time);
+
+/** \brief Advance the simulated time, firing any alarms reached on the way
+ * at their target time
+ *
+ * \param us Microseconds to advance by
+ */
+void host_advance_time_us(uint64_t us);
+
+/** \brief Have the next alarm target set be missed, as if whatever set it
+ * was held up until after the target
+ */
+void host_miss_next_alarm();
+
+/// \brief State of a simulated DMA channel
+struct host_dma_channel {
+  /// \brief Address the channel reads from
+  const volatile uint8_t *read_addr;
+  /// \brief Address the channel writes to
+  volatile uint8_t *write_addr;
+  /// \brief Whether the read address advances after each transfer
+  bool read_increment;
+  /// \brief Whether the write address advances after each transfer
+  bool write_increment;
+  /// \brief Number of transfers left
+  uint32_t remaining;
+  /// \brief Whether the channel is transferring
+  bool busy;
+  /// \brief Whether completing a transfer raises `DMA_IRQ_0`
+  bool irq0_enabled;
+};
+
+/** \brief Get a simulated DMA channel
+ *
+ * \param channel Channel number
+ *
+ * \return The channel's state
+ */
+host_dma_channel &host_dma(uint channel);
+
+/** \brief Find the claimed DMA channel reading from or writing to an address,
+ * such as a peripheral's FIFO
+ *
+ * \param address Address the channel is configured with
+ *
+ * \return Channel number, -1 if no channel uses the address
+ */
+int host_dma_channel_for(const volatile void *address);
+
+/** \brief Have a busy channel transfer one byte, as when its peripheral
+ * raises a data request
+ *
+ * The last transfer completes the channel, which raises `DMA_IRQ_0` if
+ * enabled for it.
+ *
+ * \param channel Channel number
+ * \param byte Byte to write when the channel reads from a peripheral
+ *
+ * \return Byte the channel read, which is `byte` when reading from a
+ * peripheral
+ */
+uint8_t host_dma_transfer(uint channel, uint8_t byte = 0);
+
+/** \brief Raise an interrupt, running its handler if enabled
+ *
+ * \param num Interrupt number
+ */
+void host_raise_irq(uint num);
+
+/** \brief Get the total host time spent in interrupt handlers & alarm
+ * callbacks
+ *
+ * \return Nanoseconds on the host's clock
+ */
+uint64_t host_interrupt_ns();
+
+/** \brief Get the instructions executed on PIO state machines by the
+ * processor, oldest first
+ *
+ * \return Executed instructions
+ */
+std::vector<uint> &host_pio_executed();
+
+#endif  // HOST_SDK_H_
@@ -0,0 +1,37 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file button_sampler.pio.h
+ * \brief Host stand-in for the header generated from `button_sampler.pio`
+ */
+
+#ifndef HOST_BUTTON_SAMPLER_PIO_H_
+#define HOST_BUTTON_SAMPLER_PIO_H_
+
+#include "hardware/pio.h"
+
+static const uint button_sampler_offset_sample = 1u;
+
+static const pio_program_t button_sampler_program = {nullptr, 0, -1};
+
+static inline void button_sampler_program_init(PIO pio, uint sm, uint offset,
+                                               uint first_pin, uint num_pins,
+                                               uint32_t sample_rate_hz) {}
+
+#endif  // HOST_BUTTON_SAMPLER_PIO_H_
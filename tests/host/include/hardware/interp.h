@@ -0,0 +1,71 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file interp.h
+ * \brief Host stand-in for the RP2040 interpolators
+ *
+ * A model of the interpolators as the RP2040 datasheet describes them, so
+ * code written for them can be checked against equivalent calculations. Lane
+ * results are calculated from the registers when they're read. Shift, mask,
+ * sign extension, cross input, raw addition, blend & clamp are modelled,
+ * while cross result, forced MSBs, popping & overflow flags aren't. Blends
+ * round towards negative infinity, which the datasheet doesn't specify.
+ *
+ * Firmware uses the interpolators on the device, and equivalent calculations
+ * elsewhere.
+ */
+
+#ifndef HOST_HARDWARE_INTERP_H_
+#define HOST_HARDWARE_INTERP_H_
+
+#include "pico/types.h"
+
+typedef struct {
+  uint32_t ctrl;
+} interp_config;
+
+struct interp_hw_t;
+
+/// \brief Lane results of an interpolator, calculated as they're read
+struct interp_peek_t {
+  uint32_t operator[](uint lane) const;
+};
+
+/// \brief Registers of an interpolator
+struct interp_hw_t {
+  uint32_t accum[2];
+  uint32_t base[3];
+  uint32_t ctrl[2];
+  interp_peek_t peek;
+};
+
+extern interp_hw_t *interp0;
+extern interp_hw_t *interp1;
+
+interp_config interp_default_config();
+void interp_config_set_shift(interp_config *c, uint shift);
+void interp_config_set_mask(interp_config *c, uint mask_lsb, uint mask_msb);
+void interp_config_set_cross_input(interp_config *c, bool cross_input);
+void interp_config_set_signed(interp_config *c, bool _signed);
+void interp_config_set_add_raw(interp_config *c, bool add_raw);
+void interp_config_set_blend(interp_config *c, bool blend);
+void interp_config_set_clamp(interp_config *c, bool clamp);
+void interp_set_config(interp_hw_t *interp, uint lane, interp_config *config);
+
+#endif  // HOST_HARDWARE_INTERP_H_
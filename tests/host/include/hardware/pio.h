@@ -0,0 +1,85 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file pio.h
+ * \brief Host stand-in for the RP2040 PIO
+ *
+ * State machines don't run – instructions executed by the processor are
+ * recorded, and FIFOs are only ever moved by the simulated DMA.
+ */
+
+#ifndef HOST_HARDWARE_PIO_H_
+#define HOST_HARDWARE_PIO_H_
+
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "pico/types.h"
+
+typedef struct {
+  volatile uint32_t txf[4];
+  volatile uint32_t rxf[4];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern PIO pio0;
+extern PIO pio1;
+
+typedef struct {
+  const uint16_t *instructions;
+  uint8_t length;
+  int8_t origin;
+} pio_program_t;
+
+typedef pio_program_t pio_program;
+
+#define PIO_INSTRUCTION_COUNT 32u
+
+enum pio_src_dest {
+  pio_pins = 0,
+  pio_x = 1,
+  pio_y = 2,
+  pio_null = 3,
+  pio_pindirs = 4,
+  pio_status = 5,
+  pio_pc = 6,
+  pio_isr = 7,
+  pio_osr = 8,
+  pio_exec_mov = 9,
+};
+
+uint pio_add_program(PIO pio, const pio_program_t *program);
+int pio_claim_unused_sm(PIO pio, bool required);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+
+inline uint pio_encode_jmp(uint addr) { return 0x0000 | addr; }
+
+inline uint pio_encode_in(enum pio_src_dest src, uint count) {
+  return 0x4000 | (src << 5) | (count & 31);
+}
+
+inline uint pio_encode_mov(enum pio_src_dest dest, enum pio_src_dest src) {
+  return 0xA000 | (dest << 5) | src;
+}
+
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+uint32_t pio_sm_get(PIO pio, uint sm);
+
+#endif  // HOST_HARDWARE_PIO_H_
@@ -0,0 +1,55 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file sync.h
+ * \brief Host stand-in for the RP2040 hardware spinlocks
+ */
+
+#ifndef HOST_HARDWARE_SYNC_H_
+#define HOST_HARDWARE_SYNC_H_
+
+#include <atomic>
+
+#include "pico/sync.h"
+
+typedef std::atomic_flag spin_lock_t;
+
+int spin_lock_claim_unused(bool required);
+spin_lock_t *spin_lock_instance(uint lock_num);
+
+inline void spin_lock_unsafe_blocking(spin_lock_t *lock) {
+  while (lock->test_and_set(std::memory_order_acquire)) {
+  }
+}
+
+inline void spin_unlock_unsafe(spin_lock_t *lock) {
+  lock->clear(std::memory_order_release);
+}
+
+inline uint32_t spin_lock_blocking(spin_lock_t *lock) {
+  spin_lock_unsafe_blocking(lock);
+  return save_and_disable_interrupts();
+}
+
+inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq) {
+  spin_unlock_unsafe(lock);
+  restore_interrupts(saved_irq);
+}
+
+#endif  // HOST_HARDWARE_SYNC_H_
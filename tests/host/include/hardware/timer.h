@@ -0,0 +1,46 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file timer.h
+ * \brief Host stand-in for the RP2040 hardware alarms
+ *
+ * Alarms fire as the simulated clock is advanced past their target.
+ */
+
+#ifndef HOST_HARDWARE_TIMER_H_
+#define HOST_HARDWARE_TIMER_H_
+
+#include "pico/time.h"
+
+typedef void (*hardware_alarm_callback_t)(uint alarm_num);
+
+/// \brief Timer registers, which aren't updated as time passes
+typedef struct {
+  volatile uint32_t timerawl;
+} timer_hw_t;
+
+extern timer_hw_t *timer_hw;
+
+int hardware_alarm_claim_unused(bool required);
+void hardware_alarm_set_callback(uint alarm_num,
+                                 hardware_alarm_callback_t callback);
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t);
+void hardware_alarm_cancel(uint alarm_num);
+
+#endif  // HOST_HARDWARE_TIMER_H_
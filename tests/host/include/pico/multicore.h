@@ -0,0 +1,36 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file multicore.h
+ * \brief Host stand-in for the Pico SDK's multicore functions
+ *
+ * Tests run the second core's work themselves, so lockout does nothing.
+ */
+
+#ifndef HOST_PICO_MULTICORE_H_
+#define HOST_PICO_MULTICORE_H_
+
+#include "pico/types.h"
+
+void multicore_launch_core1(void (*entry)());
+inline void multicore_lockout_victim_init() {}
+inline void multicore_lockout_start_blocking() {}
+inline void multicore_lockout_end_blocking() {}
+
+#endif  // HOST_PICO_MULTICORE_H_
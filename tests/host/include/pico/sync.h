@@ -0,0 +1,45 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file sync.h
+ * \brief Host stand-in for the Pico SDK's synchronization primitives
+ *
+ * Interrupts are only ever raised synchronously by tests, so disabling them
+ * does nothing. Barriers are full fences, so primitives built on them can be
+ * exercised from multiple threads.
+ */
+
+#ifndef HOST_PICO_SYNC_H_
+#define HOST_PICO_SYNC_H_
+
+#include <atomic>
+
+#include "pico/types.h"
+
+inline void __dmb() { std::atomic_thread_fence(std::memory_order_seq_cst); }
+
+inline void __compiler_memory_barrier() {
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+inline uint32_t save_and_disable_interrupts() { return 0; }
+
+inline void restore_interrupts(uint32_t) {}
+
+#endif  // HOST_PICO_SYNC_H_
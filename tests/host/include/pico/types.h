@@ -0,0 +1,35 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file types.h
+ * \brief Host stand-in for the Pico SDK's basic types
+ */
+
+#ifndef HOST_PICO_TYPES_H_
+#define HOST_PICO_TYPES_H_
+
+#include <cstddef>
+#include <cstdint>
+
+typedef unsigned int uint;
+
+/// \brief Microseconds since boot, on the host's simulated clock
+typedef uint64_t absolute_time_t;
+
+#endif  // HOST_PICO_TYPES_H_
@@ -0,0 +1,36 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file single_pin_joybus.pio.h
+ * \brief Host stand-in for the header generated from `single_pin_joybus.pio`
+ */
+
+#ifndef HOST_SINGLE_PIN_JOYBUS_PIO_H_
+#define HOST_SINGLE_PIN_JOYBUS_PIO_H_
+
+#include "hardware/pio.h"
+
+static const uint single_pin_joybus_offset_read_stop_bit = 3u;
+
+static const pio_program_t single_pin_joybus_program = {nullptr, 0, -1};
+
+static inline void joybus_program_init(PIO pio, uint sm, uint offset,
+                                       uint in_pin, uint out_pin) {}
+
+#endif  // HOST_SINGLE_PIN_JOYBUS_PIO_H_
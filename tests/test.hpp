@@ -0,0 +1,79 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <cstdio>
+
+/** \file test.hpp
+ * \brief Minimal checks for the host tests
+ *
+ * Each test is its own executable, which runs its checks from `main()` and
+ * returns `test_result()`. Failed checks are reported but don't stop the test,
+ * so every failure in a run is seen at once.
+ */
+
+/// \brief Number of failed checks in this test
+inline int test_failures = 0;
+
+/** \brief Check that a condition holds
+ *
+ * \param condition Condition to check
+ */
+#define CHECK(condition)                                                 \
+  do {                                                                   \
+    if (!(condition)) {                                                  \
+      ++test_failures;                                                   \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,       \
+                  #condition);                                           \
+    }                                                                    \
+  } while (0)
+
+/** \brief Check that two integer values are equal, reporting both if not
+ *
+ * \param actual Value produced by the code under test
+ * \param expected Value it should have produced
+ */
+#define CHECK_EQUAL(actual, expected)                                    \
+  do {                                                                   \
+    long long actual_value = static_cast<long long>(actual);             \
+    long long expected_value = static_cast<long long>(expected);         \
+    if (actual_value != expected_value) {                                \
+      ++test_failures;                                                   \
+      std::printf("%s:%d: CHECK_EQUAL(%s, %s) failed, %lld != %lld\n",   \
+                  __FILE__, __LINE__, #actual, #expected, actual_value,  \
+                  expected_value);                                       \
+    }                                                                    \
+  } while (0)
+
+/** \brief Report the test's outcome
+ *
+ * \return Exit status for the test, 0 if every check passed
+ */
+inline int test_result() {
+  if (test_failures != 0) {
+    std::printf("%d checks failed\n", test_failures);
+    return 1;
+  }
+  std::printf("All checks passed\n");
+  return 0;
+}
+
+#endif  // TEST_H_
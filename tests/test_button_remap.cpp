@@ -0,0 +1,153 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_button_remap.cpp
+ * \brief Checks compiled button remap tables against remapping each button in
+ * turn, for every physical button combination
+ */
+
+#include "button_remap.hpp"
+#include "configuration.hpp"
+#include "main.hpp"
+#include "test.hpp"
+
+/// \brief Physical button remapped by each mapping, or -1 if none is
+constexpr std::array<int, 13> MAPPED_BUTTONS = {
+    DPAD_LEFT, DPAD_RIGHT, DPAD_DOWN, DPAD_UP, Z, RT_DIGITAL, LT_DIGITAL,
+    -1,        A,          B,         X,       Y, START};
+
+/** \brief Remap physical buttons one at a time, as was done before
+ * remapping was compiled, and apply digital trigger modes
+ *
+ * \param profile Profile to remap with
+ * \param physical_buttons Physical button states
+ * \param fixed_buttons Output button states not driven by physical buttons
+ * \param lt_pressed Output for whether the left trigger's digital output is
+ * pressed, before its trigger mode is applied
+ * \param rt_pressed Output for whether the right trigger's digital output is
+ * pressed, before its trigger mode is applied
+ *
+ * \return Output button states
+ */
+uint16_t reference_remap(const configuration_profile &profile,
+                         uint16_t physical_buttons, uint16_t fixed_buttons,
+                         bool &lt_pressed, bool &rt_pressed) {
+  uint16_t buttons = fixed_buttons;
+
+  // Highest mapping first, so lower ones win any output they share
+  for (int index = MAPPED_BUTTONS.size() - 1; index >= 0; --index) {
+    if (MAPPED_BUTTONS[index] < 0) {
+      continue;
+    }
+    uint output = profile.mappings[index];
+    bool pressed = (physical_buttons >> MAPPED_BUTTONS[index]) & 1;
+    buttons = (buttons & ~(1 << output)) | (pressed << output);
+  }
+
+  lt_pressed = (buttons >> LT_DIGITAL) & 1;
+  rt_pressed = (buttons >> RT_DIGITAL) & 1;
+
+  // Analog only modes never send the digital press
+  for (auto [mode, bit] : {std::pair{profile.l_trigger_mode, LT_DIGITAL},
+                           std::pair{profile.r_trigger_mode, RT_DIGITAL}}) {
+    if (mode == analog_only || mode == analog_on_digital) {
+      buttons &= ~(1 << bit);
+    }
+  }
+
+  return buttons;
+}
+
+/** \brief Check compiled tables & `read_digital()` for a profile, for every
+ * physical button combination
+ *
+ * \param mappings Button mappings of the profile
+ * \param l_trigger_mode Left trigger mode
+ * \param r_trigger_mode Right trigger mode
+ */
+void check_profile(const std::array<uint8_t, 13> &mappings,
+                   trigger_mode l_trigger_mode, trigger_mode r_trigger_mode) {
+  controller_configuration &config = controller_configuration::get_instance();
+  configuration_profile &profile = config.profiles[config.current_profile];
+  profile.mappings = mappings;
+  profile.l_trigger_mode = l_trigger_mode;
+  profile.r_trigger_mode = r_trigger_mode;
+  compile_button_remap(config);
+
+  uint mismatches = 0;
+  for (bool origin : {false, true}) {
+    state.origin = origin;
+    uint16_t fixed_buttons = (1 << ALWAYS_HIGH) | (origin << ORIGIN);
+    for (uint physical_buttons = 0; physical_buttons <= UINT16_MAX;
+         ++physical_buttons) {
+      bool lt_pressed;
+      bool rt_pressed;
+      uint16_t expected = reference_remap(profile, physical_buttons,
+                                          fixed_buttons, lt_pressed,
+                                          rt_pressed);
+
+      read_digital(physical_buttons);
+      mismatches += state.buttons != expected ||
+                    state.lt_pressed != lt_pressed ||
+                    state.rt_pressed != rt_pressed;
+    }
+  }
+  if (mismatches != 0) {
+    std::printf("trigger modes %u & %u, mappings", l_trigger_mode,
+                r_trigger_mode);
+    for (uint8_t mapping : mappings) {
+      std::printf(" %u", mapping);
+    }
+    std::printf(":\n");
+  }
+  CHECK_EQUAL(mismatches, 0);
+}
+
+int main() {
+  const std::array<uint8_t, 13> identity = {
+      DPAD_LEFT, DPAD_RIGHT, DPAD_DOWN, DPAD_UP, Z, RT_DIGITAL, LT_DIGITAL,
+      0,         A,          B,         X,       Y, START};
+
+  // A & B swapped, Z as the left trigger & the left trigger as Z
+  std::array<uint8_t, 13> swapped = identity;
+  std::swap(swapped[8], swapped[9]);
+  std::swap(swapped[4], swapped[6]);
+
+  // X & Y both jump, Z also presses A, and nothing is mapped to Z or B
+  std::array<uint8_t, 13> shared = identity;
+  shared[10] = Y;
+  shared[4] = A;
+  shared[9] = DPAD_UP;
+
+  // The D-pad is mapped over the bit that's always high
+  std::array<uint8_t, 13> over_fixed = identity;
+  over_fixed[0] = ALWAYS_HIGH;
+
+  for (const std::array<uint8_t, 13> &mappings :
+       {identity, swapped, shared, over_fixed}) {
+    for (uint mode = first_trigger_mode; mode <= last_trigger_mode; ++mode) {
+      uint other_mode =
+          first_trigger_mode + ((mode + 3 - first_trigger_mode) %
+                                (last_trigger_mode - first_trigger_mode + 1));
+      check_profile(mappings, static_cast<trigger_mode>(mode),
+                    static_cast<trigger_mode>(other_mode));
+    }
+  }
+
+  return test_result();
+}
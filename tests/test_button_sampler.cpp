@@ -0,0 +1,176 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file test_button_sampler.cpp
+ * \brief Checks that sampled button changes are returned in order, and that a
+ * lapped ring is detected wherever the reader was left
+ *
+ * The sampler's DMA is faked: each change is written where its channels'
+ * write addresses point, which then advance around their rings as on the
+ * hardware.
+ */
+
+#include <vector>
+
+#include "button_sampler.hpp"
+#include "hardware/timer.h"
+#include "host_sdk.hpp"
+#include "test.hpp"
+
+constexpr uint SAMPLED_PINS = 13;
+
+/// \brief A sampled change
+struct change {
+  uint32_t pins;
+  uint32_t timestamp;
+};
+
+/// \brief Stand-in for the sampler's DMA channels, writing into its rings
+class fake_sampler_dma {
+ public:
+  fake_sampler_dma()
+      : pins_channel(host_dma_channel_for(&pio1->rxf[0])),
+        timestamp_channel(host_dma_channel_for(&timer_hw->timerawl)),
+        pin_ring(ring_start(pins_channel)),
+        timestamp_ring(ring_start(timestamp_channel)) {}
+
+  /// \brief Write a change's pins, without timestamping it yet
+  void write_pins(uint32_t pins) { write(pins_channel, pin_ring, pins); }
+
+  /// \brief Timestamp the change whose pins were written last
+  void write_timestamp(uint32_t timestamp) {
+    write(timestamp_channel, timestamp_ring, timestamp);
+  }
+
+  /// \brief Write a whole change, returning it
+  change push() {
+    change pushed = {next_pins, next_timestamp};
+    write_pins(pushed.pins);
+    write_timestamp(pushed.timestamp);
+    next_pins = (next_pins + 1) % (1 << SAMPLED_PINS);
+    next_timestamp += 5;
+    return pushed;
+  }
+
+  /// \brief Write several whole changes, returning them oldest first
+  std::vector<change> push(uint count) {
+    std::vector<change> pushed;
+    for (uint i = 0; i < count; ++i) {
+      pushed.push_back(push());
+    }
+    return pushed;
+  }
+
+ private:
+  static volatile uint32_t *ring_start(int channel) {
+    return reinterpret_cast<volatile uint32_t *>(host_dma(channel).write_addr);
+  }
+
+  // Write at the channel's write address, which wraps around the ring
+  static void write(int channel, volatile uint32_t *ring, uint32_t value) {
+    volatile uint32_t *address =
+        reinterpret_cast<volatile uint32_t *>(host_dma(channel).write_addr);
+    *address = value;
+    uint next = ((address - ring) + 1) % BUTTON_SAMPLER_RING_SIZE;
+    host_dma(channel).write_addr =
+        reinterpret_cast<volatile uint8_t *>(ring + next);
+  }
+
+  int pins_channel;
+  int timestamp_channel;
+  volatile uint32_t *pin_ring;
+  volatile uint32_t *timestamp_ring;
+  uint32_t next_pins = 0x1ABC;
+  uint32_t next_timestamp = 1000000;
+};
+
+bool returns(change expected) {
+  uint32_t pins = 0;
+  uint32_t timestamp = 0;
+  if (!get_sampled_pins(pins, timestamp)) {
+    return false;
+  }
+  return pins == expected.pins && timestamp == expected.timestamp;
+}
+
+bool returns_nothing() {
+  uint32_t pins = 0;
+  uint32_t timestamp = 0;
+  return !get_sampled_pins(pins, timestamp);
+}
+
+// Every change is returned once, oldest first
+void check_returns_in_order(const std::vector<change> &changes) {
+  for (change expected : changes) {
+    CHECK(returns(expected));
+  }
+  CHECK(returns_nothing());
+}
+
+void check_empty(fake_sampler_dma &dma) {
+  CHECK(returns_nothing());
+
+  // A change isn't complete until its timestamp is written
+  dma.write_pins(0x0FFF);
+  CHECK(returns_nothing());
+  dma.write_timestamp(999990);
+  CHECK(returns({0x0FFF, 999990}));
+  CHECK(returns_nothing());
+}
+
+void check_behind(fake_sampler_dma &dma) {
+  // One change behind, then several, across the end of the ring
+  check_returns_in_order(dma.push(1));
+  for (uint i = 0; i < 2 * BUTTON_SAMPLER_RING_SIZE; i += 7) {
+    check_returns_in_order(dma.push(7));
+  }
+
+  // A ring with all but one slot behind is kept, even with the pins of the
+  // next change overwriting the last change returned
+  std::vector<change> changes = dma.push(BUTTON_SAMPLER_RING_SIZE - 1);
+  dma.write_pins(0x0AAA);
+  check_returns_in_order(changes);
+  dma.write_timestamp(changes.back().timestamp + 2);
+  CHECK(returns({0x0AAA, changes.back().timestamp + 2}));
+  CHECK(returns_nothing());
+}
+
+void check_lapped(fake_sampler_dma &dma) {
+  // An exact lap leaves the reader where it was, and a partial lap leaves it
+  // somewhere in the ring. Either way only the newest change is returned,
+  // then changes are returned in order again.
+  for (uint extra : {0u, 1u, 37u, BUTTON_SAMPLER_RING_SIZE - 1,
+                     BUTTON_SAMPLER_RING_SIZE, 3 * BUTTON_SAMPLER_RING_SIZE}) {
+    std::vector<change> changes = dma.push(BUTTON_SAMPLER_RING_SIZE + extra);
+    CHECK(returns(changes.back()));
+    CHECK(returns_nothing());
+    check_returns_in_order(dma.push(3));
+  }
+}
+
+int main() {
+  init_button_sampler(pio1, 0, SAMPLED_PINS);
+  fake_sampler_dma dma;
+
+  check_empty(dma);
+  check_behind(dma);
+  check_lapped(dma);
+
+  return test_result();
+}
@@ -0,0 +1,118 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_configuration.cpp
+ * \brief Checks that the configuration is persisted, reloaded in place, and
+ * reset to defaults
+ */
+
+#include "configuration.hpp"
+#include "test.hpp"
+
+void check_reload() {
+  controller_configuration &config = controller_configuration::get_instance();
+  config.profiles[1].latch_presses = true;
+  config.select_profile(1);
+
+  // Unpersisted changes are discarded, into the same instance
+  config.current_profile = 0;
+  config.profiles[1].latch_presses = false;
+  controller_configuration::reload_instance();
+  CHECK(&controller_configuration::get_instance() == &config);
+  CHECK_EQUAL(config.current_profile, 1);
+  CHECK(config.profiles[1].latch_presses);
+}
+
+void check_stick_aggregation() {
+  // Modes cycle through every aggregation, and are persisted
+  controller_configuration &config = controller_configuration::get_instance();
+  config.select_profile(0);
+  for (stick_aggregation_mode mode :
+       {mean_aggregation, extreme_aggregation, latest_aggregation}) {
+    config.cycle_stick_aggregation();
+    controller_configuration::reload_instance();
+    CHECK_EQUAL(config.stick_aggregation(), mode);
+    CHECK_EQUAL(config.profiles[1].stick_aggregation, latest_aggregation);
+  }
+}
+
+void check_snapback_modes() {
+  // Each stick's mode switches separately, and is persisted
+  controller_configuration &config = controller_configuration::get_instance();
+  config.select_profile(0);
+  config.toggle_r_stick_snapback_mode();
+  controller_configuration::reload_instance();
+  CHECK_EQUAL(config.profiles[0].l_stick_snapback.mode, wave_snapback);
+  CHECK_EQUAL(config.profiles[0].r_stick_snapback.mode, velocity_snapback);
+  CHECK_EQUAL(config.profiles[1].r_stick_snapback.mode, wave_snapback);
+
+  config.toggle_r_stick_snapback_mode();
+  config.toggle_l_stick_snapback_mode();
+  controller_configuration::reload_instance();
+  CHECK_EQUAL(config.profiles[0].l_stick_snapback.mode, velocity_snapback);
+  CHECK_EQUAL(config.profiles[0].r_stick_snapback.mode, wave_snapback);
+  config.toggle_l_stick_snapback_mode();
+}
+
+void check_stick_filters() {
+  // Each stick's filter toggles separately, and is persisted
+  controller_configuration &config = controller_configuration::get_instance();
+  config.select_profile(0);
+  config.toggle_l_stick_filter();
+  controller_configuration::reload_instance();
+  CHECK(config.profiles[0].l_stick_filter.enabled);
+  CHECK(!config.profiles[0].r_stick_filter.enabled);
+  CHECK(!config.profiles[1].l_stick_filter.enabled);
+
+  config.toggle_l_stick_filter();
+  config.toggle_r_stick_filter();
+  controller_configuration::reload_instance();
+  CHECK(!config.profiles[0].l_stick_filter.enabled);
+  CHECK(config.profiles[0].r_stick_filter.enabled);
+  config.toggle_r_stick_filter();
+}
+
+void check_slots_wrap() {
+  // Persisting more often than a sector has slots starts the sector again
+  controller_configuration &config = controller_configuration::get_instance();
+  for (uint i = 0; i < 2 * SLOTS_PER_SECTOR + 1; ++i) {
+    config.select_profile(i % 2);
+  }
+  controller_configuration::reload_instance();
+  CHECK_EQUAL(config.current_profile, 0);
+}
+
+void check_factory_reset() {
+  controller_configuration &config = controller_configuration::get_instance();
+  config.select_profile(1);
+  controller_configuration::factory_reset();
+  CHECK_EQUAL(config.version, CONFIG_VERSION);
+  CHECK_EQUAL(config.current_profile, 0);
+  CHECK(!config.profiles[1].latch_presses);
+}
+
+int main() {
+  check_reload();
+  check_stick_aggregation();
+  check_snapback_modes();
+  check_stick_filters();
+  check_slots_wrap();
+  check_factory_reset();
+
+  return test_result();
+}
@@ -0,0 +1,202 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file test_console_simulator.cpp
+ * \brief Drives the Joybus implementation through console command sequences
+ * with a simulated console, checking every response & reporting what each
+ * command costs to handle
+ */
+
+#include <vector>
+
+#include "console_simulator.hpp"
+#include "host_sdk.hpp"
+#include "joybus.hpp"
+#include "single_pin_joybus.pio.h"
+#include "state.hpp"
+#include "test.hpp"
+
+using bytes = std::vector<uint8_t>;
+
+constexpr uint16_t BUTTONS = (1 << ALWAYS_HIGH) | (1 << A) | (1 << Z);
+constexpr sticks STICKS = {{0x91, 0x32}, {0x7F, 0xE4}};
+constexpr triggers TRIGGERS = {precise_trigger(0x5C), precise_trigger(0xA3)};
+
+constexpr uint8_t HIGH = BUTTONS >> 8;
+constexpr uint8_t LOW = BUTTONS & 0xFF;
+
+const bytes IDENTIFY = {0x09, 0x00, 0x03};
+const bytes ORIGIN_RESPONSE = {0x00, 0x80, 0x7F, 0x7F, 0x7F,
+                               0x7F, 0x00, 0x00, 0x00, 0x00};
+
+// Full state, as sent in mode 3
+bytes mode_3() {
+  return {HIGH, LOW, 0x91, 0x32, 0x7F, 0xE4, 0x5C, 0xA3};
+}
+
+// Full state with analog A & B, as sent by calibrate & long poll
+bytes mode_5() { return {HIGH, LOW, 0x91, 0x32, 0x7F, 0xE4, 0x5C, 0xA3, 0, 0}; }
+
+void set_state() {
+  state.buttons = BUTTONS | (state.origin << ORIGIN);
+  state.analog_sticks.store(STICKS);
+  state.analog_triggers.store(TRIGGERS);
+  update_responses();
+}
+
+// Count of executions of an instruction on the Joybus state machine
+uint executed(uint instruction) {
+  uint count = 0;
+  for (uint executed : host_pio_executed()) {
+    count += executed == instruction;
+  }
+  return count;
+}
+
+void check_connection_sequence(console_simulator &console) {
+  // Probing before the origin is read reports the origin bit
+  CHECK(console.send({0x00}) == IDENTIFY);
+  CHECK(console.send({0xFF}) == IDENTIFY);
+
+  CHECK(console.send({0x41}) == ORIGIN_RESPONSE);
+  CHECK(!state.origin);
+
+  // The first poll reports centered analog values, and sets trigger centers.
+  // Polls after the origin is read don't report the origin bit, even before
+  // the main loop encodes responses without it.
+  CHECK(!state.center_set);
+  CHECK(console.send({0x40, 0x03, 0x00}) ==
+        bytes({HIGH, LOW, 0x7F, 0x7F, 0x7F, 0x7F, 0x00, 0x00}));
+  CHECK(state.center_set);
+  CHECK_EQUAL(state.l_trigger_center, TRIGGERS.l_trigger);
+  CHECK_EQUAL(state.r_trigger_center, TRIGGERS.r_trigger);
+
+  // Later polls report the state
+  CHECK(console.send({0x40, 0x03, 0x00}) == mode_3());
+  CHECK(console.send({0x43, 0x00, 0x00}) == mode_5());
+  set_state();
+  CHECK(console.send({0x40, 0x03, 0x00}) == mode_3());
+}
+
+void check_poll_modes(console_simulator &console) {
+  CHECK(console.send({0x40, 0x00, 0x00}) ==
+        bytes({HIGH, LOW, 0x91, 0x32, 0x7F, 0xE4, 0x5A, 0x00}));
+  CHECK(console.send({0x40, 0x01, 0x00}) ==
+        bytes({HIGH, LOW, 0x91, 0x32, 0x7E, 0x5C, 0xA3, 0x00}));
+  CHECK(console.send({0x40, 0x02, 0x00}) ==
+        bytes({HIGH, LOW, 0x91, 0x32, 0x7E, 0x5A, 0x00, 0x00}));
+  CHECK(console.send({0x40, 0x03, 0x01}) == mode_3());
+  CHECK(console.send({0x40, 0x04, 0x00}) ==
+        bytes({HIGH, LOW, 0x91, 0x32, 0x7F, 0xE4, 0x00, 0x00}));
+
+  // Modes above 4 are treated as mode 0
+  CHECK(console.send({0x40, 0x07, 0x00}) ==
+        bytes({HIGH, LOW, 0x91, 0x32, 0x7F, 0xE4, 0x5A, 0x00}));
+
+  CHECK(console.send({0x42, 0x00, 0x00}) == mode_5());
+  CHECK(console.send({0x43, 0x00, 0x00}) == mode_5());
+}
+
+void check_malformed_commands(console_simulator &console) {
+  uint timeouts = joybus_stats.request_timeouts;
+  uint unknown = joybus_stats.unknown_commands;
+
+  // Truncated commands are abandoned once request bytes stop arriving, and
+  // the next command is handled normally
+  CHECK(console.send({0x40}).empty());
+  CHECK(console.send({0x40, 0x03}).empty());
+  CHECK(console.send({0x43, 0x00}).empty());
+  CHECK_EQUAL(joybus_stats.request_timeouts, timeouts + 3);
+  CHECK(console.send({0x40, 0x03, 0x00}) == mode_3());
+
+  // A timeout which has passed before it's set times out at once
+  host_miss_next_alarm();
+  CHECK(console.send({0x40}).empty());
+  CHECK_EQUAL(joybus_stats.request_timeouts, timeouts + 4);
+  CHECK(console.send({0x00}) == IDENTIFY);
+
+  // Unknown commands aren't responded to
+  CHECK(console.send({0x12}).empty());
+  CHECK(console.send({0x54}).empty());
+  CHECK_EQUAL(joybus_stats.unknown_commands, unknown + 2);
+  CHECK(console.send({0x00}) == IDENTIFY);
+  CHECK(console.send({0x40, 0x03, 0x00}) == mode_3());
+}
+
+void check_timings(console_simulator &console) {
+  // Adapters with fast bits, and consoles at the slow end of their tolerance
+  for (uint32_t byte_us : {32, 36, 40, 44, 47}) {
+    console.set_timing({byte_us, 3, 32, 4});
+    CHECK(console.send({0x40, 0x03, 0x00}) == mode_3());
+    CHECK(console.send({0x00}) == IDENTIFY);
+    CHECK(console.send({0x41}) == ORIGIN_RESPONSE);
+    CHECK(console.send({0x43, 0x00, 0x00}) == mode_5());
+  }
+
+  // Request bytes slower than the timeout are treated as a truncated command
+  uint timeouts = joybus_stats.request_timeouts;
+  console.set_timing({60, 3, 32, 4});
+  CHECK(console.send({0x40, 0x03, 0x00}) != mode_3());
+  CHECK(joybus_stats.request_timeouts > timeouts);
+
+  console.set_timing({});
+  console.idle(1000);
+  CHECK(console.send({0x40, 0x03, 0x00}) == mode_3());
+}
+
+void check_stop_bit_handling(console_simulator &console) {
+  // Each response is preceded by having the state machine read the stop bit
+  uint stop_bit_jump = pio_encode_jmp(single_pin_joybus_offset_read_stop_bit);
+  uint jumps = executed(stop_bit_jump);
+  console.send({0x00});
+  console.send({0x40, 0x03, 0x00});
+  CHECK_EQUAL(executed(stop_bit_jump), jumps + 2);
+
+  // Timeouts clear partial requests out of the state machine
+  uint clears = executed(pio_encode_mov(pio_isr, pio_null));
+  console.send({0x40, 0x03});
+  CHECK_EQUAL(executed(pio_encode_mov(pio_isr, pio_null)), clears + 1);
+}
+
+void measure_command_costs(console_simulator &console) {
+  constexpr uint REPETITIONS = 2000;
+  for (uint i = 0; i < REPETITIONS; ++i) {
+    console.send({0x00});
+    console.send({0x40, 0x03, 0x00});
+    console.send({0x43, 0x00, 0x00});
+    console.send({0x40, 0x03});
+    console.idle(1000);
+  }
+  console.print_command_costs();
+}
+
+int main() {
+  host_set_time_us(1000000);
+  console_simulator console;
+  set_state();
+
+  check_connection_sequence(console);
+  check_poll_modes(console);
+  check_malformed_commands(console);
+  check_timings(console);
+  check_stop_bit_handling(console);
+  measure_command_costs(console);
+
+  return test_result();
+}
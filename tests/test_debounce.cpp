@@ -0,0 +1,156 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_debounce.cpp
+ * \brief Checks that debounced changes are passed on within their configured
+ * times, however they fall between debounce ticks
+ */
+
+#include "configuration.hpp"
+#include "debounce.hpp"
+#include "test.hpp"
+
+constexpr uint16_t BUTTON = 1 << A;
+constexpr uint16_t OTHER_BUTTON = 1 << B;
+
+constexpr uint32_t START_US = 1000000;
+
+// Compile debounce parameters into the current profile. Profiles have no
+// setter for these, so they're written in place.
+void configure(const button_debounce_parameters &parameters) {
+  controller_configuration &config = controller_configuration::get_instance();
+  const_cast<button_debounce_parameters &>(config.debounce_parameters()) =
+      parameters;
+  compile_button_debounce(config);
+}
+
+// Time from a change to it being passed on, updating every microsecond
+uint32_t time_to_pass_on(button_debounce_state &debounce, uint16_t input,
+                         uint32_t changed_at) {
+  for (uint32_t elapsed = 0; elapsed <= 2 * DEBOUNCE_MAX_US; ++elapsed) {
+    if (debounce_buttons(input, changed_at + elapsed, debounce) == input) {
+      return elapsed;
+    }
+  }
+  return UINT32_MAX;
+}
+
+// Debounce state settled on `output`, last updated at `time_us`
+button_debounce_state settled(uint16_t output, uint32_t time_us) {
+  button_debounce_state debounce = {};
+  debounce.output = output;
+  debounce_buttons(output, time_us, debounce);
+  return debounce;
+}
+
+void check_eager() {
+  configure(DEFAULT_BUTTON_DEBOUNCE_PARAMETERS);
+  button_debounce_state debounce = settled(0, START_US);
+  CHECK_EQUAL(time_to_pass_on(debounce, BUTTON, START_US + 10), 0);
+  CHECK_EQUAL(time_to_pass_on(debounce, 0, START_US + 20), 0);
+}
+
+void check_deferred(uint16_t press_us, uint16_t release_us) {
+  configure({0x0000, 0xFFFF, press_us, release_us});
+  uint32_t press_ticks = (press_us + DEBOUNCE_TICK_US - 1) / DEBOUNCE_TICK_US;
+  uint32_t release_ticks =
+      (release_us + DEBOUNCE_TICK_US - 1) / DEBOUNCE_TICK_US;
+
+  // Every phase of the change relative to the ticks
+  for (uint32_t phase = 0; phase < DEBOUNCE_TICK_US; ++phase) {
+    button_debounce_state debounce = settled(0, START_US);
+    uint32_t pressed_at = START_US + phase;
+    uint32_t press = time_to_pass_on(debounce, BUTTON, pressed_at);
+    CHECK(press >= press_us);
+    CHECK(press <= (press_ticks + 1) * DEBOUNCE_TICK_US);
+
+    uint32_t released_at = pressed_at + press + phase;
+    uint32_t release = time_to_pass_on(debounce, 0, released_at);
+    CHECK(release >= release_us);
+    CHECK(release <= (release_ticks + 1) * DEBOUNCE_TICK_US);
+  }
+}
+
+void check_bounce_restarts() {
+  configure({0x0000, 0xFFFF, 1000, 1000});
+  button_debounce_state debounce = settled(0, START_US);
+
+  // Pressed for most of the time, then bouncing back restarts the wait
+  CHECK_EQUAL(debounce_buttons(BUTTON, START_US, debounce), 0);
+  CHECK_EQUAL(debounce_buttons(BUTTON, START_US + 900, debounce), 0);
+  CHECK_EQUAL(debounce_buttons(0, START_US + 950, debounce), 0);
+  CHECK(time_to_pass_on(debounce, BUTTON, START_US + 1000) >= 1000);
+}
+
+void check_buttons_independent() {
+  configure({0x0000, 0xFFFF, 1000, 1000});
+  button_debounce_state debounce = settled(0, START_US);
+
+  // A later press doesn't hold back or hurry an earlier one
+  debounce_buttons(BUTTON, START_US, debounce);
+  debounce_buttons(BUTTON | OTHER_BUTTON, START_US + 500, debounce);
+  CHECK_EQUAL(debounce_buttons(BUTTON | OTHER_BUTTON, START_US + 999, debounce),
+              0);
+  CHECK_EQUAL(debounce_buttons(BUTTON | OTHER_BUTTON, START_US + 1250,
+                               debounce),
+              BUTTON);
+  CHECK_EQUAL(debounce_buttons(BUTTON | OTHER_BUTTON, START_US + 1499,
+                               debounce),
+              BUTTON);
+  CHECK_EQUAL(debounce_buttons(BUTTON | OTHER_BUTTON, START_US + 1750,
+                               debounce),
+              BUTTON | OTHER_BUTTON);
+}
+
+void check_stale_timestamp() {
+  configure({0x0000, 0xFFFF, 1000, 1000});
+
+  // A change taken after a later update is timed from when it was seen, which
+  // must not read as the clock wrapping & confirm it at once
+  for (uint32_t age = 1; age < 2 * DEBOUNCE_TICK_US; ++age) {
+    button_debounce_state debounce = settled(0, START_US + 2000);
+    uint32_t pressed_at = START_US + 2000 - age;
+    CHECK_EQUAL(debounce_buttons(BUTTON, pressed_at, debounce), 0);
+    uint32_t press = time_to_pass_on(debounce, BUTTON, pressed_at);
+    CHECK(press >= 1000);
+    CHECK(press <= age + 1250);
+  }
+
+  // Nor must it confirm changes already waiting
+  for (uint32_t age = 1; age < 2 * DEBOUNCE_TICK_US; ++age) {
+    button_debounce_state debounce = settled(0, START_US);
+    debounce_buttons(BUTTON, START_US, debounce);
+    debounce_buttons(BUTTON, START_US + 500, debounce);
+    CHECK_EQUAL(
+        debounce_buttons(BUTTON | OTHER_BUTTON, START_US + 500 - age, debounce),
+        0);
+    CHECK(time_to_pass_on(debounce, BUTTON, START_US + 500) >= 500);
+  }
+}
+
+int main() {
+  check_eager();
+  check_deferred(1000, 2000);
+  check_deferred(1100, 30);
+  check_deferred(1, DEBOUNCE_MAX_US);
+  check_bounce_restarts();
+  check_buttons_independent();
+  check_stale_timestamp();
+
+  return test_result();
+}
@@ -0,0 +1,105 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_histogram.cpp
+ * \brief Checks histogram counts, statistics & percentiles, including values
+ * past the last bucket
+ */
+
+#include "histogram.hpp"
+#include "test.hpp"
+
+using test_histogram = histogram<8, 4>;
+
+void check_empty() {
+  test_histogram values;
+  CHECK_EQUAL(values.total_count(), 0);
+  CHECK_EQUAL(values.max_value(), 0);
+  CHECK_EQUAL(values.mean_value(), 0);
+  CHECK_EQUAL(values.percentile(99), 0);
+}
+
+void check_buckets() {
+  test_histogram values;
+  for (uint32_t value : {0, 3, 4, 13, 27, 28, 31, 1000}) {
+    values.record(value);
+  }
+
+  CHECK_EQUAL(values.bucket_count(0), 2);
+  CHECK_EQUAL(values.bucket_count(1), 1);
+  CHECK_EQUAL(values.bucket_count(3), 1);
+  CHECK_EQUAL(values.bucket_count(6), 1);
+  // The last bucket counts every value past it
+  CHECK_EQUAL(values.bucket_count(7), 3);
+  CHECK_EQUAL(values.bucket_start(7), 28);
+
+  CHECK_EQUAL(values.total_count(), 8);
+  CHECK_EQUAL(values.max_value(), 1000);
+  CHECK_EQUAL(values.mean_value(), (0 + 3 + 4 + 13 + 27 + 28 + 31 + 1000) / 8);
+
+  values.reset();
+  CHECK_EQUAL(values.total_count(), 0);
+  CHECK_EQUAL(values.bucket_count(7), 0);
+  CHECK_EQUAL(values.max_value(), 0);
+}
+
+void check_percentiles() {
+  // 100 values, one per bucket width step up to 24
+  test_histogram values;
+  for (uint32_t i = 0; i < 100; ++i) {
+    values.record((i * 24) / 100);
+  }
+
+  // Each percentile is the upper bound of the bucket containing it
+  CHECK_EQUAL(values.percentile(0), 3);
+  CHECK_EQUAL(values.percentile(10), 3);
+  CHECK_EQUAL(values.percentile(17), 3);
+  CHECK_EQUAL(values.percentile(18), 7);
+  CHECK_EQUAL(values.percentile(50), 11);
+
+  // But never above the largest value
+  CHECK_EQUAL(values.max_value(), 23);
+  CHECK_EQUAL(values.percentile(100), 23);
+}
+
+void check_overflow_percentiles() {
+  // Values past the last bucket are only bounded by the largest value
+  test_histogram values;
+  for (uint32_t i = 0; i < 98; ++i) {
+    values.record(1);
+  }
+  values.record(500);
+  values.record(64);
+  CHECK_EQUAL(values.percentile(98), 3);
+  CHECK_EQUAL(values.percentile(99), 500);
+  CHECK_EQUAL(values.percentile(100), 500);
+
+  // Including values inside the last bucket's own range
+  test_histogram last_bucket;
+  last_bucket.record(29);
+  CHECK_EQUAL(last_bucket.percentile(50), 29);
+}
+
+int main() {
+  check_empty();
+  check_buckets();
+  check_percentiles();
+  check_overflow_percentiles();
+
+  return test_result();
+}
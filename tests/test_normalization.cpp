@@ -0,0 +1,142 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_normalization.cpp
+ * \brief Checks fixed point polynomial normalization against evaluating the
+ * fitted polynomial in double precision, for every raw value
+ */
+
+#include <cmath>
+
+#include "calibration.hpp"
+#include "curve_fitting.hpp"
+#include "main.hpp"
+#include "test.hpp"
+
+constexpr uint8_t RANGE = 100;
+constexpr uint RAW_VALUES = 1 << STICK_RAW_BITS;
+
+/** \brief Raw reading of an output coordinate, for a sensor with a cubic
+ * response centered at half its range
+ *
+ * \param coordinate Output coordinate
+ * \param cubic Cubic term of the response, relative to full deflection
+ * \param offset Raw offset of the center
+ *
+ * \return Raw value
+ */
+uint16_t raw(double coordinate, double cubic, double offset) {
+  double deflection = (coordinate - CENTER) / RANGE;
+  double response =
+      deflection + (cubic * ((deflection * deflection * deflection) -
+                             deflection));
+  return std::lround((RAW_VALUES / 2) + offset + (response * 1600));
+}
+
+/** \brief Fit a polynomial the way calibration does, for a sensor with the
+ * given response
+ *
+ * \param cubic Cubic term of the response
+ * \param offset Raw offset of the center
+ *
+ * \return Coefficients of the fitted polynomial
+ */
+std::array<double, NUM_COEFFICIENTS> fit(double cubic, double offset) {
+  stick_calibration calibration(RANGE);
+  std::array<uint16_t, NUM_CALIBRATION_STEPS> expected = {};
+  std::array<uint16_t, NUM_CALIBRATION_STEPS> actual = {};
+  std::array<bool, NUM_CALIBRATION_STEPS> skipped = {};
+  stick display;
+  for (size_t step = 0; step < NUM_CALIBRATION_STEPS; ++step) {
+    calibration.display_step(display);
+    calibration.record_measurement(0, 0);
+    expected[step] = display.x;
+    actual[step] = raw(display.x, cubic, offset);
+  }
+
+  return fit_curve<NUM_COEFFICIENTS, NUM_CALIBRATION_STEPS>(expected, actual,
+                                                            skipped);
+}
+
+/** \brief Evaluate a polynomial in double precision, as normalization did
+ * before it moved to fixed point
+ *
+ * \param coefficients Coefficients of the polynomial
+ * \param x Value to evaluate the polynomial at
+ *
+ * \return Value of the polynomial
+ */
+double evaluate_double(const std::array<double, NUM_COEFFICIENTS> &coefficients,
+                       double x) {
+  double ret = 0;
+  double raised_x = 1;
+  for (double coefficient : coefficients) {
+    ret += coefficient * raised_x;
+    raised_x *= x;
+  }
+  return ret;
+}
+
+/** \brief Largest error of fixed point normalization, in units of its last
+ * fractional bit
+ *
+ * Coefficients are rounded to the nearest unit, and each Horner step
+ * truncates by less than a unit.
+ */
+constexpr double MAX_ERROR = NUM_COEFFICIENTS;
+
+void check_fit(double cubic, double offset) {
+  std::array<double, NUM_COEFFICIENTS> coefficients = fit(cubic, offset);
+  std::array<int64_t, NUM_COEFFICIENTS> fixed_point_coefficients =
+      convert_to_fixed_point<NUM_COEFFICIENTS>(coefficients);
+  constexpr double one = 1 << NORMALIZED_FRACTIONAL_BITS;
+
+  uint errors = 0;
+  uint mismatches = 0;
+  for (uint raw_axis = 0; raw_axis < RAW_VALUES; ++raw_axis) {
+    double exact = evaluate_double(coefficients, raw_axis) * one;
+    int32_t normalized = normalize_axis(raw_axis, fixed_point_coefficients);
+    if (std::abs(exact) < INT32_MAX) {
+      errors += std::abs(normalized - exact) > MAX_ERROR;
+    }
+
+    // The output matches exactly, unless the exact value is so close to a
+    // tie that the double evaluation itself can't be relied on to round it
+    double clamped =
+        std::clamp(exact / one, double(CENTER - RANGE), double(CENTER + RANGE));
+    double tie_distance = std::abs(clamped - std::floor(clamped) - 0.5) * one;
+    mismatches += round_and_clamp_axis(normalized, CENTER - RANGE,
+                                       CENTER + RANGE) != std::round(clamped) &&
+                  tie_distance > MAX_ERROR;
+  }
+  if (errors != 0 || mismatches != 0) {
+    std::printf("cubic %g, offset %g:\n", cubic, offset);
+  }
+  CHECK_EQUAL(errors, 0);
+  CHECK_EQUAL(mismatches, 0);
+}
+
+int main() {
+  for (double cubic : {0.0, 0.1, -0.1, 0.25}) {
+    for (double offset : {0.0, 37.0, -120.0}) {
+      check_fit(cubic, offset);
+    }
+  }
+
+  return test_result();
+}
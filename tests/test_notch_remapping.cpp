@@ -0,0 +1,177 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_notch_remapping.cpp
+ * \brief Checks the octant transforms generated from notch calibration, and
+ * that fixed point remapping matches a floating point reference
+ */
+
+#include <cmath>
+#include <random>
+
+#include "calibration.hpp"
+#include "main.hpp"
+#include "test.hpp"
+
+constexpr uint8_t RANGE = 100;
+constexpr double ONE = 1 << NORMALIZED_FRACTIONAL_BITS;
+constexpr double DISPLACEMENT_ONE =
+    1 << (NORMALIZED_FRACTIONAL_BITS - OCTANT_DISPLACEMENT_SHIFT);
+
+// Raw reading of an output coordinate, for a stick read 12 counts per unit
+uint16_t raw(double coordinate) {
+  return std::lround(2048 + ((coordinate - CENTER) * 12));
+}
+
+// Notch displacements, counterclockwise from +x, as a real gate might have
+// them: diagonals pulled in & some notches rotated
+struct notch {
+  double x;
+  double y;
+};
+const std::array<notch, NUM_NOTCHES> GATE = {{{98, 3},
+                                              {64, 75},
+                                              {-2, 101},
+                                              {-61, 66},
+                                              {-97, -4},
+                                              {-70, -62},
+                                              {5, -99},
+                                              {68, -71}}};
+
+// Calibrate a linear stick, with the gate's notches unless skipped
+stick_coefficients calibrate(bool skip_notches) {
+  stick_calibration calibration(RANGE);
+  stick display;
+  for (size_t step = 0; step < NUM_CALIBRATION_STEPS; ++step) {
+    calibration.display_step(display);
+    calibration.record_measurement(raw(display.x), raw(display.y));
+  }
+  for (const notch &gate_notch : GATE) {
+    if (skip_notches) {
+      calibration.skip_measurement();
+    } else {
+      calibration.record_measurement(raw(CENTER + gate_notch.x),
+                                     raw(CENTER + gate_notch.y));
+    }
+  }
+  CHECK(calibration.done());
+
+  stick_coefficients coefficients = {};
+  calibration.generate_coefficients(coefficients);
+  return coefficients;
+}
+
+precise_stick normalize(const stick_coefficients &coefficients, uint16_t x,
+                        uint16_t y) {
+  return {normalize_axis(x, coefficients.x_coefficients),
+          normalize_axis(y, coefficients.y_coefficients)};
+}
+
+// Remap with each octant's matrix in floating point, from the unquantized
+// displacement. The octant is chosen at remapping precision, as the rounded
+// matrices of adjacent octants only agree on the notch between them to
+// within their rounding.
+notch reference_remap(const stick_coefficients &coefficients,
+                      precise_stick normalized_stick) {
+  double x = (normalized_stick.x / ONE) - CENTER;
+  double y = (normalized_stick.y / ONE) - CENTER;
+  int32_t octant_x = std::floor(x * DISPLACEMENT_ONE);
+  int32_t octant_y = std::floor(y * DISPLACEMENT_ONE);
+  for (size_t i = 0; i < NUM_NOTCHES; ++i) {
+    const octant_transform &octant = coefficients.octants[i];
+    const octant_transform &next = coefficients.octants[(i + 1) % NUM_NOTCHES];
+    if ((octant.start_x * octant_y) - (octant.start_y * octant_x) >= 0 &&
+        (octant_x * next.start_y) - (octant_y * next.start_x) > 0) {
+      constexpr double scale = 1 << OCTANT_MATRIX_FRACTIONAL_BITS;
+      return {((octant.matrix[0] * x) + (octant.matrix[1] * y)) / scale,
+              ((octant.matrix[2] * x) + (octant.matrix[3] * y)) / scale};
+    }
+  }
+  return {x, y};
+}
+
+void check_notches_hit_targets() {
+  stick_coefficients coefficients = calibrate(false);
+
+  // Notch calibration steps display each notch's target
+  stick_calibration targets(RANGE);
+  for (size_t step = 0; step < NUM_CALIBRATION_STEPS; ++step) {
+    targets.skip_measurement();
+  }
+  for (size_t i = 0; i < NUM_NOTCHES; ++i) {
+    stick target;
+    targets.display_step(target);
+    targets.skip_measurement();
+
+    precise_stick remapped = remap_notches(
+        normalize(coefficients, raw(CENTER + GATE[i].x),
+                  raw(CENTER + GATE[i].y)),
+        coefficients.octants);
+    CHECK(std::abs((remapped.x / ONE) - target.x) < 0.05);
+    CHECK(std::abs((remapped.y / ONE) - target.y) < 0.05);
+  }
+}
+
+void check_matches_reference() {
+  stick_coefficients coefficients = calibrate(false);
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int32_t> axis((CENTER - 127) * ONE,
+                                              (CENTER + 127) * ONE);
+  double worst = 0;
+  for (uint i = 0; i < 100000; ++i) {
+    precise_stick normalized_stick = {axis(rng), axis(rng)};
+    precise_stick remapped =
+        remap_notches(normalized_stick, coefficients.octants);
+    notch expected = reference_remap(coefficients, normalized_stick);
+    worst = std::max(worst, std::abs((remapped.x / ONE) - CENTER - expected.x));
+    worst = std::max(worst, std::abs((remapped.y / ONE) - CENTER - expected.y));
+  }
+
+  // Displacements are remapped with 8 fractional bits, their error magnified
+  // by at most the sum of a matrix row
+  CHECK(worst <= 2 / DISPLACEMENT_ONE);
+}
+
+void check_identity_octants_exact() {
+  // Skipped notches map to themselves, leaving every octant unchanged
+  stick_coefficients coefficients = calibrate(true);
+  for (const octant_transform &octant : coefficients.octants) {
+    CHECK(octant.matrix == OCTANT_IDENTITY_MATRIX);
+  }
+
+  std::mt19937 rng(2);
+  std::uniform_int_distribution<int32_t> axis((CENTER - 127) * ONE,
+                                              (CENTER + 127) * ONE);
+  uint changed = 0;
+  for (uint i = 0; i < 100000; ++i) {
+    precise_stick normalized_stick = {axis(rng), axis(rng)};
+    precise_stick remapped =
+        remap_notches(normalized_stick, coefficients.octants);
+    changed += remapped.x != normalized_stick.x ||
+               remapped.y != normalized_stick.y;
+  }
+  CHECK_EQUAL(changed, 0);
+}
+
+int main() {
+  check_notches_hit_targets();
+  check_matches_reference();
+  check_identity_octants_exact();
+
+  return test_result();
+}
@@ -0,0 +1,209 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_oversampling.cpp
+ * \brief Checks the stick oversampling ring & the configured reduction
+ * against a reference, and its outlier rejection & noise reduction
+ *
+ * Built once for each `STICK_OVERSAMPLING_REDUCTION`. Also prints the noise
+ * reduction & lag for each number of samples.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "oversampling.hpp"
+#include "test.hpp"
+
+/// \brief Largest number of samples checked
+constexpr uint MAX_SAMPLES = 9;
+
+/** \brief Reduce samples the slow & obvious way
+ *
+ * \param samples Samples to reduce
+ *
+ * \return Reduced value
+ */
+uint16_t reference_reduction(std::vector<uint16_t> samples) {
+  std::sort(samples.begin(), samples.end());
+  uint count = samples.size();
+
+#if STICK_OVERSAMPLING_REDUCTION == TRIMMED_MEAN
+  uint trim = std::max<uint>(count / 4, count >= 3 ? 1 : 0);
+  double sum = 0;
+  for (uint i = trim; i < count - trim; ++i) {
+    sum += samples[i];
+  }
+  return std::floor((sum / (count - (2 * trim))) + 0.5);
+#else
+  if (count % 2 == 0) {
+    return std::floor(
+        ((samples[(count / 2) - 1] + samples[count / 2]) / 2.0) + 0.5);
+  }
+  return samples[count / 2];
+#endif
+}
+
+/** \brief Reduce samples with the firmware's reduction
+ *
+ * \param samples Samples to reduce
+ *
+ * \return Reduced value
+ */
+uint16_t reduce(const std::vector<uint16_t> &samples) {
+  std::array<uint16_t, MAX_SAMPLES> array = {};
+  std::copy(samples.begin(), samples.end(), array.begin());
+  return reduce_axis_samples<MAX_SAMPLES>(array, samples.size());
+}
+
+void check_reduction() {
+  std::mt19937 generator(5);
+  std::uniform_int_distribution<uint16_t> value(0, UINT16_MAX);
+  std::uniform_int_distribution<uint16_t> small_value(0, 3);
+
+  uint mismatches = 0;
+  for (uint count = 1; count <= MAX_SAMPLES; ++count) {
+    for (uint trial = 0; trial < 10000; ++trial) {
+      // Wide values exercise overflow, & narrow ones ties & rounding
+      std::vector<uint16_t> samples(count);
+      for (uint16_t &sample : samples) {
+        sample = trial % 2 == 0 ? value(generator) : small_value(generator);
+      }
+      mismatches += reduce(samples) != reference_reduction(samples);
+    }
+  }
+  CHECK_EQUAL(mismatches, 0);
+}
+
+void check_outliers() {
+  // A single corrupted sample among three or more doesn't move the result
+  // outside the good samples
+  for (uint count = 3; count <= MAX_SAMPLES; ++count) {
+    for (uint16_t outlier : {0, UINT16_MAX}) {
+      for (uint position = 0; position < count; ++position) {
+        std::vector<uint16_t> samples(count);
+        for (uint i = 0; i < count; ++i) {
+          samples[i] = 2040 + ((i * 5) % 11);
+        }
+        samples[position] = outlier;
+        uint16_t reduced = reduce(samples);
+        CHECK(reduced >= 2040 && reduced <= 2050);
+      }
+    }
+  }
+}
+
+void check_ring() {
+  stick_oversampler<4> oversampler;
+
+  // Until the ring fills, only the samples recorded are reduced
+  oversampler.record({100, 200, false, 1000});
+  raw_stick reduced = oversampler.reduce();
+  CHECK_EQUAL(reduced.x, 100);
+  CHECK_EQUAL(reduced.y, 200);
+  CHECK(reduced.fresh);
+  CHECK_EQUAL(reduced.timestamp, 1000);
+  oversampler.record({110, 210, false, 2000});
+  oversampler.record({120, 220, false, 3000});
+  reduced = oversampler.reduce();
+  CHECK_EQUAL(reduced.x, reference_reduction({100, 110, 120}));
+  CHECK_EQUAL(reduced.timestamp, 2000);
+
+  // Once full, the oldest samples are replaced, and the timestamp is that of
+  // the middle sample of those kept
+  for (uint i = 3; i < 10; ++i) {
+    oversampler.record({static_cast<uint16_t>(100 + (i * 10)),
+                        static_cast<uint16_t>(200 + (i * 10)), false,
+                        (i + 1) * 1000});
+  }
+  reduced = oversampler.reduce();
+  CHECK_EQUAL(reduced.x, reference_reduction({160, 170, 180, 190}));
+  CHECK_EQUAL(reduced.y, reference_reduction({260, 270, 280, 290}));
+  CHECK_EQUAL(reduced.timestamp, 8000);
+
+  // A reset discards every sample
+  oversampler.reset();
+  oversampler.record({500, 600, false, 20000});
+  reduced = oversampler.reduce();
+  CHECK_EQUAL(reduced.x, 500);
+  CHECK_EQUAL(reduced.y, 600);
+  CHECK_EQUAL(reduced.timestamp, 20000);
+}
+
+/** \brief RMS error of the reduction of noisy samples
+ *
+ * \param count Number of samples reduced
+ * \param corrupted Fraction of samples replaced with a random value
+ *
+ * \return RMS error, in raw units
+ */
+double rms_error(uint count, double corrupted) {
+  std::mt19937 generator(count);
+  std::normal_distribution<double> noise(0, 8);
+  std::uniform_real_distribution<double> chance(0, 1);
+  std::uniform_int_distribution<uint16_t> corruption(0, 4095);
+
+  constexpr uint16_t value = 2048;
+  double squared_error = 0;
+  constexpr uint trials = 20000;
+  for (uint trial = 0; trial < trials; ++trial) {
+    std::vector<uint16_t> samples(count);
+    for (uint16_t &sample : samples) {
+      sample = chance(generator) < corrupted
+                   ? corruption(generator)
+                   : std::lround(value + noise(generator));
+    }
+    double error = reduce(samples) - value;
+    squared_error += error * error;
+  }
+  return std::sqrt(squared_error / trials);
+}
+
+void check_noise() {
+  std::printf("%7s %13s %13s %13s\n", "samples", "noise", "1% corrupted",
+              "lag (samples)");
+  double single = rms_error(1, 0);
+  double single_corrupted = rms_error(1, 0.01);
+  for (uint count = 1; count <= 8; ++count) {
+    double clean = rms_error(count, 0) / single;
+    double corrupted = rms_error(count, 0.01) / single;
+    std::printf("%7u %12.0f%% %12.0f%% %13.1f\n", count, clean * 100,
+                corrupted * 100, (count - 1) / 2.0);
+
+    // As documented for OPENGCC_STICK_OVERSAMPLING
+    if (count == 4) {
+      CHECK(clean > 0.5 && clean < 0.62);
+    } else if (count == 8) {
+      CHECK(clean > 0.37 && clean < 0.46);
+    }
+    if (count >= 4) {
+      CHECK(corrupted * 10 < single_corrupted / single);
+    }
+  }
+}
+
+int main() {
+  check_reduction();
+  check_outliers();
+  check_ring();
+  check_noise();
+
+  return test_result();
+}
@@ -0,0 +1,102 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_press_latching.cpp
+ * \brief Checks that presses shorter than a poll interval are reported by
+ * exactly one response when latched, then released
+ */
+
+#include <vector>
+
+#include "console_simulator.hpp"
+#include "host_sdk.hpp"
+#include "joybus.hpp"
+#include "state.hpp"
+#include "test.hpp"
+
+using bytes = std::vector<uint8_t>;
+
+constexpr uint16_t RELEASED = 1 << ALWAYS_HIGH;
+constexpr uint16_t PRESSED = RELEASED | (1 << A);
+
+// Whether A is pressed in a poll response
+bool poll_reports_press(console_simulator &console) {
+  bytes response = console.send({0x40, 0x03, 0x00});
+  return response.size() == 8 && ((response[0] << 8) & (1 << A));
+}
+
+// Tap A for less than a poll interval, between polls 1ms apart
+void tap(console_simulator &console) {
+  console.idle(300);
+  state.buttons = PRESSED;
+  console.idle(300);
+  state.buttons = RELEASED;
+  console.idle(300);
+}
+
+void check_tap_reported_once(console_simulator &console) {
+  set_press_latching(true);
+  for (uint round = 0; round < 100; ++round) {
+    poll_reports_press(console);
+    tap(console);
+    CHECK(poll_reports_press(console));
+    console.idle(900);
+    CHECK(!poll_reports_press(console));
+  }
+}
+
+void check_held_press_released(console_simulator &console) {
+  // A press held over several polls is reported by each, & not after
+  set_press_latching(true);
+  state.buttons = PRESSED;
+  for (uint poll = 0; poll < 3; ++poll) {
+    console.idle(900);
+    CHECK(poll_reports_press(console));
+  }
+  state.buttons = RELEASED;
+  console.idle(900);
+  CHECK(!poll_reports_press(console));
+}
+
+void check_tap_missed_unlatched(console_simulator &console) {
+  set_press_latching(false);
+  for (uint round = 0; round < 100; ++round) {
+    poll_reports_press(console);
+    tap(console);
+    CHECK(!poll_reports_press(console));
+  }
+}
+
+int main() {
+  host_set_time_us(1000000);
+  console_simulator console;
+
+  // The main loop publishes the current state whenever time passes
+  state.buttons = RELEASED;
+  console.set_background([] { update_responses(); });
+
+  // Get the console past origin & centering
+  console.send({0x41});
+  console.send({0x40, 0x03, 0x00});
+
+  check_tap_reported_once(console);
+  check_held_press_released(console);
+  check_tap_missed_unlatched(console);
+
+  return test_result();
+}
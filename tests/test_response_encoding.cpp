@@ -0,0 +1,127 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file test_response_encoding.cpp
+ * \brief Checks that pre-encoded responses match encoding on demand, and are
+ * never changed while being transmitted
+ */
+
+#include <random>
+#include <vector>
+
+#include "console_simulator.hpp"
+#include "host_sdk.hpp"
+#include "joybus.hpp"
+#include "state.hpp"
+#include "test.hpp"
+
+using bytes = std::vector<uint8_t>;
+
+std::mt19937 rng(1);
+
+void randomize_state() {
+  std::uniform_int_distribution<uint> byte(0, 255);
+  std::uniform_int_distribution<uint> trigger(0, TRIGGER_MAX);
+  state.buttons = (std::uniform_int_distribution<uint>(0, 0xFFFF)(rng) &
+                   ~(1 << ORIGIN)) |
+                  (1 << ALWAYS_HIGH) | (state.origin << ORIGIN);
+  state.analog_sticks.store(
+      {{static_cast<uint8_t>(byte(rng)), static_cast<uint8_t>(byte(rng))},
+       {static_cast<uint8_t>(byte(rng)), static_cast<uint8_t>(byte(rng))}});
+  state.analog_triggers.store({static_cast<uint16_t>(trigger(rng)),
+                               static_cast<uint16_t>(trigger(rng))});
+}
+
+// Encode the current state on demand, as responses were before being
+// pre-encoded
+bytes encode_now(uint8_t mode) {
+  joybus_response response = {};
+  uint8_t length = encode_mode(mode, state.buttons, state.analog_sticks.load(),
+                               state.analog_triggers.load(), response);
+  return bytes(response.begin(), response.begin() + length);
+}
+
+void check_every_mode(console_simulator &console) {
+  for (uint round = 0; round < 1000; ++round) {
+    randomize_state();
+    update_responses();
+
+    for (uint8_t mode = 0; mode <= 4; ++mode) {
+      CHECK(console.send({0x40, mode, 0x00}) == encode_now(mode));
+    }
+    CHECK(console.send({0x42, 0x00, 0x00}) == encode_now(5));
+    CHECK(console.send({0x43, 0x00, 0x00}) == encode_now(5));
+    CHECK(console.send({0x41}) == encode_now(6));
+  }
+}
+
+void check_only_changes_encoded() {
+  randomize_state();
+  update_responses();
+  const uint8_t *published = mode_response(3).data;
+
+  // Unchanged state is left in the published buffer
+  update_responses();
+  CHECK(mode_response(3).data == published);
+
+  // Any change is encoded into another buffer
+  state.buttons ^= 1 << A;
+  update_responses();
+  CHECK(mode_response(3).data != published);
+}
+
+void check_transmission_unchanged(console_simulator &console) {
+  // The state changes & is published again while each response is being
+  // transmitted, so a response would mix states if its buffer was reused
+  std::vector<bytes> published;
+  console.set_background([&] {
+    randomize_state();
+    update_responses();
+    published.push_back(encode_now(3));
+  });
+
+  uint torn = 0;
+  for (uint poll = 0; poll < 1000; ++poll) {
+    published.clear();
+    bytes response = console.send({0x40, 0x03, 0x00});
+    bool whole = false;
+    for (const bytes &frame : published) {
+      whole |= frame == response;
+    }
+    torn += !whole;
+  }
+  console.set_background(nullptr);
+
+  CHECK_EQUAL(torn, 0);
+}
+
+int main() {
+  host_set_time_us(1000000);
+  console_simulator console;
+
+  // Get the console past origin & centering
+  console.send({0x41});
+  console.send({0x40, 0x03, 0x00});
+
+  check_every_mode(console);
+  check_only_changes_encoded();
+  check_transmission_unchanged(console);
+
+  return test_result();
+}
@@ -0,0 +1,98 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file test_seqlock.cpp
+ * \brief Checks that seqlock readers only ever see whole snapshots
+ */
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include "seqlock.hpp"
+#include "test.hpp"
+
+/// \brief Snapshot whose fields are all derived from one counter
+struct snapshot {
+  uint32_t counter;
+  std::array<uint32_t, 7> derived;
+};
+
+snapshot make_snapshot(uint32_t counter) {
+  snapshot value = {counter, {}};
+  for (uint i = 0; i < value.derived.size(); ++i) {
+    value.derived[i] = (counter * (i + 3)) ^ (0x5A5A5A5A << i);
+  }
+  return value;
+}
+
+bool is_whole(const snapshot &value) {
+  snapshot expected = make_snapshot(value.counter);
+  return value.derived == expected.derived;
+}
+
+void check_single_thread() {
+  seqlock<snapshot> shared(make_snapshot(7));
+  CHECK_EQUAL(shared.load().counter, 7);
+  CHECK(is_whole(shared.load()));
+
+  shared.store(make_snapshot(8));
+  CHECK_EQUAL(shared.load().counter, 8);
+  CHECK(is_whole(shared.load()));
+}
+
+void check_concurrent_writer() {
+  constexpr uint32_t WRITES = 2000000;
+
+  seqlock<snapshot> shared(make_snapshot(0));
+  std::atomic<bool> done = false;
+
+  // Reader checks each snapshot is whole & never older than the last one
+  uint32_t torn_reads = 0;
+  uint32_t backwards_reads = 0;
+  uint32_t reads = 0;
+  std::thread reader([&] {
+    uint32_t last_counter = 0;
+    while (!done.load()) {
+      snapshot value = shared.load();
+      torn_reads += !is_whole(value);
+      backwards_reads += value.counter < last_counter;
+      last_counter = value.counter;
+      ++reads;
+    }
+  });
+
+  for (uint32_t counter = 1; counter <= WRITES; ++counter) {
+    shared.store(make_snapshot(counter));
+  }
+  done = true;
+  reader.join();
+
+  std::printf("%u reads during %u writes\n", reads, WRITES);
+  CHECK(reads > 0);
+  CHECK_EQUAL(torn_reads, 0);
+  CHECK_EQUAL(backwards_reads, 0);
+  CHECK_EQUAL(shared.load().counter, WRITES);
+}
+
+int main() {
+  check_single_thread();
+  check_concurrent_writer();
+  return test_result();
+}
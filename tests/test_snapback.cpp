@@ -0,0 +1,271 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_snapback.cpp
+ * \brief Replays stick traces through the snapback filter at several sample
+ * rates, checking that releases are rejected & deliberate movements pass
+ *
+ * Prints, for each trace & sample rate, whether the opposite swing of a
+ * release was rejected, the furthest the output went past center, and the
+ * latency the filter added. Then compares the residual oscillation & added
+ * latency of `wave_snapback` & `velocity_snapback`.
+ *
+ * \note The traces are synthetic, not recorded. Releases are damped
+ * oscillations with periods of 4-7 ms around the default
+ * `natural_period_us`, and deliberate movements are constant speed moves.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "snapback.hpp"
+#include "test.hpp"
+
+constexpr int32_t ONE = 1 << NORMALIZED_FRACTIONAL_BITS;
+constexpr int32_t CENTER_AXIS = CENTER * ONE;
+
+/** \brief Displacement most games read as an input, in output units
+ *
+ * A tilt in Melee starts at 23 units, which is also past every game's dead
+ * zone.
+ */
+constexpr double INPUT_DISPLACEMENT = 23;
+
+/// \brief Times between samples to replay traces at, in microseconds
+constexpr std::array<uint32_t, 4> SAMPLE_PERIODS_US = {80, 160, 250, 500};
+
+/// \brief Length of each trace, in microseconds
+constexpr uint32_t TRACE_US = 40000;
+
+/// \brief Time in each trace before it starts moving, in microseconds
+constexpr uint32_t TRACE_START_US = 10000;
+
+/// \brief Stick trace, as displacement of the x-axis over time
+struct trace {
+  /// \brief Name of the trace
+  const char *name;
+  /// \brief `true` for a release, whose opposite swing should be rejected
+  bool release;
+  /// \brief Displacement in output units, by microseconds since the start
+  std::function<double(double)> displacement;
+};
+
+/** \brief Release of a stick held at a displacement, as a damped oscillation
+ *
+ * \param from Held displacement
+ * \param period_us Period of the oscillation
+ * \param damping Damping ratio
+ *
+ * \return Displacement by time
+ */
+std::function<double(double)> release(double from, double period_us,
+                                      double damping) {
+  return [=](double time_us) {
+    if (time_us < TRACE_START_US) {
+      return from;
+    }
+    double t = time_us - TRACE_START_US;
+    double frequency = 2 * M_PI / period_us;
+    double damped_frequency = frequency * std::sqrt(1 - (damping * damping));
+    return from * std::exp(-damping * frequency * t) *
+           (std::cos(damped_frequency * t) +
+            (damping / std::sqrt(1 - (damping * damping))) *
+                std::sin(damped_frequency * t));
+  };
+}
+
+/** \brief Deliberate movement at a constant speed
+ *
+ * \param from Starting displacement
+ * \param to Final displacement
+ * \param duration_us Time taken
+ *
+ * \return Displacement by time
+ */
+std::function<double(double)> movement(double from, double to,
+                                       double duration_us) {
+  return [=](double time_us) {
+    double progress =
+        std::clamp((time_us - TRACE_START_US) / duration_us, 0.0, 1.0);
+    return from + ((to - from) * progress);
+  };
+}
+
+/// \brief Result of replaying a trace
+struct replay_result {
+  /// \brief Furthest the output went past center, opposite where it started
+  double overshoot;
+  /** \brief Total time the output was an output unit or more from the input,
+   * in microseconds
+   */
+  uint32_t deviated;
+  /** \brief Time from the input settling to the output following it within
+   * an output unit for good, in microseconds
+   */
+  uint32_t latency;
+};
+
+/** \brief Replay a trace through the snapback filter
+ *
+ * \param replayed Trace to replay
+ * \param parameters Snapback filter parameters
+ * \param period_us Time between samples
+ *
+ * \return Result of the replay
+ */
+replay_result replay(const trace &replayed,
+                     const snapback_parameters &parameters,
+                     uint32_t period_us) {
+  stick_snapback_state snapback_state = {};
+  double start = replayed.displacement(0);
+  replay_result result = {0, 0, 0};
+
+  // Settled once the input stays within an output unit of where it ends
+  double end = replayed.displacement(TRACE_US);
+  uint32_t settled_at = 0;
+  uint32_t following_since = 0;
+  bool following = false;
+  for (uint32_t time_us = 0; time_us <= TRACE_US; time_us += period_us) {
+    double input = replayed.displacement(time_us);
+    precise_stick filtered = unsnap_stick(
+        {CENTER_AXIS + static_cast<int32_t>(std::lround(input * ONE)),
+         CENTER_AXIS},
+        time_us + 1000000, parameters, snapback_state);
+    double output = static_cast<double>(filtered.x - CENTER_AXIS) / ONE;
+
+    result.overshoot = std::max(result.overshoot, start > 0 ? -output : output);
+    if (std::abs(input - end) >= 1) {
+      settled_at = time_us + period_us;
+    }
+    if (std::abs(output - input) >= 1) {
+      result.deviated += period_us;
+    }
+    if (std::abs(output - input) < 1) {
+      if (!following) {
+        following = true;
+        following_since = time_us;
+      }
+    } else {
+      following = false;
+    }
+  }
+  result.latency = following && following_since > settled_at
+                       ? following_since - settled_at
+                       : 0;
+  if (!following) {
+    result.latency = UINT32_MAX;
+  }
+  return result;
+}
+
+/// \brief Traces replayed
+const std::vector<trace> TRACES = {
+    {"release from 100, 6 ms, 0.2 damping", true, release(100, 6000, 0.2)},
+    {"release from 80, 5 ms, 0.3 damping", true, release(80, 5000, 0.3)},
+    {"release from 60, 7 ms, 0.15 damping", true, release(60, 7000, 0.15)},
+    {"release from -90, 4 ms, 0.25 damping", true, release(-90, 4000, 0.25)},
+    {"flick from 100 to -100 in 4 ms", false, movement(100, -100, 4000)},
+    {"flick from -80 to 80 in 2 ms", false, movement(-80, 80, 2000)},
+    {"move from 0 to 100 in 10 ms", false, movement(0, 100, 10000)},
+};
+
+void check_traces(const snapback_parameters &parameters) {
+  std::printf("%-38s %7s %8s %10s %11s %11s\n", "trace", "period",
+              "rejected", "overshoot", "deviated", "latency");
+  for (const trace &replayed : TRACES) {
+    uint32_t reference_latency = 0;
+    for (uint32_t period_us : SAMPLE_PERIODS_US) {
+      replay_result result = replay(replayed, parameters, period_us);
+      bool rejected = result.overshoot < INPUT_DISPLACEMENT;
+      if (replayed.release) {
+        std::printf("%-38s %4u us %8s %8.1f u %8u us %8u us\n",
+                    replayed.name, period_us, rejected ? "yes" : "no",
+                    result.overshoot, result.deviated, result.latency);
+        CHECK(rejected);
+      } else {
+        std::printf("%-38s %4u us %8s %10s %8u us %8u us\n", replayed.name,
+                    period_us, "-", "-", result.deviated, result.latency);
+
+        // Deliberate movements always get through, within a wave, and are
+        // untouched unless they cross center
+        CHECK(result.latency <= parameters.wave_duration_us);
+        if (replayed.displacement(0) * replayed.displacement(TRACE_US) >= 0) {
+          CHECK_EQUAL(result.deviated, 0);
+        }
+      }
+
+      // The filter acts on time rather than samples, so results only differ
+      // by the few samples it takes to see the stick change direction
+      if (period_us == SAMPLE_PERIODS_US[0]) {
+        reference_latency = result.latency;
+      }
+      uint32_t difference = std::max(result.latency, reference_latency) -
+                            std::min(result.latency, reference_latency);
+      CHECK(difference <= 4 * period_us);
+    }
+  }
+}
+
+void compare_modes() {
+  snapback_parameters wave = DEFAULT_SNAPBACK_PARAMETERS;
+  wave.mode = wave_snapback;
+  snapback_parameters velocity = DEFAULT_SNAPBACK_PARAMETERS;
+  velocity.mode = velocity_snapback;
+
+  std::printf("\n%-38s %7s %32s %32s\n", "", "", "wave", "velocity");
+  std::printf("%-38s %7s %10s %10s %10s %10s %10s %10s\n", "trace", "period",
+              "residual", "deviated", "latency", "residual", "deviated",
+              "latency");
+  for (const trace &replayed : TRACES) {
+    for (uint32_t period_us : SAMPLE_PERIODS_US) {
+      replay_result wave_result = replay(replayed, wave, period_us);
+      replay_result velocity_result = replay(replayed, velocity, period_us);
+      if (replayed.release) {
+        std::printf("%-38s %4u us %8.1f u %7u us %10s %8.1f u %7u us %10s\n",
+                    replayed.name, period_us, wave_result.overshoot,
+                    wave_result.deviated, "-", velocity_result.overshoot,
+                    velocity_result.deviated, "-");
+
+        // Velocity mode is tuned for sensors sampled every 80 us or so, and
+        // lets more of the opposite swing through when sampled less often
+        if (period_us == SAMPLE_PERIODS_US[0]) {
+          CHECK(velocity_result.overshoot < INPUT_DISPLACEMENT);
+        }
+      } else {
+        std::printf("%-38s %4u us %10s %7u us %7u us %10s %7u us %7u us\n",
+                    replayed.name, period_us, "-", wave_result.deviated,
+                    wave_result.latency, "-", velocity_result.deviated,
+                    velocity_result.latency);
+
+        // Velocity mode only slows a deliberate movement down while it's
+        // under way, never holding it back once it's finished
+        CHECK_EQUAL(velocity_result.latency, 0);
+        CHECK(velocity_result.deviated <= wave_result.deviated);
+      }
+    }
+  }
+}
+
+int main() {
+  check_traces(DEFAULT_SNAPBACK_PARAMETERS);
+  compare_modes();
+
+  return test_result();
+}
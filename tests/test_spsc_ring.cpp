@@ -0,0 +1,115 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file test_spsc_ring.cpp
+ * \brief Checks that the SPSC ring delivers every item in order, and drops
+ * rather than overwrites when full
+ */
+
+#include <atomic>
+#include <thread>
+
+#include "spsc_ring.hpp"
+#include "test.hpp"
+
+/// \brief Item whose fields are both derived from one counter
+struct item {
+  uint32_t counter;
+  uint32_t check;
+};
+
+item make_item(uint32_t counter) { return {counter, ~counter * 2654435761u}; }
+
+void check_single_thread() {
+  constexpr uint CAPACITY = 8;
+  spsc_ring<item, CAPACITY> ring;
+
+  item out;
+  CHECK(!ring.pop(out));
+  CHECK_EQUAL(ring.size(), 0);
+
+  // Fill the ring, then push once more
+  for (uint32_t i = 0; i < CAPACITY; ++i) {
+    CHECK(ring.push(make_item(i)));
+  }
+  CHECK_EQUAL(ring.size(), CAPACITY);
+  CHECK(!ring.push(make_item(CAPACITY)));
+  CHECK_EQUAL(ring.dropped_count(), 1);
+
+  // The dropped item didn't overwrite the oldest one
+  CHECK(ring.pop(out));
+  CHECK_EQUAL(out.counter, 0);
+
+  // Indices keep wrapping around the ring
+  uint32_t next_push = CAPACITY;
+  uint32_t next_pop = 1;
+  for (uint round = 0; round < 5 * CAPACITY; ++round) {
+    CHECK(ring.push(make_item(next_push++)));
+    CHECK(ring.pop(out));
+    CHECK_EQUAL(out.counter, next_pop++);
+  }
+  while (ring.pop(out)) {
+    CHECK_EQUAL(out.counter, next_pop++);
+  }
+  CHECK_EQUAL(next_pop, next_push);
+  CHECK_EQUAL(ring.size(), 0);
+}
+
+void check_concurrent_producer() {
+  constexpr uint32_t ITEMS = 2000000;
+  spsc_ring<item, 64> ring;
+
+  // Producer retries an item until it's queued, counting rejections
+  uint32_t rejected = 0;
+  std::thread producer([&] {
+    for (uint32_t counter = 0; counter < ITEMS; ++counter) {
+      while (!ring.push(make_item(counter))) {
+        ++rejected;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 0;
+  uint32_t out_of_order = 0;
+  uint32_t corrupt = 0;
+  while (expected < ITEMS) {
+    item out;
+    if (!ring.pop(out)) {
+      std::this_thread::yield();
+      continue;
+    }
+    out_of_order += out.counter != expected;
+    corrupt += out.check != make_item(out.counter).check;
+    expected = out.counter + 1;
+  }
+  producer.join();
+
+  std::printf("%u items, %u rejected as full\n", ITEMS, rejected);
+  CHECK_EQUAL(out_of_order, 0);
+  CHECK_EQUAL(corrupt, 0);
+  CHECK_EQUAL(ring.dropped_count(), rejected);
+  CHECK_EQUAL(ring.size(), 0);
+}
+
+int main() {
+  check_single_thread();
+  check_concurrent_producer();
+  return test_result();
+}
@@ -0,0 +1,187 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_stick_aggregation.cpp
+ * \brief Checks each aggregation of stick samples between polls, and that
+ * output hysteresis holds the aggregate that's reported
+ */
+
+#include <cmath>
+#include <random>
+
+#include "main.hpp"
+#include "stick_aggregation.hpp"
+#include "test.hpp"
+
+constexpr int32_t ONE = 1 << NORMALIZED_FRACTIONAL_BITS;
+
+// Stick at a displacement from center, in 256ths of an output unit
+precise_stick at(int32_t x, int32_t y) {
+  return {(CENTER * ONE) + (x * (ONE >> 8)), (CENTER * ONE) + (y * (ONE >> 8))};
+}
+
+bool same(precise_stick a, precise_stick b) { return a.x == b.x && a.y == b.y; }
+
+void check_latest() {
+  stick_aggregation_state state = {};
+  aggregate_stick(at(100, -3), 1, state);
+  aggregate_stick(at(-7, 9), 1, state);
+  CHECK(same(aggregated_stick(latest_aggregation, 1, state), at(-7, 9)));
+}
+
+void check_mean() {
+  stick_aggregation_state state = {};
+  aggregate_stick(at(3, -3), 1, state);
+  aggregate_stick(at(4, -4), 1, state);
+  aggregate_stick(at(4, -4), 1, state);
+  CHECK(same(aggregated_stick(mean_aggregation, 1, state), at(4, -4)));
+
+  // Halves round away from center
+  state = {};
+  aggregate_stick(at(1, -1), 1, state);
+  aggregate_stick(at(2, -2), 1, state);
+  CHECK(same(aggregated_stick(mean_aggregation, 1, state), at(2, -2)));
+
+  // Displacements are clamped, so far samples can't overflow the sums
+  state = {};
+  for (uint i = 0; i < STICK_AGGREGATION_MAX_SAMPLES; ++i) {
+    aggregate_stick({INT32_MAX, INT32_MIN}, 1, state);
+  }
+  CHECK(same(aggregated_stick(mean_aggregation, 1, state),
+             at(STICK_AGGREGATION_MAX_DISPLACEMENT,
+                -STICK_AGGREGATION_MAX_DISPLACEMENT)));
+}
+
+void check_extreme() {
+  stick_aggregation_state state = {};
+  aggregate_stick(at(10, 0), 1, state);
+  aggregate_stick(at(0, -5000), 1, state);
+  aggregate_stick(at(3000, 0), 1, state);
+  CHECK(same(aggregated_stick(extreme_aggregation, 1, state), at(0, -5000)));
+
+  // Ties keep the earlier sample
+  aggregate_stick(at(5000, 0), 1, state);
+  CHECK(same(aggregated_stick(extreme_aggregation, 1, state), at(0, -5000)));
+}
+
+void check_epochs() {
+  stick_aggregation_state state = {};
+  aggregate_stick(at(4000, 0), 1, state);
+  aggregate_stick(at(0, 0), 1, state);
+
+  // Without samples in the new epoch, the newest sample is reported
+  for (stick_aggregation_mode mode :
+       {latest_aggregation, mean_aggregation, extreme_aggregation}) {
+    CHECK(same(aggregated_stick(mode, 2, state), at(0, 0)));
+  }
+
+  // Samples of the previous epoch are forgotten
+  aggregate_stick(at(20, 20), 2, state);
+  CHECK(same(aggregated_stick(mean_aggregation, 2, state), at(20, 20)));
+  CHECK(same(aggregated_stick(extreme_aggregation, 2, state), at(20, 20)));
+
+}
+
+void check_saturation() {
+  // A flick after the most samples in an epoch is still reported as the
+  // extreme, while the mean stays that of the first samples
+  stick_aggregation_state state = {};
+  for (uint i = 0; i < STICK_AGGREGATION_MAX_SAMPLES; ++i) {
+    aggregate_stick(at(20, 20), 1, state);
+  }
+  aggregate_stick(at(-6000, 0), 1, state);
+  for (uint i = 0; i < STICK_AGGREGATION_MAX_SAMPLES; ++i) {
+    aggregate_stick(at(-30, 0), 1, state);
+  }
+  CHECK_EQUAL(state.count, STICK_AGGREGATION_MAX_SAMPLES);
+  CHECK(same(aggregated_stick(extreme_aggregation, 1, state), at(-6000, 0)));
+  CHECK(same(aggregated_stick(mean_aggregation, 1, state), at(20, 20)));
+  CHECK(same(aggregated_stick(latest_aggregation, 1, state), at(-30, 0)));
+
+  // The next epoch starts afresh
+  aggregate_stick(at(5, 5), 2, state);
+  CHECK_EQUAL(state.count, 1);
+  CHECK(same(aggregated_stick(extreme_aggregation, 2, state), at(5, 5)));
+  CHECK(same(aggregated_stick(mean_aggregation, 2, state), at(5, 5)));
+}
+
+// Raw values map to 16ths of an output unit, and every stage but hysteresis
+// leaves samples alone
+struct stick_under_test {
+  stick_coefficients coefficients = {{0, 1ll << 28}, {0, 1ll << 28}, {}};
+  snapback_parameters snapback = DEFAULT_SNAPBACK_PARAMETERS;
+  stick_snapback_state snapback_state = {};
+  stick_filter_parameters filter = {false, 0, 0, 0, 64};
+  stick_filter_state filter_state = {};
+  stick_aggregation_state aggregation_state = {};
+  stick_sample_ring samples;
+  stick reported = {CENTER, CENTER};
+};
+
+void check_hysteresis_holds_aggregate() {
+  // Noise around a rounding boundary of the X-axis, held by hysteresis of a
+  // quarter unit, so a report may only move once the mean is 3/4 of a unit
+  // from the previous report
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> noise(-14, 14);
+  stick_under_test stick;
+  uint32_t timestamp = 1000000;
+  uint checked = 0;
+  uint moved = 0;
+  for (uint32_t epoch = 1; epoch < 10000; ++epoch) {
+    double sum = 0;
+    constexpr uint samples = 12;
+    for (uint i = 0; i < samples; ++i) {
+      uint16_t x = (180 * 16) + 8 + noise(rng);
+      stick.samples.push({x, CENTER * 16, true, timestamp});
+      sum += x / 16.0;
+      timestamp += 80;
+    }
+
+    uint8_t previous = stick.reported.x;
+    stick.reported = process_stick_samples(
+        stick.samples, stick.reported, stick.coefficients, stick.snapback,
+        stick.snapback_state, stick.filter, stick.filter_state, 127,
+        mean_aggregation, stick.aggregation_state, epoch);
+
+    // Leave out means too close to the threshold for the test's rounding
+    double distance = std::abs((sum / samples) - previous);
+    if (epoch > 1 && std::abs(distance - 0.75) > 1.0 / 64) {
+      CHECK_EQUAL(stick.reported.x != previous, distance > 0.75);
+      ++checked;
+      moved += stick.reported.x != previous;
+    }
+    CHECK_EQUAL(stick.reported.y, CENTER);
+  }
+
+  // Both outcomes must have been seen for the check to mean anything
+  CHECK(checked > 5000);
+  CHECK(moved > 0);
+  CHECK(moved < checked);
+}
+
+int main() {
+  check_latest();
+  check_mean();
+  check_extreme();
+  check_epochs();
+  check_saturation();
+  check_hysteresis_holds_aggregate();
+
+  return test_result();
+}
@@ -0,0 +1,254 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_stick_filter.cpp
+ * \brief Checks the adaptive stick filter's weights, noise rejection & step
+ * response at several sample rates, and output hysteresis
+ *
+ * Also prints the time each movement takes to settle, as the filter's added
+ * latency.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "stick_filter.hpp"
+#include "test.hpp"
+
+constexpr int32_t ONE = 1 << NORMALIZED_FRACTIONAL_BITS;
+constexpr int32_t CENTER_AXIS = CENTER * ONE;
+
+/// \brief Filter parameters under test, the defaults with smoothing enabled
+constexpr stick_filter_parameters PARAMETERS = {
+    true,
+    DEFAULT_STICK_FILTER_PARAMETERS.min_cutoff_chz,
+    DEFAULT_STICK_FILTER_PARAMETERS.beta,
+    DEFAULT_STICK_FILTER_PARAMETERS.speed_cutoff_chz,
+    DEFAULT_STICK_FILTER_PARAMETERS.hysteresis,
+};
+
+/// \brief Times between samples to check, in microseconds
+constexpr std::array<uint32_t, 3> SAMPLE_PERIODS_US = {250, 1000, 2000};
+
+/** \brief Time for a filtered axis to settle after a movement
+ *
+ * \param distance Distance moved, in output units
+ * \param duration_us Time taken to move, 0 for a step
+ * \param period_us Time between samples
+ *
+ * \return Time after the movement ends until the axis is within a quarter of
+ * an output unit of its destination, in microseconds
+ */
+uint32_t settling_time(int32_t distance, uint32_t duration_us,
+                       uint32_t period_us) {
+  stick_filter_state filter_state = {};
+  uint32_t timestamp = 0;
+  for (uint i = 0; i < 100; ++i) {
+    filter_stick({CENTER_AXIS, CENTER_AXIS}, timestamp, PARAMETERS,
+                 filter_state);
+    timestamp += period_us;
+  }
+
+  // The movement starts just after the previous sample
+  uint32_t start = timestamp - period_us + 1;
+  int32_t destination = CENTER_AXIS + (distance * ONE);
+  for (uint32_t since_start = timestamp - start; since_start < 1000000;
+       since_start = timestamp - start) {
+    int32_t input = destination;
+    if (since_start < duration_us) {
+      input = CENTER_AXIS + ((int64_t{distance} * ONE * since_start) /
+                             static_cast<int64_t>(duration_us));
+    }
+    precise_stick filtered = filter_stick({input, CENTER_AXIS}, timestamp,
+                                          PARAMETERS, filter_state);
+    if (since_start >= duration_us &&
+        std::abs(filtered.x - destination) < ONE / 4) {
+      return since_start - duration_us;
+    }
+    timestamp += period_us;
+  }
+  return UINT32_MAX;
+}
+
+void check_weights() {
+  CHECK_EQUAL(smoothing_weight(1000, 0), 0);
+
+  // Within 1% of the weight of an exact first order low-pass filter
+  uint errors = 0;
+  uint decreases = 0;
+  for (uint32_t cutoff_chz : {10, 100, 1000, 2000, 10000, 100000}) {
+    int32_t previous = 0;
+    for (uint32_t elapsed = 1; elapsed <= STICK_FILTER_MAX_SAMPLE_GAP_US;
+         elapsed += 7) {
+      int32_t weight = smoothing_weight(elapsed, cutoff_chz);
+      double time_constant_us = 1e6 / (2 * M_PI * (cutoff_chz / 100.0));
+      double exact = (elapsed * 65536.0) / (elapsed + time_constant_us);
+      errors += std::abs(weight - exact) > 1 + (exact / 100);
+      errors += weight > 65536;
+      decreases += weight < previous;
+      previous = weight;
+    }
+  }
+  CHECK_EQUAL(errors, 0);
+  CHECK_EQUAL(decreases, 0);
+
+  // Higher cutoffs give new samples more weight
+  CHECK(smoothing_weight(1000, 100) < smoothing_weight(1000, 1000));
+  CHECK(smoothing_weight(1000, STICK_FILTER_MAX_CUTOFF_CHZ) > 60000);
+}
+
+void check_pass_through() {
+  // A disabled filter passes every sample through unchanged
+  stick_filter_parameters disabled = PARAMETERS;
+  disabled.enabled = false;
+  stick_filter_state filter_state = {};
+  uint changes = 0;
+  for (uint i = 0; i < 100; ++i) {
+    precise_stick input = {CENTER_AXIS + static_cast<int32_t>(i * 12345),
+                           CENTER_AXIS - static_cast<int32_t>(i * 999)};
+    precise_stick filtered =
+        filter_stick(input, i * 1000, disabled, filter_state);
+    changes += filtered.x != input.x || filtered.y != input.y;
+  }
+  CHECK_EQUAL(changes, 0);
+
+  // The first sample, and the first after a gap, restart the filter
+  filter_state = {};
+  precise_stick input = {CENTER_AXIS + (40 * ONE), CENTER_AXIS - (40 * ONE)};
+  precise_stick filtered = filter_stick(input, 5000, PARAMETERS, filter_state);
+  CHECK_EQUAL(filtered.x, input.x);
+  CHECK_EQUAL(filtered.y, input.y);
+  filtered = filter_stick({CENTER_AXIS, CENTER_AXIS}, 6000, PARAMETERS,
+                          filter_state);
+  CHECK(filtered.x != CENTER_AXIS);
+  filtered = filter_stick(
+      input, 6000 + STICK_FILTER_MAX_SAMPLE_GAP_US + 1, PARAMETERS,
+      filter_state);
+  CHECK_EQUAL(filtered.x, input.x);
+  CHECK_EQUAL(filtered.y, input.y);
+}
+
+void check_noise() {
+  // A held stick with noise of nearly half an output unit either side, which
+  // would make its output flicker, is reported steadily once settled, and
+  // the noise is cut to a third
+  for (uint32_t period_us : SAMPLE_PERIODS_US) {
+    stick_filter_state filter_state = {};
+    uint32_t seed = 0x4F70656E;
+    int32_t held = CENTER_AXIS + (ONE / 4);
+    int32_t lowest = INT32_MAX;
+    int32_t highest = INT32_MIN;
+    for (uint32_t timestamp = 0; timestamp < 500000; timestamp += period_us) {
+      seed = (seed * 1664525) + 1013904223;
+      int32_t noise = static_cast<int32_t>((seed >> 16) % ONE) - (ONE / 2);
+      precise_stick filtered = filter_stick(
+          {held + (noise * 9 / 10), held}, timestamp, PARAMETERS, filter_state);
+      if (timestamp >= 100000) {
+        lowest = std::min(lowest, filtered.x);
+        highest = std::max(highest, filtered.x);
+      }
+    }
+    if (highest - lowest >= ONE / 3 ||
+        (lowest + (ONE / 2)) / ONE != (highest + (ONE / 2)) / ONE) {
+      std::printf("%u us between samples:\n", period_us);
+    }
+    CHECK(highest - lowest < ONE / 3);
+    CHECK_EQUAL((lowest + (ONE / 2)) / ONE, (highest + (ONE / 2)) / ONE);
+  }
+}
+
+void check_step_response() {
+  std::printf("%8s %10s", "distance", "movement");
+  for (uint32_t period_us : SAMPLE_PERIODS_US) {
+    std::printf(" %7u us", period_us);
+  }
+  std::printf("   (settling time in us, by time between samples)\n");
+
+  for (uint32_t duration_us : {0, 8000}) {
+    for (int32_t distance : {1, 2, 5, 10, 20, 50, 80}) {
+      uint32_t reference = settling_time(distance, duration_us, 1000);
+      std::printf("%8d %7u us", distance, duration_us);
+      for (uint32_t period_us : SAMPLE_PERIODS_US) {
+        uint32_t time = settling_time(distance, duration_us, period_us);
+        std::printf(" %10u", time);
+
+        // The response is the same at any sample rate, to within a
+        // millisecond & a sample
+        uint32_t difference = std::max(time, reference) -
+                              std::min(time, reference);
+        CHECK(difference <= period_us + 1000);
+      }
+      std::printf("\n");
+
+      // Deliberate movements are barely delayed
+      if (distance >= 20) {
+        CHECK(reference < 8000);
+      }
+    }
+  }
+}
+
+void check_hysteresis() {
+  // No hysteresis is plain rounding
+  int32_t held_output = CENTER;
+  uint mismatches = 0;
+  for (int32_t axis = 100 * ONE; axis <= 110 * ONE; axis += 997) {
+    int32_t held = apply_hysteresis(axis, 0, held_output);
+    mismatches += held_output != (axis + (ONE / 2)) / ONE;
+    mismatches += held != axis && held != held_output * ONE;
+  }
+  CHECK_EQUAL(mismatches, 0);
+
+  // A quarter unit of hysteresis holds the output until the axis is three
+  // quarters of a unit away, and then follows it
+  held_output = 100;
+  CHECK_EQUAL(apply_hysteresis(100 * ONE + (ONE * 7 / 10), 64, held_output),
+              100 * ONE);
+  CHECK_EQUAL(apply_hysteresis(100 * ONE - (ONE * 7 / 10), 64, held_output),
+              100 * ONE);
+  CHECK_EQUAL(held_output, 100);
+  CHECK_EQUAL(apply_hysteresis(100 * ONE + (ONE * 8 / 10), 64, held_output),
+              100 * ONE + (ONE * 8 / 10));
+  CHECK_EQUAL(held_output, 101);
+  CHECK_EQUAL(apply_hysteresis(100 * ONE + (ONE * 4 / 10), 64, held_output),
+              101 * ONE);
+  CHECK_EQUAL(held_output, 101);
+
+  // Each axis of a stick is held separately
+  stick_filter_parameters parameters = PARAMETERS;
+  parameters.hysteresis = 64;
+  stick_filter_state filter_state = {};
+  filter_state.x.held_output = 100;
+  filter_state.y.held_output = 100;
+  precise_stick held = hold_stick({100 * ONE + (ONE * 6 / 10), 103 * ONE},
+                                  parameters, filter_state);
+  CHECK_EQUAL(held.x, 100 * ONE);
+  CHECK_EQUAL(held.y, 103 * ONE);
+  CHECK_EQUAL(filter_state.x.held_output, 100);
+  CHECK_EQUAL(filter_state.y.held_output, 103);
+}
+
+int main() {
+  check_weights();
+  check_pass_through();
+  check_noise();
+  check_step_response();
+  check_hysteresis();
+
+  return test_result();
+}
@@ -0,0 +1,102 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+
+/** \file test_stick_interpolators.cpp
+ * \brief Checks that stick blending & clamping with the interpolators, as
+ * configured for stick processing, match the equivalent calculations
+ *
+ * The interpolators are the host model of them in `hardware/interp.h`, so
+ * this checks the firmware's configuration & use of them against the
+ * datasheet's description rather than against hardware.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "main.hpp"
+#include "test.hpp"
+
+constexpr int32_t ONE = 1 << NORMALIZED_FRACTIONAL_BITS;
+
+void check_blend() {
+  // Table entries span the output range with plenty of margin either side,
+  // and neighbouring entries may be far apart or in either order
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int32_t> entry(-64 * ONE, 320 * ONE);
+  std::uniform_int_distribution<int32_t> step(-4 * ONE, 4 * ONE);
+
+  uint interpolated_mismatches = 0;
+  uint calculated_mismatches = 0;
+  for (uint pair = 0; pair < 4000; ++pair) {
+    int32_t from = entry(rng);
+    int32_t to = pair % 2 == 0 ? entry(rng) : from + step(rng);
+    for (uint alpha = 0; alpha < 256; ++alpha) {
+      int32_t exact = std::floor(from + ((to - double(from)) * alpha / 256));
+      interpolated_mismatches +=
+          interpolated_blend_axis(from, to, alpha) != exact;
+      calculated_mismatches += calculated_blend_axis(from, to, alpha) != exact;
+    }
+  }
+  CHECK_EQUAL(interpolated_mismatches, 0);
+  CHECK_EQUAL(calculated_mismatches, 0);
+}
+
+void check_round_and_clamp() {
+  // Values on & either side of every rounding boundary, and far outside the
+  // range, for narrow & wide ranges
+  uint interpolated_mismatches = 0;
+  uint calculated_mismatches = 0;
+  for (int32_t range : {int32_t{MIN_RANGE}, 100, int32_t{MAX_RANGE}}) {
+    int32_t min_value = CENTER - range;
+    int32_t max_value = CENTER + range;
+    for (int32_t output = -300; output < 560; ++output) {
+      for (int32_t offset : {-ONE / 2 - 1, -ONE / 2, -ONE / 2 + 1, -1, 0, 1,
+                             ONE / 2 - 1}) {
+        int32_t normalized = (output * ONE) + offset;
+        double rounded = std::floor((normalized / double(ONE)) + 0.5);
+        uint8_t exact = std::clamp<double>(rounded, min_value, max_value);
+        interpolated_mismatches +=
+            interpolated_round_and_clamp_axis(normalized, min_value,
+                                              max_value) != exact;
+        calculated_mismatches +=
+            calculated_round_and_clamp_axis(normalized, min_value,
+                                            max_value) != exact;
+      }
+    }
+    for (int32_t normalized : {-(1 << 30), -(1 << 24), 1 << 24, 1 << 30}) {
+      uint8_t exact = normalized < 0 ? min_value : max_value;
+      interpolated_mismatches += interpolated_round_and_clamp_axis(
+                                     normalized, min_value, max_value) != exact;
+      calculated_mismatches += calculated_round_and_clamp_axis(
+                                   normalized, min_value, max_value) != exact;
+    }
+  }
+  CHECK_EQUAL(interpolated_mismatches, 0);
+  CHECK_EQUAL(calculated_mismatches, 0);
+}
+
+int main() {
+  init_stick_interpolators();
+
+  check_blend();
+  check_round_and_clamp();
+
+  return test_result();
+}
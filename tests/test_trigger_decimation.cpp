@@ -0,0 +1,199 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_trigger_decimation.cpp
+ * \brief Checks decimation of the trigger sample ring against a reference
+ * filter, for every ring position & depth
+ *
+ * Built once for each `TRIGGER_DECIMATION`. The `CIC` reference runs the
+ * integrators & combs of a second order CIC filter over the samples, rather
+ * than weighing them. Also prints the noise reduction for each depth.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "state.hpp"
+#include "test.hpp"
+#include "trigger_decimation.hpp"
+
+/** \brief Samples of one trigger in a ring, oldest first
+ *
+ * \param ring Ring of interleaved samples
+ * \param trigger Trigger, 0 for left or 1 for right
+ * \param next Index of the entry DMA will write next
+ *
+ * \return Samples of the trigger
+ */
+std::vector<uint16_t> trigger_samples(const std::vector<uint16_t> &ring,
+                                      uint trigger, uint next) {
+  std::vector<uint16_t> samples;
+  for (uint i = 0; i < ring.size(); ++i) {
+    uint index = (next + i) % ring.size();
+    if (index % 2 == trigger) {
+      samples.push_back(ring[index]);
+    }
+  }
+  return samples;
+}
+
+/** \brief Decimate the samples of a trigger with the reference filter
+ *
+ * \param samples Samples of the trigger, oldest first
+ *
+ * \return Decimated value
+ */
+uint16_t reference_decimation(const std::vector<uint16_t> &samples) {
+  uint depth = samples.size();
+
+#if TRIGGER_DECIMATION == CIC
+  // Integrate every sample, then take the difference of each comb's input &
+  // its input a decimation ratio earlier, from zeroed integrators
+  uint ratio = depth / 2;
+  std::vector<uint64_t> integrated(depth + 1, 0);
+  uint64_t first = 0;
+  uint64_t second = 0;
+  for (uint i = 0; i < depth; ++i) {
+    first += samples[i];
+    second += first;
+    integrated[i + 1] = second;
+  }
+  uint64_t sum =
+      integrated[depth] - (2 * integrated[depth - ratio]) +
+      integrated[depth - (2 * ratio)];
+  uint64_t gain = ratio * ratio;
+#else
+  uint64_t sum = 0;
+  for (uint16_t sample : samples) {
+    sum += sample;
+  }
+  uint64_t gain = depth;
+#endif
+
+  return std::floor((static_cast<double>(sum) / gain) + 0.5);
+}
+
+/** \brief Check decimation of a ring depth for every position
+ *
+ * \tparam depth Number of samples of each trigger
+ */
+template <uint depth>
+void check_depth() {
+  std::mt19937 generator(depth);
+  std::uniform_int_distribution<uint16_t> value(0, TRIGGER_MAX);
+  std::uniform_int_distribution<uint16_t> wide_value(0, UINT16_MAX);
+
+  uint mismatches = 0;
+  for (uint trial = 0; trial < 200; ++trial) {
+    std::vector<uint16_t> ring(2 * depth);
+    for (uint16_t &sample : ring) {
+      sample = trial % 10 == 0 ? wide_value(generator) : value(generator);
+    }
+
+    for (uint next = 0; next < 2 * depth; ++next) {
+      for (uint trigger : {0, 1}) {
+        mismatches +=
+            decimate_trigger_samples<depth>(ring.data(), trigger, next) !=
+            reference_decimation(trigger_samples(ring, trigger, next));
+      }
+    }
+  }
+  if (mismatches != 0) {
+    std::printf("depth %u:\n", depth);
+  }
+  CHECK_EQUAL(mismatches, 0);
+
+  // A steady trigger decimates to exactly its value, whatever the other
+  // trigger does
+  std::vector<uint16_t> ring(2 * depth);
+  for (uint i = 0; i < 2 * depth; ++i) {
+    ring[i] = i % 2 == 0 ? 1234 : value(generator);
+  }
+  for (uint next = 0; next < 2 * depth; ++next) {
+    CHECK_EQUAL(decimate_trigger_samples<depth>(ring.data(), 0, next), 1234);
+  }
+}
+
+/** \brief RMS noise after decimating white noise, relative to a single
+ * sample
+ *
+ * \tparam depth Number of samples of each trigger
+ *
+ * \return Relative RMS noise
+ */
+template <uint depth>
+double relative_noise() {
+  std::mt19937 generator(depth);
+  std::normal_distribution<double> noise(0, 20);
+
+  constexpr double value = 2048;
+  constexpr uint trials = 20000;
+  double squared_error = 0;
+  std::vector<uint16_t> ring(2 * depth);
+  for (uint trial = 0; trial < trials; ++trial) {
+    for (uint16_t &sample : ring) {
+      sample = std::lround(value + noise(generator));
+    }
+    double error =
+        decimate_trigger_samples<depth>(ring.data(), 0, 0) - value;
+    squared_error += error * error;
+  }
+  return std::sqrt(squared_error / trials) / 20;
+}
+
+void check_noise() {
+  std::printf("%5s %6s\n", "depth", "noise");
+  std::array<double, 4> reductions = {relative_noise<2>(),
+                                      relative_noise<4>(),
+                                      relative_noise<8>(),
+                                      relative_noise<16>()};
+  for (uint i = 0; i < reductions.size(); ++i) {
+    std::printf("%5u %5.0f%%\n", 2 << i, reductions[i] * 100);
+  }
+
+  // As documented for OPENGCC_TRIGGER_OVERSAMPLING
+#if TRIGGER_DECIMATION == CIC
+  CHECK(std::abs(reductions[3] - 0.29) < 0.02);
+#else
+  CHECK(std::abs(reductions[3] - 0.25) < 0.02);
+#endif
+}
+
+void check_ring() {
+  // Both triggers are decimated from the configured ring
+  trigger_sample_ring ring = {};
+  for (uint i = 0; i < TRIGGER_RING_ENTRIES; ++i) {
+    ring[i] = i % 2 == 0 ? 100 : 3000;
+  }
+  raw_triggers triggers = decimate_triggers(ring, 5);
+  CHECK_EQUAL(triggers.l, 100);
+  CHECK_EQUAL(triggers.r, 3000);
+}
+
+int main() {
+  check_depth<2>();
+  check_depth<4>();
+  check_depth<8>();
+  check_depth<16>();
+  check_depth<32>();
+  check_noise();
+  check_ring();
+
+  return test_result();
+}
@@ -0,0 +1,274 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_trigger_path.cpp
+ * \brief Checks the full resolution trigger path, from raw value through
+ * calibration, centering, every trigger mode & quantization, against an
+ * exact reference
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "main.hpp"
+#include "test.hpp"
+#include "trigger_transfer.hpp"
+
+/// \brief Calibration with a narrower range than the ADC, and a bent curve
+constexpr trigger_calibration BENT_CALIBRATION = {
+    300,
+    3800,
+    {0, 200, 600, 1200, 1900, 2600, 3200, 3700, TRIGGER_MAX},
+};
+
+/** \brief Calibrate a raw trigger value without rounding
+ *
+ * \param raw_value Raw trigger value
+ * \param calibration Calibration for the trigger
+ *
+ * \return Calibrated trigger value, with `TRIGGER_BITS` integer bits
+ */
+double reference_calibration(uint16_t raw_value,
+                             const trigger_calibration &calibration) {
+  double clamped = std::clamp(raw_value, calibration.min, calibration.max);
+  double travel = (clamped - calibration.min) /
+                  (calibration.max - calibration.min);
+
+  constexpr uint segments = NUM_TRIGGER_CURVE_POINTS - 1;
+  uint segment = std::min<uint>(travel * segments, segments - 1);
+  double offset = (travel * segments) - segment;
+  return calibration.curve[segment] +
+         ((calibration.curve[segment + 1] - calibration.curve[segment]) *
+          offset);
+}
+
+/** \brief Apply a trigger mode without rounding
+ *
+ * \param analog_value Calibrated & centered trigger value
+ * \param configured_value Configured value, in 8-bit output units
+ * \param digital_value Digital value for the trigger
+ * \param mode Trigger mode
+ *
+ * \return Value after the trigger mode, with `TRIGGER_BITS` integer bits
+ */
+double reference_mode(double analog_value, uint8_t configured_value,
+                      bool digital_value, trigger_mode mode) {
+  double precise_configured_value = precise_trigger(configured_value);
+
+  switch (mode) {
+    case digital_only:
+      return 0;
+    case both:
+    case analog_only:
+      return analog_value;
+    case capped_analog:
+      return std::min(analog_value, precise_configured_value);
+    case analog_on_digital:
+    case both_on_digital:
+      return precise_configured_value * digital_value;
+    case multiplied_analog:
+      return std::min<double>(
+          analog_value * (configured_value + TRIGGER_MULTIPLIER_OFFSET) /
+              TRIGGER_MULTIPLIER_DIVISOR,
+          TRIGGER_MAX);
+  }
+  return 0;
+}
+
+/** \brief Run a raw trigger value through the firmware's trigger path
+ *
+ * \param raw_value Raw trigger value
+ * \param calibration Calibration for the trigger
+ * \param center Calibrated value with the trigger released
+ * \param transfer Compiled trigger mode
+ * \param digital_value Digital value for the trigger
+ *
+ * \return Trigger value as sent to the console
+ */
+uint8_t firmware_path(uint16_t raw_value,
+                      const trigger_calibration &calibration, uint16_t center,
+                      const trigger_transfer &transfer, bool digital_value) {
+  uint16_t value = calibrate_trigger(raw_value, calibration);
+  value -= std::min(value, center);
+  return quantize_trigger(
+      apply_trigger_transfer(transfer, value, digital_value));
+}
+
+void check_calibration() {
+  // The default calibration is the identity
+  uint mismatches = 0;
+  for (uint raw = 0; raw <= TRIGGER_MAX; ++raw) {
+    mismatches += calibrate_trigger(raw, DEFAULT_TRIGGER_CALIBRATION) != raw;
+  }
+  CHECK_EQUAL(mismatches, 0);
+
+  // Values outside the calibrated range are clamped to its ends
+  CHECK_EQUAL(calibrate_trigger(0, BENT_CALIBRATION), 0);
+  CHECK_EQUAL(calibrate_trigger(BENT_CALIBRATION.min, BENT_CALIBRATION), 0);
+  CHECK_EQUAL(calibrate_trigger(BENT_CALIBRATION.max, BENT_CALIBRATION),
+              TRIGGER_MAX);
+  CHECK_EQUAL(calibrate_trigger(TRIGGER_MAX, BENT_CALIBRATION), TRIGGER_MAX);
+
+  // Curve points are hit exactly, and values in between are interpolated
+  // monotonically, within a unit of the exact value
+  uint span = BENT_CALIBRATION.max - BENT_CALIBRATION.min;
+  for (uint point = 0; point < NUM_TRIGGER_CURVE_POINTS; ++point) {
+    if ((span * point) % (NUM_TRIGGER_CURVE_POINTS - 1) == 0) {
+      uint raw = BENT_CALIBRATION.min +
+                 ((span * point) / (NUM_TRIGGER_CURVE_POINTS - 1));
+      CHECK_EQUAL(calibrate_trigger(raw, BENT_CALIBRATION),
+                  BENT_CALIBRATION.curve[point]);
+    }
+  }
+  uint decreases = 0;
+  uint errors = 0;
+  uint16_t previous = 0;
+  for (uint raw = 0; raw <= TRIGGER_MAX; ++raw) {
+    uint16_t value = calibrate_trigger(raw, BENT_CALIBRATION);
+    decreases += value < previous;
+    errors += std::abs(value - reference_calibration(raw, BENT_CALIBRATION)) >=
+              1;
+    previous = value;
+  }
+  CHECK_EQUAL(decreases, 0);
+  CHECK_EQUAL(errors, 0);
+
+  // An uncalibrated trigger never reports a press
+  trigger_calibration degenerate = {2000, 2000, BENT_CALIBRATION.curve};
+  CHECK_EQUAL(calibrate_trigger(0, degenerate), 0);
+  CHECK_EQUAL(calibrate_trigger(2000, degenerate), 0);
+  CHECK_EQUAL(calibrate_trigger(TRIGGER_MAX, degenerate), 0);
+  trigger_calibration inverted = {3000, 1000, BENT_CALIBRATION.curve};
+  CHECK_EQUAL(calibrate_trigger(TRIGGER_MAX, inverted), 0);
+}
+
+void check_every_mode() {
+  constexpr uint16_t center = 100;
+
+  for (uint mode = first_trigger_mode; mode <= last_trigger_mode; ++mode) {
+    for (uint configured_value : {0, 1, 49, 80, 140, 200, 255}) {
+      trigger_transfer transfer = compile_trigger_transfer(
+          static_cast<trigger_mode>(mode), configured_value, true);
+
+      // Within one output unit of the exact path for every raw value
+      uint errors = 0;
+      for (uint raw = 0; raw <= TRIGGER_MAX; ++raw) {
+        for (bool digital_value : {false, true}) {
+          double calibrated =
+              std::max(reference_calibration(raw, BENT_CALIBRATION) - center,
+                       0.0);
+          double exact = std::min(
+              reference_mode(calibrated, configured_value, digital_value,
+                             static_cast<trigger_mode>(mode)) /
+                  precise_trigger(1),
+              255.0);
+          errors += std::abs(firmware_path(raw, BENT_CALIBRATION, center,
+                                           transfer, digital_value) -
+                             exact) > 1;
+        }
+      }
+      if (errors != 0) {
+        std::printf("mode %u, configured value %u:\n", mode,
+                    configured_value);
+      }
+      CHECK_EQUAL(errors, 0);
+    }
+  }
+}
+
+void check_mode_outputs() {
+  trigger_transfer transfer;
+
+  // Released triggers are 0 in every mode which follows the analog value
+  for (trigger_mode mode :
+       {both, analog_only, capped_analog, multiplied_analog}) {
+    transfer = compile_trigger_transfer(mode, 140, true);
+    CHECK_EQUAL(firmware_path(0, BENT_CALIBRATION, 0, transfer, false), 0);
+    CHECK_EQUAL(firmware_path(BENT_CALIBRATION.min, BENT_CALIBRATION, 0,
+                              transfer, true),
+                0);
+  }
+
+  // Fully pressed triggers reach full scale
+  transfer = compile_trigger_transfer(analog_only, 0, true);
+  CHECK_EQUAL(firmware_path(TRIGGER_MAX, BENT_CALIBRATION, 0, transfer, true),
+              255);
+
+  // A capped trigger holds exactly the configured value past it, however far
+  // it's pressed, and never overshoots on the way
+  transfer = compile_trigger_transfer(capped_analog, 140, true);
+  uint overshoots = 0;
+  for (uint raw = 0; raw <= TRIGGER_MAX; ++raw) {
+    overshoots +=
+        firmware_path(raw, BENT_CALIBRATION, 0, transfer, false) > 140;
+  }
+  CHECK_EQUAL(overshoots, 0);
+  CHECK_EQUAL(firmware_path(TRIGGER_MAX, BENT_CALIBRATION, 0, transfer, false),
+              140);
+
+  // Digital modes send exactly the configured value, only while pressed
+  for (trigger_mode mode : {analog_on_digital, both_on_digital}) {
+    transfer = compile_trigger_transfer(mode, 49, true);
+    CHECK_EQUAL(firmware_path(0, BENT_CALIBRATION, 0, transfer, true), 49);
+    CHECK_EQUAL(firmware_path(TRIGGER_MAX, BENT_CALIBRATION, 0, transfer,
+                              false),
+                0);
+  }
+
+  // Digital only never sends an analog value
+  transfer = compile_trigger_transfer(digital_only, 255, true);
+  CHECK_EQUAL(firmware_path(TRIGGER_MAX, BENT_CALIBRATION, 0, transfer, true),
+              0);
+
+  // Multiplied analog saturates rather than wrapping
+  transfer = compile_trigger_transfer(multiplied_analog, 255, true);
+  CHECK_EQUAL(firmware_path(TRIGGER_MAX, BENT_CALIBRATION, 0, transfer, true),
+              255);
+
+  // Disabled analog output is 0 in every mode
+  uint nonzero = 0;
+  for (uint mode = first_trigger_mode; mode <= last_trigger_mode; ++mode) {
+    transfer = compile_trigger_transfer(static_cast<trigger_mode>(mode), 140,
+                                        false);
+    for (uint raw = 0; raw <= TRIGGER_MAX; raw += 64) {
+      nonzero += firmware_path(raw, BENT_CALIBRATION, 0, transfer, true) != 0;
+    }
+  }
+  CHECK_EQUAL(nonzero, 0);
+}
+
+void check_centering() {
+  // The released value is removed before the trigger mode, so a trigger
+  // resting above its calibrated minimum still reads 0
+  trigger_transfer transfer = compile_trigger_transfer(analog_only, 0, true);
+  uint16_t center = calibrate_trigger(600, BENT_CALIBRATION);
+  CHECK_EQUAL(firmware_path(600, BENT_CALIBRATION, center, transfer, false),
+              0);
+  CHECK_EQUAL(firmware_path(500, BENT_CALIBRATION, center, transfer, false),
+              0);
+  CHECK(firmware_path(700, BENT_CALIBRATION, center, transfer, false) > 0);
+}
+
+int main() {
+  check_calibration();
+  check_every_mode();
+  check_mode_outputs();
+  check_centering();
+
+  return test_result();
+}
@@ -0,0 +1,114 @@
+/*
+    Copyright 2023-2025 Zaden Ruggiero-Bouné
+
+    This file is part of OpenGCC.
+
+    OpenGCC is free software: you can redistribute it and/or modify it under
+   the terms of the GNU General Public License as published by the Free Software
+   Foundation, either version 3 of the License, or (at your option) any later
+   version.
+
+    OpenGCC is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along with
+   OpenGCC If not, see http://www.gnu.org/licenses/.
+*/
+
+/** \file test_trigger_transfer.cpp
+ * \brief Checks compiled trigger transfers against evaluating each trigger
+ * mode directly, for every input
+ */
+
+#include "trigger_transfer.hpp"
+#include "test.hpp"
+
+/** \brief Update analog trigger value based on trigger mode
+ *
+ * The trigger modes as they were evaluated before being compiled, kept as the
+ * reference for compiled transfers.
+ *
+ * \param analog_value Current analog trigger value, with `TRIGGER_BITS` bits
+ * \param configured_value Configured value, in 8-bit output units
+ * \param digital_value Digital value for this trigger
+ * \param enable_analog Whether analog output is enabled
+ * \param mode Current trigger mode
+ *
+ * \return New analog value after applying trigger mode, with `TRIGGER_BITS`
+ * bits
+ */
+uint16_t apply_trigger_mode_analog(uint16_t analog_value,
+                                   uint8_t configured_value,
+                                   bool digital_value, bool enable_analog,
+                                   trigger_mode mode) {
+  uint16_t out = 0;
+  uint16_t precise_configured_value = precise_trigger(configured_value);
+
+  switch (mode) {
+    case digital_only:
+      out = 0;
+      break;
+    case both:
+    case analog_only:
+      out = analog_value * enable_analog;
+      break;
+    case capped_analog:
+      if (analog_value > precise_configured_value) {
+        out = precise_configured_value * enable_analog;
+      } else {
+        out = analog_value * enable_analog;
+      }
+      break;
+    case analog_on_digital:
+    case both_on_digital:
+      out = precise_configured_value * digital_value * enable_analog;
+      break;
+    case multiplied_analog:
+      uint32_t multiplied_value =
+          (analog_value * (configured_value + TRIGGER_MULTIPLIER_OFFSET)) /
+          TRIGGER_MULTIPLIER_DIVISOR;
+      if (multiplied_value > TRIGGER_MAX) {
+        out = TRIGGER_MAX * enable_analog;
+      } else {
+        out = multiplied_value * enable_analog;
+      }
+      break;
+  }
+
+  return out;
+}
+
+void check_every_input() {
+  for (uint mode = first_trigger_mode; mode <= last_trigger_mode; ++mode) {
+    for (uint configured_value = 0; configured_value <= 255;
+         ++configured_value) {
+      for (bool enable_analog : {false, true}) {
+        trigger_transfer transfer = compile_trigger_transfer(
+            static_cast<trigger_mode>(mode), configured_value, enable_analog);
+
+        uint mismatches = 0;
+        for (uint input = 0; input <= TRIGGER_MAX; ++input) {
+          for (bool digital_value : {false, true}) {
+            mismatches +=
+                apply_trigger_transfer(transfer, input, digital_value) !=
+                apply_trigger_mode_analog(input, configured_value,
+                                          digital_value, enable_analog,
+                                          static_cast<trigger_mode>(mode));
+          }
+        }
+        if (mismatches != 0) {
+          std::printf("mode %u, configured value %u, analog %s:\n", mode,
+                      configured_value, enable_analog ? "on" : "off");
+        }
+        CHECK_EQUAL(mismatches, 0);
+      }
+    }
+  }
+}
+
+int main() {
+  check_every_input();
+
+  return test_result();
+}